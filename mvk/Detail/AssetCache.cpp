@@ -0,0 +1,202 @@
+#include "Detail/AssetCache.hpp"
+
+#include "Detail/MappedFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace Mvk::Detail
+{
+  namespace
+  {
+    // The primes and rounds of xxHash64, not its exact output
+    constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t Prime3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+    [[nodiscard]] uint64_t load( std::byte const * Ptr ) noexcept
+    {
+      auto Word = uint64_t( 0 );
+      std::memcpy( &Word, Ptr, sizeof( Word ) );
+      return Word;
+    }
+
+    [[nodiscard]] constexpr uint64_t mixRound( uint64_t Acc, uint64_t Word ) noexcept
+    {
+      return std::rotl( Acc + Word * Prime2, 31 ) * Prime1;
+    }
+
+    // Everything that changes what a kind of asset is processed into
+    [[nodiscard]] uint64_t getOptionsSeed( AssetKind Kind, uint32_t VtxStride ) noexcept
+    {
+      auto const Option  = Kind == AssetKind::Mesh ? MeshFileVersion : static_cast<uint32_t>( TexFormat::Rgba8 );
+      auto const Options = std::array{ AssetCacheVersion, static_cast<uint32_t>( Kind ), Option, VtxStride };
+
+      return hashBytes( std::as_bytes( std::span( Options ) ) );
+    }
+
+  }  // namespace
+
+  [[nodiscard]] uint64_t hashBytes( std::span<std::byte const> Bytes, uint64_t Seed ) noexcept
+  {
+    auto const * Data = std::data( Bytes );
+    auto const   Size = std::size( Bytes );
+    auto         Off  = size_t( 0 );
+    auto         Hash = Seed + Prime5;
+
+    // Four independent lanes keep several multiplies in flight, enough to keep up with reading the file
+    if ( Size >= 32 )
+    {
+      auto Lanes = std::array{ Seed + Prime1 + Prime2, Seed + Prime2, Seed, Seed - Prime1 };
+
+      for ( ; Off + 32 <= Size; Off += 32 )
+      {
+        for ( auto Lane = size_t( 0 ); Lane < 4; ++Lane )
+        {
+          Lanes[Lane] = mixRound( Lanes[Lane], load( Data + Off + Lane * 8 ) );
+        }
+      }
+
+      Hash = std::rotl( Lanes[0], 1 ) + std::rotl( Lanes[1], 7 ) + std::rotl( Lanes[2], 12 ) + std::rotl( Lanes[3], 18 );
+
+      for ( auto const Lane : Lanes )
+      {
+        Hash = ( Hash ^ mixRound( 0, Lane ) ) * Prime1 + Prime4;
+      }
+    }
+
+    Hash += Size;
+
+    for ( ; Off + 8 <= Size; Off += 8 )
+    {
+      Hash = std::rotl( Hash ^ mixRound( 0, load( Data + Off ) ), 27 ) * Prime1 + Prime4;
+    }
+
+    for ( ; Off < Size; ++Off )
+    {
+      Hash = std::rotl( Hash ^ ( static_cast<uint64_t>( Data[Off] ) * Prime5 ), 11 ) * Prime1;
+    }
+
+    Hash ^= Hash >> 33;
+    Hash *= Prime2;
+    Hash ^= Hash >> 29;
+    Hash *= Prime3;
+    Hash ^= Hash >> 32;
+
+    return Hash;
+  }
+
+  [[nodiscard]] std::optional<uint64_t> hashSrc( std::filesystem::path const & Src, AssetKind Kind, uint32_t VtxStride ) noexcept
+  {
+    if ( !std::filesystem::exists( Src ) )
+    {
+      return std::nullopt;
+    }
+
+    auto const File = MappedFile( Src );
+    return hashBytes( File.getData(), getOptionsSeed( Kind, VtxStride ) );
+  }
+
+  AssetCache::AssetCache( std::filesystem::path Dir ) noexcept : Dir( std::move( Dir ) )
+  {
+    // Stores fail when it can't be created, everything then goes through the sources as if there was no cache
+    auto Error = std::error_code();
+    std::filesystem::create_directories( this->Dir, Error );
+  }
+
+  [[nodiscard]] std::optional<uint64_t>
+    AssetCache::getKey( std::filesystem::path const & Src, AssetKind Kind, uint32_t VtxStride ) const noexcept
+  {
+    return hashSrc( Src, Kind, VtxStride );
+  }
+
+  [[nodiscard]] std::optional<MeshView> AssetCache::findMesh( uint64_t Key, uint32_t VtxStride ) const noexcept
+  {
+    return readMesh( getPath( Key, AssetKind::Mesh ), VtxStride );
+  }
+
+  [[nodiscard]] std::optional<TexView> AssetCache::findTex( uint64_t Key ) const noexcept
+  {
+    auto Tex = readKtx2( getPath( Key, AssetKind::Tex ) );
+
+    // The key already says what's in there, this only catches a file that was replaced by something else
+    if ( Tex.has_value()
+         && ( Tex->Format != TexFormat::Rgba8 || std::size( Tex->Levels ) != std::bit_width( std::max( Tex->Width, Tex->Height ) ) ) )
+    {
+      return std::nullopt;
+    }
+
+    return Tex;
+  }
+
+  template <typename Fn> [[nodiscard]] bool AssetCache::store( uint64_t Key, AssetKind Kind, Fn const & Write ) const noexcept
+  {
+    auto const Path = getPath( Key, Kind );
+
+    // Loader workers can store the same asset at the same time, each one writes its own file
+    auto Tmp = Path;
+    Tmp += "." + std::to_string( std::hash<std::thread::id>()( std::this_thread::get_id() ) ) + ".tmp";
+
+    auto Error = std::error_code();
+
+    if ( !Write( Tmp ) )
+    {
+      std::filesystem::remove( Tmp, Error );
+      return false;
+    }
+
+    // Mappings of an entry that is replaced keep the old file
+    std::filesystem::rename( Tmp, Path, Error );
+
+    if ( Error )
+    {
+      std::filesystem::remove( Tmp, Error );
+      return false;
+    }
+
+    return true;
+  }
+
+  [[nodiscard]] bool AssetCache::storeMesh( uint64_t Key, MeshView const & Mesh ) const noexcept
+  {
+    // Nothing to tell the stride from
+    if ( Mesh.VtxCnt == 0 )
+    {
+      return false;
+    }
+
+    auto const VtxStride = static_cast<uint32_t>( std::size( Mesh.VtxBytes ) / Mesh.VtxCnt );
+    auto const write     = [&]( std::filesystem::path const & Path )
+    { return writeMesh( Path, Mesh.VtxBytes, VtxStride, Mesh.Dequant, Mesh.Idxs, Mesh.SrcHash, Mesh.SrcStamp ); };
+
+    return store( Key, AssetKind::Mesh, write );
+  }
+
+  [[nodiscard]] bool AssetCache::storeTex( uint64_t                                Key,
+                                           uint32_t                                Width,
+                                           uint32_t                                Height,
+                                           std::span<std::vector<std::byte> const> Levels ) const noexcept
+  {
+    return store( Key,
+                  AssetKind::Tex,
+                  [&]( std::filesystem::path const & Path ) { return writeKtx2( Path, TexFormat::Rgba8, Width, Height, Levels ); } );
+  }
+
+  [[nodiscard]] std::filesystem::path AssetCache::getPath( uint64_t Key, AssetKind Kind ) const noexcept
+  {
+    auto Name = std::array<char, 17>();
+    std::snprintf( std::data( Name ), std::size( Name ), "%016llx", static_cast<unsigned long long>( Key ) );
+
+    return Dir / ( std::string( std::data( Name ) ) + ( Kind == AssetKind::Mesh ? ".mvkm" : ".ktx2" ) );
+  }
+
+}  // namespace Mvk::Detail
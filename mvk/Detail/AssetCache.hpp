@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Detail/Ktx2.hpp"
+#include "Detail/MeshFile.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Mvk::Detail
+{
+  // Bumped whenever readObj, buildVtxs or genMipChain produce something else for the same file, older entries stop
+  // matching instead of being served
+  inline constexpr uint32_t AssetCacheVersion = 1;
+
+  enum class AssetKind : uint32_t
+  {
+    // OBJ to deduplicated vertices in the format of a layout, see readObj and buildVtxs
+    Mesh,
+    // PNG to the whole RGBA8 mip chain, see loadTex and genMipChain
+    Tex
+  };
+
+  // Not cryptographic, only has to tell apart versions of the same asset
+  [[nodiscard]] uint64_t hashBytes( std::span<std::byte const> Bytes, uint64_t Seed = 0 ) noexcept;
+
+  // Reads the whole file, std::nullopt when it's missing. Also covers everything the processing depends on, so it's the
+  // cache key and what a .mvkm records of its OBJ. Meshes are also keyed by the stride of their vertices
+  [[nodiscard]] std::optional<uint64_t> hashSrc( std::filesystem::path const & Src, AssetKind Kind, uint32_t VtxStride = 0 ) noexcept;
+
+  // Processed assets keyed by the contents of the source file and by everything the processing depends on, so editing
+  // the source or changing the processing both miss. Entries are the files of mesh-converter and tex-encoder and hits
+  // are mapped the same way. Nothing is ever evicted, removing the directory clears it
+  class AssetCache
+  {
+  public:
+    explicit AssetCache( std::filesystem::path Dir ) noexcept;
+
+    // See hashSrc
+    [[nodiscard]] std::optional<uint64_t>
+      getKey( std::filesystem::path const & Src, AssetKind Kind, uint32_t VtxStride = 0 ) const noexcept;
+
+    // std::nullopt on a miss, entries that are truncated or from another version of the formats miss too
+    [[nodiscard]] std::optional<MeshView> findMesh( uint64_t Key, uint32_t VtxStride ) const noexcept;
+    [[nodiscard]] std::optional<TexView>  findTex( uint64_t Key ) const noexcept;
+
+    // Safe to race with other stores and lookups of the same key, readers only ever see a whole entry
+    [[nodiscard]] bool storeMesh( uint64_t Key, MeshView const & Mesh ) const noexcept;
+    [[nodiscard]] bool
+      storeTex( uint64_t Key, uint32_t Width, uint32_t Height, std::span<std::vector<std::byte> const> Levels ) const noexcept;
+
+  private:
+    [[nodiscard]] std::filesystem::path getPath( uint64_t Key, AssetKind Kind ) const noexcept;
+
+    // Writes next to the entry, then renames over it
+    template <typename Fn> [[nodiscard]] bool store( uint64_t Key, AssetKind Kind, Fn const & Write ) const noexcept;
+
+    std::filesystem::path Dir;
+  };
+
+}  // namespace Mvk::Detail
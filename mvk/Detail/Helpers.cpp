@@ -102,6 +102,43 @@ namespace Mvk::Detail
 
     return std::nullopt;
   }
+  [[nodiscard]] std::optional<uint32_t> queryTransferFamilyIdx( VkPhysicalDevice PhysicalDevice ) noexcept
+  {
+    auto QueueFamilyCount = uint32_t( 0 );
+    vkGetPhysicalDeviceQueueFamilyProperties( PhysicalDevice, &QueueFamilyCount, nullptr );
+
+    auto QueueFamilyProps = std::vector<VkQueueFamilyProperties>( QueueFamilyCount );
+    vkGetPhysicalDeviceQueueFamilyProperties( PhysicalDevice, &QueueFamilyCount, std::data( QueueFamilyProps ) );
+
+    auto const OtherQueues = VkQueueFlags( VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT );
+
+    for ( auto Idx = uint32_t( 0 ); Idx < QueueFamilyCount; ++Idx )
+    {
+      auto const & QueueFamilyProp = QueueFamilyProps[Idx];
+
+      if ( QueueFamilyProp.queueCount != 0 && ( QueueFamilyProp.queueFlags & VK_QUEUE_TRANSFER_BIT ) != 0U &&
+           ( QueueFamilyProp.queueFlags & OtherQueues ) == 0U )
+      {
+        return Idx;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  [[nodiscard]] bool chkTimelineSemaphoreSup( VkPhysicalDevice PhysicalDevice ) noexcept
+  {
+    auto Features12  = VkPhysicalDeviceVulkan12Features();
+    Features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    auto Features  = VkPhysicalDeviceFeatures2();
+    Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    Features.pNext = &Features12;
+
+    vkGetPhysicalDeviceFeatures2( PhysicalDevice, &Features );
+
+    return Features12.timelineSemaphore != 0U;
+  }
 
   [[nodiscard]] uint32_t chooseImgCount( VkSurfaceCapabilitiesKHR const & Capabilities ) noexcept
   {
@@ -18,6 +18,11 @@ namespace Mvk::Detail
 
   [[nodiscard]] std::optional<std::pair<uint32_t, uint32_t>> queryFamiliyIdxs( VkPhysicalDevice PhysicalDevice, VkSurfaceKHR Surface );
 
+  // A family that only does transfers, those map to the copy engines of the GPU
+  [[nodiscard]] std::optional<uint32_t> queryTransferFamilyIdx( VkPhysicalDevice PhysicalDevice ) noexcept;
+
+  [[nodiscard]] bool chkTimelineSemaphoreSup( VkPhysicalDevice PhysicalDevice ) noexcept;
+
   [[nodiscard]] uint32_t chooseImgCount( VkSurfaceCapabilitiesKHR const & Capabilities ) noexcept;
 
   [[nodiscard]] VkPresentModeKHR choosePresentMode( VkPhysicalDevice PhysicalDevice, VkSurfaceKHR Surface ) noexcept;
@@ -0,0 +1,197 @@
+#include "Detail/Ktx2.hpp"
+
+#include "Detail/Misc.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+namespace Mvk::Detail
+{
+  namespace
+  {
+    // Data format descriptor, the flags of the channel type byte
+    constexpr uint8_t DfdChannelLinear = 0x10;
+
+    struct DfdSample
+    {
+      uint16_t BitOff;
+      uint8_t  BitLength;
+      uint8_t  ChannelType;
+      uint32_t Upper;
+    };
+
+    // KTX 2.0 requires one, readers like ours just look at VkFormat
+    [[nodiscard]] std::vector<std::byte> crtDfd( TexFormat Format ) noexcept
+    {
+      auto ColorModel = uint8_t( 0 );
+      auto Samples    = std::vector<DfdSample>();
+
+      switch ( Format )
+      {
+        case TexFormat::Rgba8:
+          ColorModel = 1;
+          Samples    = { { 0, 7, 0, 255 }, { 8, 7, 1, 255 }, { 16, 7, 2, 255 }, { 24, 7, 15 | DfdChannelLinear, 255 } };
+          break;
+        case TexFormat::Bc1:
+          ColorModel = 128;
+          Samples    = { { 0, 63, 0, 0xFFFFFFFF } };
+          break;
+        case TexFormat::Bc3:
+          ColorModel = 130;
+          Samples    = { { 0, 63, 15 | DfdChannelLinear, 0xFFFFFFFF }, { 64, 63, 0, 0xFFFFFFFF } };
+          break;
+        case TexFormat::Bc7:
+          ColorModel = 135;
+          Samples    = { { 0, 127, 0, 0xFFFFFFFF } };
+          break;
+      }
+
+      auto const BlockSize = static_cast<uint16_t>( 24 + 16 * std::size( Samples ) );
+      auto const TotalSize = static_cast<uint32_t>( 4 + BlockSize );
+      auto const Dim       = static_cast<uint8_t>( getBlockDim( Format ) - 1 );
+
+      auto       Dfd   = std::vector<std::byte>( TotalSize );
+      auto       Off   = size_t( 0 );
+      auto const write = [&Dfd, &Off]( auto Value )
+      {
+        std::memcpy( std::data( Dfd ) + Off, &Value, sizeof( Value ) );
+        Off += sizeof( Value );
+      };
+
+      write( TotalSize );
+      // Khronos vendor, basic descriptor block
+      write( uint32_t( 0 ) );
+      write( uint16_t( 2 ) );
+      write( BlockSize );
+      // BT.709 primaries, sRGB transfer, straight alpha
+      write( std::array<uint8_t, 4>{ ColorModel, 1, 2, 0 } );
+      write( std::array<uint8_t, 4>{ Dim, Dim, 0, 0 } );
+      write( std::array<uint8_t, 8>{ static_cast<uint8_t>( getBlockSize( Format ) ), 0, 0, 0, 0, 0, 0, 0 } );
+
+      for ( auto const & Sample : Samples )
+      {
+        write( Sample.BitOff );
+        write( Sample.BitLength );
+        write( Sample.ChannelType );
+        write( std::array<uint8_t, 4>{ 0, 0, 0, 0 } );
+        write( uint32_t( 0 ) );
+        write( Sample.Upper );
+      }
+
+      return Dfd;
+    }
+
+  }  // namespace
+
+  [[nodiscard]] bool writeKtx2( std::filesystem::path const &           Path,
+                                TexFormat                               Format,
+                                uint32_t                                Width,
+                                uint32_t                                Height,
+                                std::span<std::vector<std::byte> const> Levels ) noexcept
+  {
+    auto const Dfd      = crtDfd( Format );
+    auto const LevelCnt = static_cast<uint32_t>( std::size( Levels ) );
+
+    auto Header                   = Ktx2Header();
+    Header.Identifier             = Ktx2Identifier;
+    Header.VkFormat               = static_cast<uint32_t>( getVkFormat( Format ) );
+    Header.TypeSize               = 1;
+    Header.PixelWidth             = Width;
+    Header.PixelHeight            = Height;
+    Header.PixelDepth             = 0;
+    Header.LayerCnt               = 0;
+    Header.FaceCnt                = 1;
+    Header.LevelCnt               = LevelCnt;
+    Header.SupercompressionScheme = 0;
+    Header.DfdOff                 = static_cast<uint32_t>( sizeof( Ktx2Header ) + LevelCnt * sizeof( Ktx2Level ) );
+    Header.DfdSize                = static_cast<uint32_t>( std::size( Dfd ) );
+    Header.KvdOff                 = 0;
+    Header.KvdSize                = 0;
+    Header.SgdOff                 = 0;
+    Header.SgdSize                = 0;
+
+    // The level index starts with level 0 but the data is stored smallest level first
+    auto Index = std::vector<Ktx2Level>( LevelCnt );
+    auto Off   = uint64_t( Header.DfdOff ) + Header.DfdSize;
+
+    for ( auto Lvl = LevelCnt; Lvl-- > 0; )
+    {
+      MVK_VERIFY( std::size( Levels[Lvl] ) == getLevelSize( Format, Width, Height, Lvl ) );
+
+      Off         = alignedSize( Off, Ktx2LevelAlignment );
+      Index[Lvl]  = { Off, std::size( Levels[Lvl] ), std::size( Levels[Lvl] ) };
+      Off        += std::size( Levels[Lvl] );
+    }
+
+    auto Contents = std::vector<std::byte>( Off );
+    std::memcpy( std::data( Contents ), &Header, sizeof( Header ) );
+    std::memcpy( std::data( Contents ) + sizeof( Header ), std::data( Index ), LevelCnt * sizeof( Ktx2Level ) );
+    std::memcpy( std::data( Contents ) + Header.DfdOff, std::data( Dfd ), std::size( Dfd ) );
+
+    for ( auto Lvl = uint32_t( 0 ); Lvl < LevelCnt; ++Lvl )
+    {
+      std::memcpy( std::data( Contents ) + Index[Lvl].Off, std::data( Levels[Lvl] ), std::size( Levels[Lvl] ) );
+    }
+
+    auto File = std::ofstream( Path, std::ios::binary | std::ios::trunc );
+    File.write( reinterpret_cast<char const *>( std::data( Contents ) ), static_cast<std::streamsize>( std::size( Contents ) ) );
+
+    return File.good();
+  }
+
+  [[nodiscard]] std::optional<TexView> readKtx2( std::filesystem::path const & Path ) noexcept
+  {
+    if ( !std::filesystem::exists( Path ) )
+    {
+      return std::nullopt;
+    }
+
+    auto       File  = std::make_shared<MappedFile const>( Path );
+    auto const Bytes = File->getData();
+
+    if ( std::size( Bytes ) < sizeof( Ktx2Header ) )
+    {
+      return std::nullopt;
+    }
+
+    auto Header = Ktx2Header();
+    std::memcpy( &Header, std::data( Bytes ), sizeof( Header ) );
+
+    auto const Format  = getTexFormat( static_cast<VkFormat>( Header.VkFormat ) );
+    auto const IsValid = Header.Identifier == Ktx2Identifier && Format.has_value() && Header.SupercompressionScheme == 0
+                      && Header.PixelWidth != 0 && Header.PixelHeight != 0 && Header.PixelDepth == 0 && Header.LayerCnt <= 1
+                      && Header.FaceCnt == 1 && Header.LevelCnt != 0
+                      && Header.LevelCnt <= std::bit_width( std::max( Header.PixelWidth, Header.PixelHeight ) )
+                      && sizeof( Ktx2Header ) + Header.LevelCnt * sizeof( Ktx2Level ) <= std::size( Bytes );
+
+    if ( !IsValid )
+    {
+      return std::nullopt;
+    }
+
+    auto Tex   = TexView();
+    Tex.Format = *Format;
+    Tex.Width  = Header.PixelWidth;
+    Tex.Height = Header.PixelHeight;
+
+    for ( auto Lvl = uint32_t( 0 ); Lvl < Header.LevelCnt; ++Lvl )
+    {
+      auto Level = Ktx2Level();
+      std::memcpy( &Level, std::data( Bytes ) + sizeof( Ktx2Header ) + Lvl * sizeof( Ktx2Level ), sizeof( Level ) );
+
+      if ( Level.Size != getLevelSize( Tex.Format, Tex.Width, Tex.Height, Lvl ) || Level.Off > std::size( Bytes )
+           || Level.Size > std::size( Bytes ) - Level.Off )
+      {
+        return std::nullopt;
+      }
+
+      Tex.Levels.push_back( Bytes.subspan( Level.Off, Level.Size ) );
+    }
+
+    Tex.File = std::move( File );
+    return Tex;
+  }
+
+}  // namespace Mvk::Detail
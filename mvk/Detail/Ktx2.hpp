@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Detail/MappedFile.hpp"
+#include "Detail/TexFormat.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Mvk::Detail
+{
+  // The parts of KTX 2.0 we read and write: one 2D image, no array layers or faces and no supercompression
+  struct Ktx2Header
+  {
+    std::array<uint8_t, 12> Identifier;
+    uint32_t                VkFormat;
+    uint32_t                TypeSize;
+    uint32_t                PixelWidth;
+    uint32_t                PixelHeight;
+    uint32_t                PixelDepth;
+    uint32_t                LayerCnt;
+    uint32_t                FaceCnt;
+    uint32_t                LevelCnt;
+    uint32_t                SupercompressionScheme;
+    uint32_t                DfdOff;
+    uint32_t                DfdSize;
+    uint32_t                KvdOff;
+    uint32_t                KvdSize;
+    uint64_t                SgdOff;
+    uint64_t                SgdSize;
+  };
+
+  // Follows the header, one per level with level 0 first
+  struct Ktx2Level
+  {
+    uint64_t Off;
+    uint64_t Size;
+    uint64_t UncompressedSize;
+  };
+
+  inline constexpr auto Ktx2Identifier = std::array<uint8_t, 12>{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+  // Level data is aligned to this, a multiple of every block size
+  inline constexpr uint64_t Ktx2LevelAlignment = 16;
+
+  // Levels either point into File or into memory owned by whoever filled the view
+  struct TexView
+  {
+    std::shared_ptr<MappedFile const>       File;
+    TexFormat                               Format;
+    uint32_t                                Width;
+    uint32_t                                Height;
+    std::vector<std::span<std::byte const>> Levels;
+  };
+
+  [[nodiscard]] bool writeKtx2( std::filesystem::path const &           Path,
+                                TexFormat                               Format,
+                                uint32_t                                Width,
+                                uint32_t                                Height,
+                                std::span<std::vector<std::byte> const> Levels ) noexcept;
+
+  // std::nullopt when the file is missing, malformed or uses something outside of the subset above
+  [[nodiscard]] std::optional<TexView> readKtx2( std::filesystem::path const & Path ) noexcept;
+
+}  // namespace Mvk::Detail
@@ -0,0 +1,48 @@
+#include "Detail/MappedFile.hpp"
+
+#include "Detail/Misc.hpp"
+#include "Utility/Verify.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Mvk::Detail
+{
+  MappedFile::MappedFile( std::filesystem::path const & Path ) noexcept : Data( nullptr ), Size( 0 ), MappedSize( 0 )
+  {
+    auto const Fd = open( Path.c_str(), O_RDONLY );
+    MVK_VERIFY( Fd != -1 );
+
+    struct stat Stat = {};
+
+    [[maybe_unused]] auto const Result = fstat( Fd, &Stat );
+    MVK_VERIFY( Result == 0 );
+
+    Size       = static_cast<size_t>( Stat.st_size );
+    MappedSize = alignedSize( Size, static_cast<size_t>( sysconf( _SC_PAGESIZE ) ) );
+
+    if ( Size != 0 )
+    {
+      auto * const Mapped = mmap( nullptr, MappedSize, PROT_READ, MAP_PRIVATE, Fd, 0 );
+      MVK_VERIFY( Mapped != MAP_FAILED );
+
+      // Payloads are read front to back, once
+      madvise( Mapped, MappedSize, MADV_SEQUENTIAL );
+      Data = static_cast<std::byte const *>( Mapped );
+    }
+
+    // The mapping keeps its own reference to the file
+    close( Fd );
+  }
+
+  MappedFile::~MappedFile() noexcept
+  {
+    if ( Data != nullptr )
+    {
+      munmap( const_cast<std::byte *>( Data ), MappedSize );
+    }
+  }
+
+}  // namespace Mvk::Detail
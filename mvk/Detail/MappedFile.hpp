@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Utility/Macros.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace Mvk::Detail
+{
+  // Read only view of a whole file, the pages are only read from disk when touched
+  class MappedFile
+  {
+  public:
+    explicit MappedFile( std::filesystem::path const & Path ) noexcept;
+    MVK_DEFINE_NON_COPYABLE( MappedFile );
+    MVK_DEFINE_NON_MOVABLE( MappedFile );
+    ~MappedFile() noexcept;
+
+    [[nodiscard]] constexpr std::span<std::byte const> getData() const noexcept;
+    [[nodiscard]] constexpr size_t                     getSize() const noexcept;
+    // Size rounded up to the page size, every byte up to it can be read
+    [[nodiscard]] constexpr size_t                     getMappedSize() const noexcept;
+    // Where Src starts in the file, it has to point into the mapping
+    [[nodiscard]] constexpr size_t                     getOff( std::span<std::byte const> Src ) const noexcept;
+
+  private:
+    std::byte const * Data;
+    size_t            Size;
+    size_t            MappedSize;
+  };
+
+  [[nodiscard]] constexpr std::span<std::byte const> MappedFile::getData() const noexcept
+  {
+    return { Data, Size };
+  }
+
+  [[nodiscard]] constexpr size_t MappedFile::getSize() const noexcept
+  {
+    return Size;
+  }
+
+  [[nodiscard]] constexpr size_t MappedFile::getMappedSize() const noexcept
+  {
+    return MappedSize;
+  }
+
+  [[nodiscard]] constexpr size_t MappedFile::getOff( std::span<std::byte const> Src ) const noexcept
+  {
+    return static_cast<size_t>( std::data( Src ) - Data );
+  }
+
+}  // namespace Mvk::Detail
@@ -0,0 +1,122 @@
+#include "Detail/MeshFile.hpp"
+
+#include "Detail/Misc.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace Mvk::Detail
+{
+  [[nodiscard]] std::optional<FileStamp> getFileStamp( std::filesystem::path const & Path ) noexcept
+  {
+    auto       Error     = std::error_code();
+    auto const Size      = std::filesystem::file_size( Path, Error );
+    auto const WriteTime = std::filesystem::last_write_time( Path, Error );
+
+    if ( Error )
+    {
+      return std::nullopt;
+    }
+
+    return FileStamp{ Size, static_cast<int64_t>( WriteTime.time_since_epoch().count() ) };
+  }
+
+  [[nodiscard]] bool writeMesh( std::filesystem::path const & Path,
+                                std::span<std::byte const>    VtxBytes,
+                                uint32_t                      VtxStride,
+                                pos_dequant const &           Dequant,
+                                std::span<uint32_t const>     Idxs,
+                                uint64_t                      SrcHash,
+                                FileStamp const &             SrcStamp ) noexcept
+  {
+    auto const VtxSize = std::size( VtxBytes );
+    auto const IdxSize = std::size( Idxs ) * sizeof( uint32_t );
+
+    auto Header         = MeshFileHeader();
+    Header.Magic        = MeshFileMagic;
+    Header.Version      = MeshFileVersion;
+    Header.VtxStride    = VtxStride;
+    Header.VtxCnt       = static_cast<uint32_t>( VtxSize / VtxStride );
+    Header.IdxCnt       = static_cast<uint32_t>( std::size( Idxs ) );
+    Header.Reserved     = 0;
+    Header.VtxOff       = alignedSize( sizeof( MeshFileHeader ), MeshFileAlignment );
+    Header.IdxOff       = alignedSize( Header.VtxOff + VtxSize, MeshFileAlignment );
+    Header.SrcHash      = SrcHash;
+    Header.SrcSize      = SrcStamp.Size;
+    Header.SrcWriteTime = SrcStamp.WriteTime;
+
+    for ( auto Axis = 0; Axis < 3; ++Axis )
+    {
+      Header.BoundsMin[Axis] = Dequant.offset[Axis] - Dequant.scale[Axis];
+      Header.BoundsMax[Axis] = Dequant.offset[Axis] + Dequant.scale[Axis];
+      Header.PosScale[Axis]  = Dequant.scale[Axis];
+      Header.PosOffset[Axis] = Dequant.offset[Axis];
+    }
+
+    auto Contents = std::vector<std::byte>( Header.IdxOff + IdxSize );
+    std::memcpy( std::data( Contents ), &Header, sizeof( Header ) );
+    std::memcpy( std::data( Contents ) + Header.VtxOff, std::data( VtxBytes ), VtxSize );
+    std::memcpy( std::data( Contents ) + Header.IdxOff, std::data( Idxs ), IdxSize );
+
+    auto File = std::ofstream( Path, std::ios::binary | std::ios::trunc );
+    File.write( reinterpret_cast<char const *>( std::data( Contents ) ), static_cast<std::streamsize>( std::size( Contents ) ) );
+
+    return File.good();
+  }
+
+  [[nodiscard]] std::optional<MeshView> readMesh( std::filesystem::path const & Path, uint32_t VtxStride ) noexcept
+  {
+    if ( !std::filesystem::exists( Path ) )
+    {
+      return std::nullopt;
+    }
+
+    auto       File  = std::make_shared<MappedFile const>( Path );
+    auto const Bytes = File->getData();
+
+    if ( std::size( Bytes ) < sizeof( MeshFileHeader ) )
+    {
+      return std::nullopt;
+    }
+
+    auto Header = MeshFileHeader();
+    std::memcpy( &Header, std::data( Bytes ), sizeof( Header ) );
+
+    auto const VtxSize = uint64_t( Header.VtxCnt ) * Header.VtxStride;
+    auto const IdxSize = uint64_t( Header.IdxCnt ) * sizeof( uint32_t );
+
+    auto const IsValid = Header.Magic == MeshFileMagic && Header.Version == MeshFileVersion
+                      && Header.VtxStride == VtxStride && Header.VtxOff % MeshFileAlignment == 0
+                      && Header.IdxOff % MeshFileAlignment == 0 && Header.VtxOff <= std::size( Bytes )
+                      && VtxSize <= std::size( Bytes ) - Header.VtxOff && Header.IdxOff <= std::size( Bytes )
+                      && IdxSize <= std::size( Bytes ) - Header.IdxOff;
+
+    if ( !IsValid )
+    {
+      return std::nullopt;
+    }
+
+    auto Mesh     = MeshView();
+    Mesh.VtxBytes = Bytes.subspan( Header.VtxOff, VtxSize );
+    Mesh.Idxs     = { reinterpret_cast<uint32_t const *>( std::data( Bytes ) + Header.IdxOff ), Header.IdxCnt };
+    Mesh.VtxCnt   = Header.VtxCnt;
+    Mesh.SrcHash  = Header.SrcHash;
+    Mesh.SrcStamp = FileStamp{ Header.SrcSize, Header.SrcWriteTime };
+
+    // Checked once here so the draws can trust them, a corrupted index would otherwise read past the vertex buffer
+    if ( std::ranges::any_of( Mesh.Idxs, [&]( uint32_t Idx ) { return Idx >= Header.VtxCnt; } ) )
+    {
+      return std::nullopt;
+    }
+
+    Mesh.File = std::move( File );
+
+    Mesh.Dequant.scale  = glm::vec4( Header.PosScale[0], Header.PosScale[1], Header.PosScale[2], 0.0F );
+    Mesh.Dequant.offset = glm::vec4( Header.PosOffset[0], Header.PosOffset[1], Header.PosOffset[2], 0.0F );
+
+    return Mesh;
+  }
+
+}  // namespace Mvk::Detail
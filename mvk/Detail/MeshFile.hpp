@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Detail/MappedFile.hpp"
+#include "Detail/VtxPack.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+
+namespace Mvk::Detail
+{
+  // Bumped whenever the header or a vertex format changes, older files are ignored and the OBJ is parsed again
+  inline constexpr uint32_t MeshFileVersion = 3;
+
+  // Sections start on this, enough for the vertex fetch and for the host import of the staging
+  inline constexpr uint64_t MeshFileAlignment = 4096;
+
+  // Little endian, followed by the sections at the offsets it gives. Plain floats instead of glm types so the layout
+  // doesn't depend on the glm configuration
+  struct MeshFileHeader
+  {
+    std::array<char, 4>  Magic;
+    uint32_t             Version;
+    uint32_t             VtxStride;
+    uint32_t             VtxCnt;
+    uint32_t             IdxCnt;
+    uint32_t             Reserved;
+    uint64_t             VtxOff;
+    uint64_t             IdxOff;
+    // hashSrc of the OBJ it was made from, tells a file that outlived an edit of its OBJ. The OBJ is only hashed when
+    // its size or write time changed, see FileStamp
+    uint64_t             SrcHash;
+    uint64_t             SrcSize;
+    int64_t              SrcWriteTime;
+    std::array<float, 3> BoundsMin;
+    std::array<float, 3> BoundsMax;
+    // The exact pos_dequant the vertices were packed with
+    std::array<float, 3> PosScale;
+    std::array<float, 3> PosOffset;
+  };
+
+  inline constexpr auto MeshFileMagic = std::array{ 'M', 'V', 'K', 'M' };
+
+  // Tells that a file may have changed without reading it, the write time is in ticks of the filesystem clock
+  struct FileStamp
+  {
+    uint64_t Size;
+    int64_t  WriteTime;
+
+    constexpr bool operator==( FileStamp const & Other ) const noexcept = default;
+  };
+
+  // std::nullopt when the file is missing
+  [[nodiscard]] std::optional<FileStamp> getFileStamp( std::filesystem::path const & Path ) noexcept;
+
+  // Everything points into File, which has to outlive the spans
+  struct MeshView
+  {
+    std::shared_ptr<MappedFile const> File;
+    std::span<std::byte const>        VtxBytes;
+    std::span<uint32_t const>         Idxs;
+    uint32_t                          VtxCnt;
+    pos_dequant                       Dequant;
+    uint64_t                          SrcHash;
+    FileStamp                         SrcStamp;
+  };
+
+  // The stride is what tells the vertex formats apart, readMesh only takes files with the one it's asked for
+  [[nodiscard]] bool writeMesh( std::filesystem::path const & Path,
+                                std::span<std::byte const>    VtxBytes,
+                                uint32_t                      VtxStride,
+                                pos_dequant const &           Dequant,
+                                std::span<uint32_t const>     Idxs,
+                                uint64_t                      SrcHash,
+                                FileStamp const &             SrcStamp ) noexcept;
+
+  template <typename Vtx>
+  [[nodiscard]] bool writeMesh( std::filesystem::path const & Path,
+                                MeshVtxs<Vtx> const &         Mesh,
+                                std::span<uint32_t const>     Idxs,
+                                uint64_t                      SrcHash,
+                                FileStamp const &             SrcStamp ) noexcept
+  {
+    return writeMesh( Path, std::as_bytes( std::span( Mesh.Vtxs ) ), sizeof( Vtx ), Mesh.Dequant, Idxs, SrcHash, SrcStamp );
+  }
+
+  // std::nullopt when the file is missing, truncated, from another version, has other vertices or an index past them
+  [[nodiscard]] std::optional<MeshView> readMesh( std::filesystem::path const & Path, uint32_t VtxStride ) noexcept;
+
+}  // namespace Mvk::Detail
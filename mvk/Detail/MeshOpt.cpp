@@ -0,0 +1,436 @@
+#include "Detail/MeshOpt.hpp"
+
+#include "Utility/Verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+
+namespace Mvk::Detail
+{
+  namespace
+  {
+    struct VtxHash
+    {
+      [[nodiscard]] size_t operator()( vertex const & Vtx ) const noexcept
+      {
+        auto const Attrs = std::array{ Vtx.pos.x,   Vtx.pos.y,   Vtx.pos.z,           Vtx.color.x,
+                                       Vtx.color.y, Vtx.color.z, Vtx.texture_coord.x, Vtx.texture_coord.y };
+
+        // FNV-1a over the bits, the padding of the aligned vectors is left out
+        auto Hash = size_t( 14695981039346656037ULL );
+
+        for ( auto const Attr : Attrs )
+        {
+          Hash = ( Hash ^ std::bit_cast<uint32_t>( Attr ) ) * size_t( 1099511628211ULL );
+        }
+
+        return Hash;
+      }
+    };
+
+    struct VtxEq
+    {
+      [[nodiscard]] bool operator()( vertex const & Lhs, vertex const & Rhs ) const noexcept
+      {
+        return Lhs.pos == Rhs.pos && Lhs.color == Rhs.color && Lhs.texture_coord == Rhs.texture_coord;
+      }
+    };
+
+    // Triangles using each vertex, packed one vertex after the other
+    struct Adjacency
+    {
+      std::vector<uint32_t> Offs;
+      std::vector<uint32_t> Cnts;
+      std::vector<uint32_t> Tris;
+    };
+
+    [[nodiscard]] Adjacency buildAdjacency( std::span<uint32_t const> Idxs, size_t VtxCnt ) noexcept
+    {
+      auto Adj = Adjacency();
+      Adj.Offs.resize( VtxCnt, 0 );
+      Adj.Cnts.resize( VtxCnt, 0 );
+      Adj.Tris.resize( std::size( Idxs ) );
+
+      for ( auto const Idx : Idxs )
+      {
+        ++Adj.Cnts[Idx];
+      }
+
+      std::exclusive_scan( std::begin( Adj.Cnts ), std::end( Adj.Cnts ), std::begin( Adj.Offs ), uint32_t( 0 ) );
+
+      auto Fill = Adj.Offs;
+
+      for ( auto Idx = size_t( 0 ); Idx < std::size( Idxs ); ++Idx )
+      {
+        Adj.Tris[Fill[Idxs[Idx]]++] = static_cast<uint32_t>( Idx / 3 );
+      }
+
+      return Adj;
+    }
+
+    // FIFO like the hardware, a hit doesn't move the vertex
+    class CacheSim
+    {
+    public:
+      CacheSim( size_t VtxCnt, uint32_t CacheSize ) noexcept : Stamps( VtxCnt, 0 ), Time( CacheSize + 1 ), CacheSize( CacheSize )
+      {
+      }
+
+      [[nodiscard]] bool access( uint32_t Vtx ) noexcept
+      {
+        if ( Time - Stamps[Vtx] <= CacheSize )
+        {
+          return true;
+        }
+
+        Stamps[Vtx] = Time++;
+        return false;
+      }
+
+      void clear() noexcept
+      {
+        Time += CacheSize + 1;
+      }
+
+    private:
+      std::vector<uint64_t> Stamps;
+      uint64_t              Time;
+      uint64_t              CacheSize;
+    };
+
+    [[nodiscard]] uint32_t countMisses( CacheSim & Cache, std::span<uint32_t const> Tri ) noexcept
+    {
+      auto Misses = uint32_t( 0 );
+
+      for ( auto const Vtx : Tri )
+      {
+        Misses += Cache.access( Vtx ) ? 0 : 1;
+      }
+
+      return Misses;
+    }
+
+  }  // namespace
+
+  [[nodiscard]] float calcAcmr( std::span<uint32_t const> Idxs, size_t VtxCnt, uint32_t CacheSize ) noexcept
+  {
+    if ( std::empty( Idxs ) )
+    {
+      return 0.0F;
+    }
+
+    auto Cache  = CacheSim( VtxCnt, CacheSize );
+    auto Misses = size_t( 0 );
+
+    for ( auto Idx = size_t( 0 ); Idx < std::size( Idxs ); Idx += 3 )
+    {
+      Misses += countMisses( Cache, Idxs.subspan( Idx, 3 ) );
+    }
+
+    return static_cast<float>( Misses ) / static_cast<float>( std::size( Idxs ) / 3 );
+  }
+
+  void dedupVtxs( std::vector<vertex> & Vtxs, std::vector<uint32_t> & Idxs ) noexcept
+  {
+    auto Unique = std::vector<vertex>();
+    auto Remap  = std::vector<uint32_t>( std::size( Vtxs ) );
+    auto Seen   = std::unordered_map<vertex, uint32_t, VtxHash, VtxEq>();
+
+    Unique.reserve( std::size( Vtxs ) );
+    Seen.reserve( std::size( Vtxs ) );
+
+    for ( auto Idx = size_t( 0 ); Idx < std::size( Vtxs ); ++Idx )
+    {
+      auto const [Found, Inserted] = Seen.try_emplace( Vtxs[Idx], static_cast<uint32_t>( std::size( Unique ) ) );
+
+      if ( Inserted )
+      {
+        Unique.push_back( Vtxs[Idx] );
+      }
+
+      Remap[Idx] = Found->second;
+    }
+
+    for ( auto & Idx : Idxs )
+    {
+      Idx = Remap[Idx];
+    }
+
+    Vtxs = std::move( Unique );
+  }
+
+  [[nodiscard]] std::vector<uint32_t> optimizeVtxCache( std::span<uint32_t> Idxs, size_t VtxCnt, uint32_t CacheSize ) noexcept
+  {
+    MVK_VERIFY( std::size( Idxs ) % 3 == 0 );
+
+    auto const TriCnt = std::size( Idxs ) / 3;
+    auto const Adj    = buildAdjacency( Idxs, VtxCnt );
+
+    auto LiveTris  = Adj.Cnts;
+    auto Stamps    = std::vector<uint64_t>( VtxCnt, 0 );
+    auto Emitted   = std::vector<bool>( TriCnt, false );
+    auto DeadEnds  = std::vector<uint32_t>();
+    auto Fanned    = std::vector<uint32_t>();
+    auto Out       = std::vector<uint32_t>();
+    auto Clusters  = std::vector<uint32_t>();
+    auto Time      = uint64_t( CacheSize ) + 1;
+    auto Cursor    = uint32_t( 0 );
+    auto IsInCache = [&]( uint32_t Vtx ) { return Time - Stamps[Vtx] <= CacheSize; };
+
+    Out.reserve( std::size( Idxs ) );
+
+    // Vertices are only picked from the stack once every close candidate is done, the scan starts a new cluster
+    auto const skipDeadEnd = [&]() -> std::optional<uint32_t>
+    {
+      while ( !DeadEnds.empty() )
+      {
+        auto const Vtx = DeadEnds.back();
+        DeadEnds.pop_back();
+
+        if ( LiveTris[Vtx] > 0 )
+        {
+          return Vtx;
+        }
+      }
+
+      for ( ; Cursor < VtxCnt; ++Cursor )
+      {
+        if ( LiveTris[Cursor] > 0 )
+        {
+          Clusters.push_back( static_cast<uint32_t>( std::size( Out ) / 3 ) );
+          return Cursor;
+        }
+      }
+
+      return std::nullopt;
+    };
+
+    auto Fan = skipDeadEnd();
+
+    while ( Fan.has_value() )
+    {
+      Fanned.clear();
+
+      auto const Begin = Adj.Offs[Fan.value()];
+
+      for ( auto const Tri : std::span( Adj.Tris ).subspan( Begin, Adj.Cnts[Fan.value()] ) )
+      {
+        if ( Emitted[Tri] )
+        {
+          continue;
+        }
+
+        for ( auto const Vtx : Idxs.subspan( Tri * 3, 3 ) )
+        {
+          Out.push_back( Vtx );
+          DeadEnds.push_back( Vtx );
+          Fanned.push_back( Vtx );
+          --LiveTris[Vtx];
+
+          if ( !IsInCache( Vtx ) )
+          {
+            Stamps[Vtx] = Time++;
+          }
+        }
+
+        Emitted[Tri] = true;
+      }
+
+      // The candidate that will still be in the cache once all its triangles are emitted and entered it the earliest
+      auto Best     = std::optional<uint32_t>();
+      auto BestPrio = int64_t( -1 );
+
+      for ( auto const Vtx : Fanned )
+      {
+        if ( LiveTris[Vtx] == 0 )
+        {
+          continue;
+        }
+
+        auto Prio = int64_t( 0 );
+
+        if ( auto const Age = static_cast<int64_t>( Time - Stamps[Vtx] ); Age + 2 * LiveTris[Vtx] <= CacheSize )
+        {
+          Prio = Age;
+        }
+
+        if ( Prio > BestPrio )
+        {
+          Best     = Vtx;
+          BestPrio = Prio;
+        }
+      }
+
+      Fan = Best.has_value() ? Best : skipDeadEnd();
+    }
+
+    std::copy( std::begin( Out ), std::end( Out ), std::begin( Idxs ) );
+
+    return Clusters;
+  }
+
+  void optimizeOverdraw( std::span<uint32_t>       Idxs,
+                         std::span<vertex const>   Vtxs,
+                         std::span<uint32_t const> ClusterStarts,
+                         float                     Threshold,
+                         uint32_t                  CacheSize ) noexcept
+  {
+    auto const TriCnt = static_cast<uint32_t>( std::size( Idxs ) / 3 );
+
+    if ( TriCnt == 0 )
+    {
+      return;
+    }
+
+    // Soft boundaries, a cluster ends as soon as it's about as cache friendly as the hard cluster it belongs to, past that
+    // point splitting costs little
+    auto Starts = std::vector<uint32_t>();
+    auto Cache  = CacheSim( std::size( Vtxs ), CacheSize );
+
+    for ( auto Hard = size_t( 0 ); Hard < std::size( ClusterStarts ); ++Hard )
+    {
+      auto const Begin = ClusterStarts[Hard];
+      auto const End   = Hard + 1 < std::size( ClusterStarts ) ? ClusterStarts[Hard + 1] : TriCnt;
+      auto const Tris  = Idxs.subspan( Begin * 3, ( End - Begin ) * 3 );
+      auto const Acmr  = calcAcmr( Tris, std::size( Vtxs ), CacheSize );
+
+      Cache.clear();
+      Starts.push_back( Begin );
+
+      auto Misses = uint32_t( 0 );
+      auto Cnt    = uint32_t( 0 );
+
+      for ( auto Tri = Begin; Tri < End; ++Tri )
+      {
+        Misses += countMisses( Cache, Idxs.subspan( Tri * 3, 3 ) );
+        ++Cnt;
+
+        if ( Tri + 1 < End && static_cast<float>( Misses ) <= Acmr * Threshold * static_cast<float>( Cnt ) && Cnt > 1 )
+        {
+          Cache.clear();
+          Starts.push_back( Tri + 1 );
+          Misses = 0;
+          Cnt    = 0;
+        }
+      }
+    }
+
+    if ( std::empty( Starts ) || Starts.front() != 0 )
+    {
+      Starts.insert( std::begin( Starts ), 0 );
+    }
+
+    auto const getPos = [&]( uint32_t Idx ) { return Vtxs[Idx].pos; };
+
+    auto MeshCenter = glm::vec3( 0.0F );
+
+    for ( auto const Idx : Idxs )
+    {
+      MeshCenter += getPos( Idx );
+    }
+
+    MeshCenter /= static_cast<float>( std::size( Idxs ) );
+
+    struct Cluster
+    {
+      uint32_t Begin;
+      uint32_t End;
+      float    Key;
+    };
+
+    auto Clusters = std::vector<Cluster>();
+    Clusters.reserve( std::size( Starts ) );
+
+    for ( auto Idx = size_t( 0 ); Idx < std::size( Starts ); ++Idx )
+    {
+      auto const Begin = Starts[Idx];
+      auto const End   = Idx + 1 < std::size( Starts ) ? Starts[Idx + 1] : TriCnt;
+
+      auto Center = glm::vec3( 0.0F );
+      auto Normal = glm::vec3( 0.0F );
+      auto Area   = 0.0F;
+
+      for ( auto Tri = Begin; Tri < End; ++Tri )
+      {
+        auto const A = getPos( Idxs[Tri * 3 + 0] );
+        auto const B = getPos( Idxs[Tri * 3 + 1] );
+        auto const C = getPos( Idxs[Tri * 3 + 2] );
+
+        // Twice the area, the scale cancels out
+        auto const Cross   = glm::cross( B - A, C - A );
+        auto const TriArea = glm::length( Cross );
+
+        Center += ( A + B + C ) * ( TriArea / 3.0F );
+        Normal += Cross;
+        Area += TriArea;
+      }
+
+      auto const NormalLen = glm::length( Normal );
+      auto const Key       = Area > 0.0F && NormalLen > 0.0F ? glm::dot( Center / Area - MeshCenter, Normal / NormalLen ) : 0.0F;
+
+      Clusters.push_back( { Begin, End, Key } );
+    }
+
+    std::stable_sort( std::begin( Clusters ),
+                      std::end( Clusters ),
+                      []( Cluster const & Lhs, Cluster const & Rhs ) { return Lhs.Key > Rhs.Key; } );
+
+    auto Sorted = std::vector<uint32_t>();
+    Sorted.reserve( std::size( Idxs ) );
+
+    for ( auto const & Current : Clusters )
+    {
+      auto const Tris = Idxs.subspan( Current.Begin * 3, ( Current.End - Current.Begin ) * 3 );
+      Sorted.insert( std::end( Sorted ), std::begin( Tris ), std::end( Tris ) );
+    }
+
+    std::copy( std::begin( Sorted ), std::end( Sorted ), std::begin( Idxs ) );
+  }
+
+  void optimizeVtxFetch( std::vector<vertex> & Vtxs, std::span<uint32_t> Idxs ) noexcept
+  {
+    constexpr auto Unused = std::numeric_limits<uint32_t>::max();
+
+    auto Remap   = std::vector<uint32_t>( std::size( Vtxs ), Unused );
+    auto Ordered = std::vector<vertex>();
+    Ordered.reserve( std::size( Vtxs ) );
+
+    for ( auto & Idx : Idxs )
+    {
+      if ( Remap[Idx] == Unused )
+      {
+        Remap[Idx] = static_cast<uint32_t>( std::size( Ordered ) );
+        Ordered.push_back( Vtxs[Idx] );
+      }
+
+      Idx = Remap[Idx];
+    }
+
+    // Vertices no triangle uses are dropped
+    Vtxs = std::move( Ordered );
+  }
+
+  [[nodiscard]] MeshOptStats optimizeMesh( std::vector<vertex> & Vtxs, std::vector<uint32_t> & Idxs ) noexcept
+  {
+    auto Stats         = MeshOptStats();
+    Stats.VtxCntBefore = std::size( Vtxs );
+    Stats.AcmrBefore   = calcAcmr( Idxs, std::size( Vtxs ) );
+
+    dedupVtxs( Vtxs, Idxs );
+
+    auto const ClusterStarts = optimizeVtxCache( Idxs, std::size( Vtxs ) );
+    optimizeOverdraw( Idxs, Vtxs, ClusterStarts );
+    optimizeVtxFetch( Vtxs, Idxs );
+
+    Stats.VtxCntAfter = std::size( Vtxs );
+    Stats.AcmrAfter   = calcAcmr( Idxs, std::size( Vtxs ) );
+
+    return Stats;
+  }
+
+}  // namespace Mvk::Detail
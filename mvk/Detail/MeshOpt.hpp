@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ShaderTypes.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Mvk::Detail
+{
+  // Post transform cache the reordering aims for, close to how desktop GPUs behave
+  inline constexpr uint32_t VtxCacheSize = 16;
+
+  // Clusters are split once their ACMR gets within this factor of the ACMR of the whole cluster, higher gives more
+  // clusters to sort at the cost of cache hits
+  inline constexpr float OverdrawThreshold = 1.05F;
+
+  struct MeshOptStats
+  {
+    size_t VtxCntBefore;
+    size_t VtxCntAfter;
+    float  AcmrBefore;
+    float  AcmrAfter;
+  };
+
+  // Average cache misses per triangle with a FIFO cache, 3 means every vertex gets transformed for every triangle
+  [[nodiscard]] float calcAcmr( std::span<uint32_t const> Idxs, size_t VtxCnt, uint32_t CacheSize = VtxCacheSize ) noexcept;
+
+  // Merges the vertices with the same attributes, Idxs points to the merged ones after it
+  void dedupVtxs( std::vector<vertex> & Vtxs, std::vector<uint32_t> & Idxs ) noexcept;
+
+  // Tipsify, triangles fan around the vertex that stays the longest in the cache. Returns the first triangle of every
+  // cluster that had to start over from a vertex the cache didn't have
+  [[nodiscard]] std::vector<uint32_t>
+    optimizeVtxCache( std::span<uint32_t> Idxs, size_t VtxCnt, uint32_t CacheSize = VtxCacheSize ) noexcept;
+
+  // Splits the clusters further and draws the ones facing away from the center of the mesh first, they tend to occlude
+  // the rest
+  void optimizeOverdraw( std::span<uint32_t>       Idxs,
+                         std::span<vertex const>   Vtxs,
+                         std::span<uint32_t const> ClusterStarts,
+                         float                     Threshold = OverdrawThreshold,
+                         uint32_t                  CacheSize = VtxCacheSize ) noexcept;
+
+  // Orders the vertices by first use so fetches walk the buffer forward
+  void optimizeVtxFetch( std::vector<vertex> & Vtxs, std::span<uint32_t> Idxs ) noexcept;
+
+  // All the stages above, in order
+  [[nodiscard]] MeshOptStats optimizeMesh( std::vector<vertex> & Vtxs, std::vector<uint32_t> & Idxs ) noexcept;
+
+}  // namespace Mvk::Detail
@@ -0,0 +1,108 @@
+#include "Detail/MipChain.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace Mvk::Detail
+{
+  namespace
+  {
+    [[nodiscard]] float toLinear( uint8_t Value ) noexcept
+    {
+      static auto const Table = []
+      {
+        auto Values = std::array<float, 256>();
+
+        for ( auto Idx = size_t( 0 ); Idx < 256; ++Idx )
+        {
+          auto const Srgb = static_cast<float>( Idx ) / 255.0F;
+          Values[Idx]     = Srgb <= 0.04045F ? Srgb / 12.92F : std::pow( ( Srgb + 0.055F ) / 1.055F, 2.4F );
+        }
+
+        return Values;
+      }();
+
+      return Table[Value];
+    }
+
+    [[nodiscard]] uint8_t toSrgb( float Value ) noexcept
+    {
+      auto const Srgb = Value <= 0.0031308F ? Value * 12.92F : 1.055F * std::pow( Value, 1.0F / 2.4F ) - 0.055F;
+      return static_cast<uint8_t>( std::clamp( std::lround( Srgb * 255.0F ), 0L, 255L ) );
+    }
+
+  }  // namespace
+
+  [[nodiscard]] std::vector<uint8_t> downsampleRgba8( std::span<uint8_t const> Texels, uint32_t Width, uint32_t Height ) noexcept
+  {
+    auto const DstWidth  = std::max( Width / 2, 1U );
+    auto const DstHeight = std::max( Height / 2, 1U );
+
+    auto Dst = std::vector<uint8_t>( size_t( DstWidth ) * DstHeight * 4 );
+
+    for ( auto Y = uint32_t( 0 ); Y < DstHeight; ++Y )
+    {
+      for ( auto X = uint32_t( 0 ); X < DstWidth; ++X )
+      {
+        auto const Xs = std::array{ std::min( 2 * X, Width - 1 ), std::min( 2 * X + 1, Width - 1 ) };
+        auto const Ys = std::array{ std::min( 2 * Y, Height - 1 ), std::min( 2 * Y + 1, Height - 1 ) };
+
+        auto Sum = std::array<float, 4>();
+
+        for ( auto const SrcY : Ys )
+        {
+          for ( auto const SrcX : Xs )
+          {
+            auto const * Texel = &Texels[( size_t( SrcY ) * Width + SrcX ) * 4];
+
+            for ( auto Ch = size_t( 0 ); Ch < 3; ++Ch )
+            {
+              Sum[Ch] += toLinear( Texel[Ch] ) / 4.0F;
+            }
+
+            Sum[3] += static_cast<float>( Texel[3] ) / 4.0F;
+          }
+        }
+
+        auto * Texel = &Dst[( size_t( Y ) * DstWidth + X ) * 4];
+
+        for ( auto Ch = size_t( 0 ); Ch < 3; ++Ch )
+        {
+          Texel[Ch] = toSrgb( Sum[Ch] );
+        }
+
+        Texel[3] = static_cast<uint8_t>( std::clamp( std::lround( Sum[3] ), 0L, 255L ) );
+      }
+    }
+
+    return Dst;
+  }
+
+  [[nodiscard]] std::vector<std::vector<std::byte>> genMipChain( std::span<uint8_t const> Texels, uint32_t Width, uint32_t Height ) noexcept
+  {
+    // Same count as calcMipLvl
+    auto const LevelCnt = static_cast<uint32_t>( std::bit_width( std::max( Width, Height ) ) );
+
+    auto Levels = std::vector<std::vector<std::byte>>();
+    Levels.reserve( LevelCnt );
+
+    auto Level = std::vector<uint8_t>( std::begin( Texels ), std::end( Texels ) );
+
+    for ( auto Lvl = uint32_t( 0 ); Lvl < LevelCnt; ++Lvl )
+    {
+      if ( Lvl != 0 )
+      {
+        Level = downsampleRgba8( Level, std::max( Width >> ( Lvl - 1 ), 1U ), std::max( Height >> ( Lvl - 1 ), 1U ) );
+      }
+
+      auto & Bytes = Levels.emplace_back( std::size( Level ) );
+      std::memcpy( std::data( Bytes ), std::data( Level ), std::size( Level ) );
+    }
+
+    return Levels;
+  }
+
+}  // namespace Mvk::Detail
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Mvk::Detail
+{
+  // RGBA in sRGB. 2x2 box filter in linear space, what the blits of ImgObj::generateMips do for sRGB images. The result is
+  // max( Width / 2, 1 ) by max( Height / 2, 1 ), odd sizes repeat the last row or column
+  [[nodiscard]] std::vector<uint8_t> downsampleRgba8( std::span<uint8_t const> Texels, uint32_t Width, uint32_t Height ) noexcept;
+
+  // Every level down to 1x1, the first one is a copy of Texels
+  [[nodiscard]] std::vector<std::vector<std::byte>>
+    genMipChain( std::span<uint8_t const> Texels, uint32_t Width, uint32_t Height ) noexcept;
+
+}  // namespace Mvk::Detail
@@ -42,7 +42,7 @@ namespace Mvk::Detail
     {
       auto const & CurrentType   = MemProp.memoryTypes[i];
       auto const   CurrentFlags  = CurrentType.propertyFlags;
-      auto const   MatchesFlags  = ( CurrentFlags & PropFlags ) != 0U;
+      auto const   MatchesFlags  = ( CurrentFlags & PropFlags ) == PropFlags;
       auto const   MatchesFilter = ( Filter & ( 1U << i ) ) != 0U;
 
       if ( MatchesFlags && MatchesFilter )
@@ -74,7 +74,8 @@ namespace Mvk::Detail
     return static_cast<uint32_t>( std::floor( std::log2( std::max( Height, Width ) ) ) + 1 );
   }
 
-  void transitionImgLayout( VkCommandBuffer CmdBuff, VkImage Img, VkImageLayout OldLay, VkImageLayout NewLay, uint32_t MipLvl ) noexcept
+  void transitionImgLayout(
+    VkCommandBuffer CmdBuff, VkImage Img, VkImageLayout OldLay, VkImageLayout NewLay, uint32_t MipLvl, uint32_t BaseLvl ) noexcept
   {
     auto ImgMemBarrier                = VkImageMemoryBarrier();
     ImgMemBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -93,7 +94,7 @@ namespace Mvk::Detail
       ImgMemBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     }
 
-    ImgMemBarrier.subresourceRange.baseMipLevel   = 0;
+    ImgMemBarrier.subresourceRange.baseMipLevel   = BaseLvl;
     ImgMemBarrier.subresourceRange.levelCount     = MipLvl;
     ImgMemBarrier.subresourceRange.baseArrayLayer = 0;
     ImgMemBarrier.subresourceRange.layerCount     = 1;
@@ -124,6 +125,14 @@ namespace Mvk::Detail
       SrcStage                    = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
       DstStage                    = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
     }
+    else if ( OldLay == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL && NewLay == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL )
+    {
+      ImgMemBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+      ImgMemBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+      SrcStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+      DstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
     else
     {
       MVK_VERIFY_NOT_REACHED();
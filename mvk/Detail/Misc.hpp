@@ -28,7 +28,9 @@ namespace Mvk::Detail
     return static_cast<decltype( Size + Alignment )>( Size );
   }
 
-  void transitionImgLayout( VkCommandBuffer CmdBuff, VkImage Img, VkImageLayout OldLay, VkImageLayout NewLay, uint32_t MipLvl ) noexcept;
+  // Levels [BaseLvl, BaseLvl + MipLvl)
+  void transitionImgLayout(
+    VkCommandBuffer CmdBuff, VkImage Img, VkImageLayout OldLay, VkImageLayout NewLay, uint32_t MipLvl, uint32_t BaseLvl = 0 ) noexcept;
   void generateMip( VkCommandBuffer CmdBuff, VkImage Img, size_t Width, size_t Height, uint32_t MipLvl ) noexcept;
 
 }  // namespace Mvk::Detail
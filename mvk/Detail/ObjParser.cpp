@@ -0,0 +1,563 @@
+#include "Detail/ObjParser.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string_view>
+#include <thread>
+
+namespace Mvk::Detail
+{
+  namespace
+  {
+    // Indices are stored as written until every chunk is parsed, the relative ones only mean something once the counts of
+    // the chunks before are known
+    struct ObjCorner
+    {
+      int32_t V;
+      int32_t Vt;
+      bool    IsVRel;
+      bool    IsVtRel;
+    };
+
+    struct ObjChunk
+    {
+      std::vector<float>     Positions;
+      std::vector<float>     TexCoords;
+      std::vector<ObjCorner> Corners;
+      std::vector<uint8_t>   FaceSizes;
+      size_t                 TriCnt  = 0;
+      bool                   IsValid = true;
+    };
+
+    [[nodiscard]] constexpr bool isSpace( char C ) noexcept
+    {
+      return C == ' ' || C == '\t';
+    }
+
+    [[nodiscard]] constexpr bool isDigit( char C ) noexcept
+    {
+      return C >= '0' && C <= '9';
+    }
+
+    [[nodiscard]] char const * skipSpaces( char const * Curr, char const * End ) noexcept
+    {
+      while ( Curr != End && isSpace( *Curr ) )
+      {
+        ++Curr;
+      }
+
+      return Curr;
+    }
+
+    [[nodiscard]] char const * skipUntil( char const * Curr, char const * End, std::string_view Stops ) noexcept
+    {
+      while ( Curr != End && Stops.find( *Curr ) == std::string_view::npos )
+      {
+        ++Curr;
+      }
+
+      return Curr;
+    }
+
+    // tryParseDouble of tinyobj, strtod and from_chars round differently and the output has to match to the bit
+    [[nodiscard]] std::optional<double> parseDouble( char const * Begin, char const * End ) noexcept
+    {
+      if ( Begin >= End )
+      {
+        return std::nullopt;
+      }
+
+      constexpr auto PowLut = std::array{ 1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001 };
+
+      auto Mantissa      = 0.0;
+      auto Exponent      = 0;
+      auto IsNegative    = false;
+      auto IsExpNegative = false;
+      auto LeadingDot    = false;
+      auto Curr          = Begin;
+
+      if ( *Curr == '+' || *Curr == '-' )
+      {
+        IsNegative = *Curr == '-';
+        ++Curr;
+        LeadingDot = Curr != End && *Curr == '.';
+      }
+      else if ( *Curr == '.' )
+      {
+        LeadingDot = true;
+      }
+      else if ( !isDigit( *Curr ) )
+      {
+        return std::nullopt;
+      }
+
+      auto const assemble = [&]
+      {
+        auto const Abs = Exponent != 0 ? std::ldexp( Mantissa * std::pow( 5.0, Exponent ), Exponent ) : Mantissa;
+        return IsNegative ? -Abs : Abs;
+      };
+
+      if ( !LeadingDot )
+      {
+        auto Read = 0;
+
+        for ( ; Curr != End && isDigit( *Curr ); ++Curr, ++Read )
+        {
+          Mantissa *= 10;
+          Mantissa += static_cast<int>( *Curr - '0' );
+        }
+
+        if ( Read == 0 )
+        {
+          return std::nullopt;
+        }
+      }
+
+      if ( Curr == End )
+      {
+        return assemble();
+      }
+
+      if ( *Curr == '.' )
+      {
+        ++Curr;
+
+        for ( auto Read = 1; Curr != End && isDigit( *Curr ); ++Curr, ++Read )
+        {
+          auto const Scale = Read < static_cast<int>( std::size( PowLut ) ) ? PowLut[static_cast<size_t>( Read )] : std::pow( 10.0, -Read );
+          Mantissa += static_cast<int>( *Curr - '0' ) * Scale;
+        }
+      }
+      else if ( *Curr != 'e' && *Curr != 'E' )
+      {
+        return assemble();
+      }
+
+      if ( Curr == End || ( *Curr != 'e' && *Curr != 'E' ) )
+      {
+        return assemble();
+      }
+
+      ++Curr;
+
+      if ( Curr != End && ( *Curr == '+' || *Curr == '-' ) )
+      {
+        IsExpNegative = *Curr == '-';
+        ++Curr;
+      }
+      else if ( Curr == End || !isDigit( *Curr ) )
+      {
+        return std::nullopt;
+      }
+
+      auto Read = 0;
+
+      for ( ; Curr != End && isDigit( *Curr ); ++Curr, ++Read )
+      {
+        if ( Exponent > std::numeric_limits<int>::max() / 10 )
+        {
+          return std::nullopt;
+        }
+
+        Exponent = Exponent * 10 + static_cast<int>( *Curr - '0' );
+      }
+
+      if ( Read == 0 )
+      {
+        return std::nullopt;
+      }
+
+      Exponent *= IsExpNegative ? -1 : 1;
+      return assemble();
+    }
+
+    // parseReal of tinyobj, a malformed number gives 0
+    [[nodiscard]] float parseReal( char const *& Curr, char const * End ) noexcept
+    {
+      Curr             = skipSpaces( Curr, End );
+      auto const Token = Curr;
+      Curr             = skipUntil( Curr, End, " \t\r" );
+
+      return static_cast<float>( parseDouble( Token, Curr ).value_or( 0.0 ) );
+    }
+
+    // atoi, overflows aside
+    [[nodiscard]] int32_t parseInt( char const * Curr, char const * End ) noexcept
+    {
+      while ( Curr != End && ( isSpace( *Curr ) || *Curr == '\v' || *Curr == '\f' || *Curr == '\r' ) )
+      {
+        ++Curr;
+      }
+
+      auto IsNegative = false;
+
+      if ( Curr != End && ( *Curr == '+' || *Curr == '-' ) )
+      {
+        IsNegative = *Curr == '-';
+        ++Curr;
+      }
+
+      auto Value = int64_t( 0 );
+
+      for ( ; Curr != End && isDigit( *Curr ); ++Curr )
+      {
+        Value = Value * 10 + ( *Curr - '0' );
+      }
+
+      return static_cast<int32_t>( IsNegative ? -Value : Value );
+    }
+
+    // fixIndex of tinyobj, 0 is the only invalid value
+    [[nodiscard]] bool fixIndex( int32_t Idx, int32_t Cnt, int32_t & Out, bool & IsRel ) noexcept
+    {
+      IsRel = Idx < 0;
+      Out   = Idx > 0 ? Idx - 1 : Cnt + Idx;
+      return Idx != 0;
+    }
+
+    // parseTriple of tinyobj, i, i/j, i//k or i/j/k. Normals are only checked
+    [[nodiscard]] std::optional<ObjCorner> parseCorner( char const *& Curr, char const * End, int32_t VCnt, int32_t VtCnt ) noexcept
+    {
+      constexpr auto Stops = std::string_view( "/ \t\r" );
+
+      auto Corner   = ObjCorner{ 0, -1, false, false };
+      auto NormalId = int32_t( 0 );
+      auto IsRel    = false;
+
+      if ( !fixIndex( parseInt( Curr, End ), VCnt, Corner.V, Corner.IsVRel ) )
+      {
+        return std::nullopt;
+      }
+
+      Curr = skipUntil( Curr, End, Stops );
+
+      if ( Curr == End || *Curr != '/' )
+      {
+        return Corner;
+      }
+
+      ++Curr;
+
+      if ( Curr != End && *Curr == '/' )
+      {
+        ++Curr;
+
+        if ( !fixIndex( parseInt( Curr, End ), 0, NormalId, IsRel ) )
+        {
+          return std::nullopt;
+        }
+
+        Curr = skipUntil( Curr, End, Stops );
+        return Corner;
+      }
+
+      if ( !fixIndex( parseInt( Curr, End ), VtCnt, Corner.Vt, Corner.IsVtRel ) )
+      {
+        return std::nullopt;
+      }
+
+      Curr = skipUntil( Curr, End, Stops );
+
+      if ( Curr == End || *Curr != '/' )
+      {
+        return Corner;
+      }
+
+      ++Curr;
+
+      if ( !fixIndex( parseInt( Curr, End ), 0, NormalId, IsRel ) )
+      {
+        return std::nullopt;
+      }
+
+      Curr = skipUntil( Curr, End, Stops );
+      return Corner;
+    }
+
+    void parseLine( ObjChunk & Chunk, char const * Curr, char const * End ) noexcept
+    {
+      Curr = skipSpaces( Curr, End );
+
+      auto const getChar = [Curr, End]( ptrdiff_t Idx ) { return Idx < End - Curr ? Curr[Idx] : '\0'; };
+
+      if ( getChar( 0 ) == 'v' && isSpace( getChar( 1 ) ) )
+      {
+        Curr += 2;
+
+        for ( auto Axis = 0; Axis < 3; ++Axis )
+        {
+          Chunk.Positions.push_back( parseReal( Curr, End ) );
+        }
+
+        return;
+      }
+
+      if ( getChar( 0 ) == 'v' && getChar( 1 ) == 't' && isSpace( getChar( 2 ) ) )
+      {
+        Curr += 3;
+
+        for ( auto Axis = 0; Axis < 2; ++Axis )
+        {
+          Chunk.TexCoords.push_back( parseReal( Curr, End ) );
+        }
+
+        return;
+      }
+
+      if ( getChar( 0 ) != 'f' || !isSpace( getChar( 1 ) ) )
+      {
+        return;
+      }
+
+      Curr = skipSpaces( Curr + 2, End );
+
+      // Relative indices count from what this chunk has seen, the rest is added once the chunks are merged
+      auto const VCnt  = static_cast<int32_t>( std::size( Chunk.Positions ) / 3 );
+      auto const VtCnt = static_cast<int32_t>( std::size( Chunk.TexCoords ) / 2 );
+      auto       Size  = size_t( 0 );
+
+      while ( Curr != End && *Curr != '\r' )
+      {
+        auto const Corner = parseCorner( Curr, End, VCnt, VtCnt );
+
+        if ( !Corner.has_value() )
+        {
+          Chunk.IsValid = false;
+          return;
+        }
+
+        Chunk.Corners.push_back( *Corner );
+        ++Size;
+
+        Curr = std::find_if( Curr, End, []( char C ) { return !isSpace( C ) && C != '\r'; } );
+      }
+
+      // Larger polygons are triangulated by ear clipping, not worth matching
+      if ( Size > 4 )
+      {
+        Chunk.IsValid = false;
+        return;
+      }
+
+      Chunk.FaceSizes.push_back( static_cast<uint8_t>( Size ) );
+      Chunk.TriCnt += Size < 3 ? 0 : Size - 2;
+    }
+
+    [[nodiscard]] ObjChunk parseChunk( char const * Curr, char const * End ) noexcept
+    {
+      auto Chunk = ObjChunk();
+
+      while ( Curr != End )
+      {
+        auto LineEnd = Curr;
+
+        while ( LineEnd != End && *LineEnd != '\n' && *LineEnd != '\r' )
+        {
+          // tinyobj would stop reading the line there
+          if ( *LineEnd == '\0' )
+          {
+            Chunk.IsValid = false;
+            return Chunk;
+          }
+
+          ++LineEnd;
+        }
+
+        if ( LineEnd != Curr && *Curr != '#' )
+        {
+          parseLine( Chunk, Curr, LineEnd );
+
+          if ( !Chunk.IsValid )
+          {
+            return Chunk;
+          }
+        }
+
+        // \n, \r\n and \r all end a line
+        Curr = LineEnd;
+        Curr += Curr != End && *Curr == '\r' ? 1 : 0;
+        Curr += Curr != End && *Curr == '\n' ? 1 : 0;
+      }
+
+      return Chunk;
+    }
+
+    template <typename Fn> void runParallel( size_t Cnt, Fn const & Func ) noexcept
+    {
+      auto Threads = std::vector<std::thread>();
+      Threads.reserve( Cnt );
+
+      for ( auto Idx = size_t( 1 ); Idx < Cnt; ++Idx )
+      {
+        Threads.emplace_back( Func, Idx );
+      }
+
+      Func( 0 );
+
+      for ( auto & Thread : Threads )
+      {
+        Thread.join();
+      }
+    }
+
+  }  // namespace
+
+  [[nodiscard]] std::optional<std::pair<std::vector<vertex>, std::vector<uint32_t>>> parseObj( std::span<std::byte const> Text,
+                                                                                               uint32_t ThreadCnt ) noexcept
+  {
+    auto const * const Begin = reinterpret_cast<char const *>( std::data( Text ) );
+    auto const * const End   = Begin + std::size( Text );
+
+    if ( ThreadCnt == 0 )
+    {
+      ThreadCnt = std::max( std::thread::hardware_concurrency(), 1U );
+    }
+
+    auto const MaxChunkCnt = std::clamp( std::size( Text ) / MinObjChunkSize, size_t( 1 ), size_t( ThreadCnt ) );
+
+    // Each chunk starts right after a line feed, a \r\n never gets split
+    auto Bounds = std::vector<char const *>{ Begin };
+
+    for ( auto Idx = size_t( 1 ); Idx < MaxChunkCnt; ++Idx )
+    {
+      auto const * Split = std::max( Begin + std::size( Text ) * Idx / MaxChunkCnt, Bounds.back() );
+      Split              = std::find( Split, End, '\n' );
+      Split += Split != End ? 1 : 0;
+
+      if ( Split != Bounds.back() && Split != End )
+      {
+        Bounds.push_back( Split );
+      }
+    }
+
+    Bounds.push_back( End );
+
+    auto const ChunkCnt = std::size( Bounds ) - 1;
+    auto       Chunks   = std::vector<ObjChunk>( ChunkCnt );
+
+    runParallel( ChunkCnt, [&]( size_t Idx ) { Chunks[Idx] = parseChunk( Bounds[Idx], Bounds[Idx + 1] ); } );
+
+    if ( std::any_of( std::begin( Chunks ), std::end( Chunks ), []( ObjChunk const & Chunk ) { return !Chunk.IsValid; } ) )
+    {
+      return std::nullopt;
+    }
+
+    // Where each chunk goes in the merged attributes and in the output
+    auto PosOffs = std::vector<size_t>( ChunkCnt + 1, 0 );
+    auto TexOffs = std::vector<size_t>( ChunkCnt + 1, 0 );
+    auto OutOffs = std::vector<size_t>( ChunkCnt + 1, 0 );
+
+    for ( auto Idx = size_t( 0 ); Idx < ChunkCnt; ++Idx )
+    {
+      PosOffs[Idx + 1] = PosOffs[Idx] + std::size( Chunks[Idx].Positions );
+      TexOffs[Idx + 1] = TexOffs[Idx] + std::size( Chunks[Idx].TexCoords );
+      OutOffs[Idx + 1] = OutOffs[Idx] + Chunks[Idx].TriCnt * 3;
+    }
+
+    auto Positions = std::vector<float>( PosOffs.back() );
+    auto TexCoords = std::vector<float>( TexOffs.back() );
+
+    runParallel( ChunkCnt,
+                 [&]( size_t Idx )
+                 {
+                   auto const & Chunk = Chunks[Idx];
+                   std::copy( std::begin( Chunk.Positions ), std::end( Chunk.Positions ), std::data( Positions ) + PosOffs[Idx] );
+                   std::copy( std::begin( Chunk.TexCoords ), std::end( Chunk.TexCoords ), std::data( TexCoords ) + TexOffs[Idx] );
+                 } );
+
+    auto const VCnt  = static_cast<int64_t>( std::size( Positions ) / 3 );
+    auto const VtCnt = static_cast<int64_t>( std::size( TexCoords ) / 2 );
+
+    auto Vtxs    = std::vector<vertex>( OutOffs.back() );
+    auto Idxs    = std::vector<uint32_t>( OutOffs.back() );
+    auto IsValid = std::vector<uint8_t>( ChunkCnt, 1 );
+
+    runParallel( ChunkCnt,
+                 [&]( size_t ChunkIdx )
+                 {
+                   auto const & Chunk = Chunks[ChunkIdx];
+
+                   auto const VBase  = static_cast<int64_t>( PosOffs[ChunkIdx] / 3 );
+                   auto const VtBase = static_cast<int64_t>( TexOffs[ChunkIdx] / 2 );
+                   auto       Out    = OutOffs[ChunkIdx];
+                   auto       Corner = size_t( 0 );
+
+                   auto const getPos = [&Positions]( int64_t V )
+                   {
+                     auto const Idx = static_cast<size_t>( V ) * 3;
+                     return glm::vec3( Positions[Idx + 0], Positions[Idx + 1], Positions[Idx + 2] );
+                   };
+
+                   // Same as readObj, a missing UV reads as 0
+                   auto const emit = [&]( int64_t V, int64_t Vt )
+                   {
+                     auto const U = Vt < 0 ? 0.0F : TexCoords[static_cast<size_t>( Vt ) * 2 + 0];
+                     auto const W = Vt < 0 ? 0.0F : TexCoords[static_cast<size_t>( Vt ) * 2 + 1];
+
+                     Vtxs[Out].pos           = getPos( V );
+                     Vtxs[Out].color         = glm::vec3( 1.0F, 1.0F, 1.0F );
+                     Vtxs[Out].texture_coord = glm::vec2( U, 1 - W );
+                     Idxs[Out]               = static_cast<uint32_t>( Out );
+                     ++Out;
+                   };
+
+                   for ( auto const Size : Chunk.FaceSizes )
+                   {
+                     auto Vs  = std::array<int64_t, 4>();
+                     auto Vts = std::array<int64_t, 4>();
+
+                     for ( auto Idx = size_t( 0 ); Idx < Size; ++Idx )
+                     {
+                       auto const & Current = Chunk.Corners[Corner + Idx];
+
+                       Vs[Idx]  = Current.V + ( Current.IsVRel ? VBase : 0 );
+                       Vts[Idx] = Current.Vt + ( Current.IsVtRel ? VtBase : 0 );
+
+                       // A missing UV is the only index allowed out of range
+                       auto const IsMissingUv = Current.Vt == -1 && !Current.IsVtRel;
+
+                       if ( Vs[Idx] < 0 || Vs[Idx] >= VCnt || ( !IsMissingUv && ( Vts[Idx] < 0 || Vts[Idx] >= VtCnt ) ) )
+                       {
+                         IsValid[ChunkIdx] = 0;
+                         return;
+                       }
+                     }
+
+                     Corner += Size;
+
+                     if ( Size == 3 )
+                     {
+                       emit( Vs[0], Vts[0] );
+                       emit( Vs[1], Vts[1] );
+                       emit( Vs[2], Vts[2] );
+                     }
+                     else if ( Size == 4 )
+                     {
+                       // The shorter diagonal splits the quad, computed in float like tinyobj
+                       auto const E02 = getPos( Vs[2] ) - getPos( Vs[0] );
+                       auto const E13 = getPos( Vs[3] ) - getPos( Vs[1] );
+
+                       auto const Sqr02 = E02.x * E02.x + E02.y * E02.y + E02.z * E02.z;
+                       auto const Sqr13 = E13.x * E13.x + E13.y * E13.y + E13.z * E13.z;
+
+                       auto const Order = Sqr02 < Sqr13 ? std::array{ 0, 1, 2, 0, 2, 3 } : std::array{ 0, 1, 3, 1, 2, 3 };
+
+                       for ( auto const Idx : Order )
+                       {
+                         emit( Vs[static_cast<size_t>( Idx )], Vts[static_cast<size_t>( Idx )] );
+                       }
+                     }
+                   }
+                 } );
+
+    if ( std::find( std::begin( IsValid ), std::end( IsValid ), 0 ) != std::end( IsValid ) )
+    {
+      return std::nullopt;
+    }
+
+    return std::make_pair( std::move( Vtxs ), std::move( Idxs ) );
+  }
+
+}  // namespace Mvk::Detail
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ShaderTypes.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Mvk::Detail
+{
+  // Chunks smaller than this aren't worth a thread
+  inline constexpr size_t MinObjChunkSize = 1024 * 1024;
+
+  // Parses the file in chunks split at line boundaries, one thread per chunk, 0 threads means one per core. Gives exactly
+  // what parseObjTinyobj gives, one vertex per face corner. std::nullopt for what it doesn't handle the same way, polygons
+  // past quads and malformed or out of range faces, the caller is expected to fall back to tinyobj
+  [[nodiscard]] std::optional<std::pair<std::vector<vertex>, std::vector<uint32_t>>> parseObj( std::span<std::byte const> Text,
+                                                                                               uint32_t ThreadCnt = 0 ) noexcept;
+
+}  // namespace Mvk::Detail
@@ -6,11 +6,16 @@
 #include "tiny_obj_loader.h"
 #pragma clang diagnostic pop
 
+#include "Detail/MappedFile.hpp"
+#include "Detail/MeshOpt.hpp"
+#include "Detail/ObjParser.hpp"
 #include "Utility/Verify.hpp"
 
+#include <fstream>
+
 namespace Mvk::Detail
 {
-  [[nodiscard]] std::pair<std::vector<vertex>, std::vector<uint32_t>> readObj( std::filesystem::path const & Path ) noexcept
+  [[nodiscard]] std::pair<std::vector<vertex>, std::vector<uint32_t>> parseObjTinyobj( std::filesystem::path const & Path ) noexcept
   {
     auto Attr   = tinyobj::attrib_t();
     auto Shapes = std::vector<tinyobj::shape_t>();
@@ -44,10 +49,16 @@ namespace Mvk::Detail
 
         Vtx.color = glm::vec3( 1.0F, 1.0F, 1.0F );
 
+        // A missing UV reads as 0
         auto const TexCoordIdx = static_cast<size_t>( Idx.texcoord_index );
 
-        Vtx.texture_coord = [&Attr, &TexCoordIdx]
+        Vtx.texture_coord = [&Attr, &Idx, &TexCoordIdx]
         {
+          if ( Idx.texcoord_index < 0 )
+          {
+            return glm::vec2( 0.0F, 1.0F );
+          }
+
           auto const X = Attr.texcoords[2 * TexCoordIdx + 0];
           auto const Y = Attr.texcoords[2 * TexCoordIdx + 1];
           return glm::vec2( X, 1 - Y );
@@ -60,6 +71,33 @@ namespace Mvk::Detail
     return std::make_pair( Vtxs, Idxs );
   }
 
+  [[nodiscard]] std::pair<std::vector<vertex>, std::vector<uint32_t>> readObj( std::filesystem::path const & Path,
+                                                                               ObjReport *                   Report ) noexcept
+  {
+    MVK_VERIFY( std::filesystem::exists( Path ) );
+
+    auto const File       = MappedFile( Path );
+    auto       Parsed     = parseObj( File.getData() );
+    auto const IsFallback = !Parsed.has_value();
+
+    if ( IsFallback )
+    {
+      Parsed = parseObjTinyobj( Path );
+    }
+
+    auto & [Vtxs, Idxs] = *Parsed;
+
+    // Every index got its own vertex while parsing, the indices only mean something after this
+    auto const Stats = optimizeMesh( Vtxs, Idxs );
+
+    if ( Report != nullptr )
+    {
+      *Report = ObjReport{ IsFallback, Stats };
+    }
+
+    return std::move( *Parsed );
+  }
+
   [[nodiscard]] std::vector<char> readFile( std::filesystem::path const & Path ) noexcept
   {
     MVK_VERIFY( std::filesystem::exists( Path ) );
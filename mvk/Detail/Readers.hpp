@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Detail/MeshOpt.hpp"
 #include "ShaderTypes.hpp"
 
 #include <filesystem>
@@ -8,7 +9,20 @@
 
 namespace Mvk::Detail
 {
-  [[nodiscard]] std::pair<std::vector<vertex>, std::vector<uint32_t>> readObj( std::filesystem::path const & Path ) noexcept;
+  // One vertex per face corner, no deduplication. Kept as the reference for parseObj and for the files it gives up on
+  [[nodiscard]] std::pair<std::vector<vertex>, std::vector<uint32_t>> parseObjTinyobj( std::filesystem::path const & Path ) noexcept;
+
+  // What readObj did with a file, nothing is printed on load so the tools report it themselves
+  struct ObjReport
+  {
+    // Not handled by parseObj, parsed with parseObjTinyobj
+    bool         IsFallback;
+    MeshOptStats Opt;
+  };
+
+  // Parsed with parseObj, then deduplicated and reordered
+  [[nodiscard]] std::pair<std::vector<vertex>, std::vector<uint32_t>> readObj( std::filesystem::path const & Path,
+                                                                               ObjReport *                   Report = nullptr ) noexcept;
 
   [[nodiscard]] std::vector<char> readFile( std::filesystem::path const & Path ) noexcept;
 
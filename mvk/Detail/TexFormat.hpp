@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Detail
+{
+  // Everything is sRGB, the BC formats come from tex-encoder
+  enum class TexFormat : uint8_t
+  {
+    Rgba8,
+    Bc1,
+    Bc3,
+    Bc7
+  };
+
+  inline constexpr auto TexFormatCnt = size_t( 4 );
+
+  [[nodiscard]] constexpr VkFormat getVkFormat( TexFormat Format ) noexcept
+  {
+    switch ( Format )
+    {
+      case TexFormat::Rgba8: return VK_FORMAT_R8G8B8A8_SRGB;
+      case TexFormat::Bc1: return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+      case TexFormat::Bc3: return VK_FORMAT_BC3_SRGB_BLOCK;
+      case TexFormat::Bc7: return VK_FORMAT_BC7_SRGB_BLOCK;
+    }
+
+    return VK_FORMAT_UNDEFINED;
+  }
+
+  [[nodiscard]] constexpr std::optional<TexFormat> getTexFormat( VkFormat Format ) noexcept
+  {
+    switch ( Format )
+    {
+      case VK_FORMAT_R8G8B8A8_SRGB: return TexFormat::Rgba8;
+      case VK_FORMAT_BC1_RGB_SRGB_BLOCK: return TexFormat::Bc1;
+      case VK_FORMAT_BC3_SRGB_BLOCK: return TexFormat::Bc3;
+      case VK_FORMAT_BC7_SRGB_BLOCK: return TexFormat::Bc7;
+      default: return std::nullopt;
+    }
+  }
+
+  // Side of the square a block covers, a texel is a block of one for uncompressed formats
+  [[nodiscard]] constexpr uint32_t getBlockDim( TexFormat Format ) noexcept
+  {
+    return Format == TexFormat::Rgba8 ? 1 : 4;
+  }
+
+  [[nodiscard]] constexpr uint32_t getBlockSize( TexFormat Format ) noexcept
+  {
+    switch ( Format )
+    {
+      case TexFormat::Rgba8: return 4;
+      case TexFormat::Bc1: return 8;
+      case TexFormat::Bc3: return 16;
+      case TexFormat::Bc7: return 16;
+    }
+
+    return 0;
+  }
+
+  // Bytes of level Lvl when the blocks are tightly packed, which is what the buffer to image copies expect
+  [[nodiscard]] constexpr size_t getLevelSize( TexFormat Format, size_t Width, size_t Height, uint32_t Lvl ) noexcept
+  {
+    auto const Dim       = getBlockDim( Format );
+    auto const LvlWidth  = std::max( Width >> Lvl, size_t( 1 ) );
+    auto const LvlHeight = std::max( Height >> Lvl, size_t( 1 ) );
+
+    return ( ( LvlWidth + Dim - 1 ) / Dim ) * ( ( LvlHeight + Dim - 1 ) / Dim ) * getBlockSize( Format );
+  }
+
+}  // namespace Mvk::Detail
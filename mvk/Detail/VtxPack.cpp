@@ -0,0 +1,80 @@
+#include "Detail/VtxPack.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Mvk::Detail
+{
+  namespace
+  {
+    [[nodiscard]] int16_t toSnorm16( float Val ) noexcept
+    {
+      return static_cast<int16_t>( std::lround( std::clamp( Val, -1.0F, 1.0F ) * 32767.0F ) );
+    }
+
+    [[nodiscard]] uint16_t toUnorm16( float Val ) noexcept
+    {
+      return static_cast<uint16_t>( std::lround( std::clamp( Val, 0.0F, 1.0F ) * 65535.0F ) );
+    }
+
+    [[nodiscard]] pos_dequant calcDequant( std::span<vertex const> Vtxs ) noexcept
+    {
+      auto Min = glm::vec3( std::numeric_limits<float>::max() );
+      auto Max = glm::vec3( std::numeric_limits<float>::lowest() );
+
+      for ( auto const & Vtx : Vtxs )
+      {
+        Min = glm::min( Min, Vtx.pos );
+        Max = glm::max( Max, Vtx.pos );
+      }
+
+      auto Dequant   = pos_dequant();
+      Dequant.scale  = glm::vec4( ( Max - Min ) / 2.0F, 0.0F );
+      Dequant.offset = glm::vec4( ( Min + Max ) / 2.0F, 0.0F );
+      return Dequant;
+    }
+
+  }  // namespace
+
+  [[nodiscard]] PackedMesh packVtxs( std::span<vertex const> Vtxs ) noexcept
+  {
+    auto Packed    = PackedMesh();
+    Packed.Dequant = calcDequant( Vtxs );
+    Packed.Vtxs.reserve( std::size( Vtxs ) );
+
+    auto const Center = glm::vec3( Packed.Dequant.offset );
+    auto const Extent = glm::vec3( Packed.Dequant.scale );
+
+    // Flat axes have no extent, everything on them sits on the center
+    auto const normalize = [&Center, &Extent]( glm::vec3 const & Pos, int Axis )
+    { return Extent[Axis] > 0.0F ? ( Pos[Axis] - Center[Axis] ) / Extent[Axis] : 0.0F; };
+
+    for ( auto const & Vtx : Vtxs )
+    {
+      auto Current = packed_vertex();
+
+      Current.pos = {
+        toSnorm16( normalize( Vtx.pos, 0 ) ), toSnorm16( normalize( Vtx.pos, 1 ) ), toSnorm16( normalize( Vtx.pos, 2 ) ), 0
+      };
+
+      Current.texture_coord = { toUnorm16( Vtx.texture_coord.x ), toUnorm16( Vtx.texture_coord.y ) };
+
+      Packed.Vtxs.push_back( Current );
+    }
+
+    return Packed;
+  }
+
+  template <> [[nodiscard]] MeshVtxs<packed_vertex> buildVtxs( std::span<vertex const> Vtxs ) noexcept
+  {
+    return packVtxs( Vtxs );
+  }
+
+  // Already in model space, the dequantization only gives the bounds
+  template <> [[nodiscard]] MeshVtxs<vertex> buildVtxs( std::span<vertex const> Vtxs ) noexcept
+  {
+    return { { std::begin( Vtxs ), std::end( Vtxs ) }, calcDequant( Vtxs ) };
+  }
+
+}  // namespace Mvk::Detail
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ShaderTypes.hpp"
+
+#include <span>
+#include <vector>
+
+namespace Mvk::Detail
+{
+  // Vertices the way a layout reads them, the dequantization always maps [-1, 1] onto the bounds of the mesh
+  template <typename Vtx>
+  struct MeshVtxs
+  {
+    std::vector<Vtx> Vtxs;
+    pos_dequant      Dequant;
+  };
+
+  using PackedMesh = MeshVtxs<packed_vertex>;
+
+  // Quantizes the positions to the bounds of the mesh. UVs outside of [0, 1] are clamped, meshes that wrap their textures
+  // need MVK_FULL_VERTICES
+  [[nodiscard]] PackedMesh packVtxs( std::span<vertex const> Vtxs ) noexcept;
+
+  // What the loaders call for the vertex type of their layout, packed_vertex goes through packVtxs and vertex is copied
+  template <typename Vtx> [[nodiscard]] MeshVtxs<Vtx> buildVtxs( std::span<vertex const> Vtxs ) noexcept;
+
+  template <> [[nodiscard]] MeshVtxs<packed_vertex> buildVtxs( std::span<vertex const> Vtxs ) noexcept;
+  template <> [[nodiscard]] MeshVtxs<vertex> buildVtxs( std::span<vertex const> Vtxs ) noexcept;
+
+}  // namespace Mvk::Detail
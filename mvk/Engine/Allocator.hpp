@@ -9,9 +9,41 @@ namespace Mvk::Engine
   public:
     constexpr explicit Allocator( AllocatorContext & Ctx = AllocatorContext::the() ) noexcept : Ctx( Ctx ) {}
 
-    [[nodiscard]] Allocation allocate( AllocationType Type, VkDeviceSize Size, VkDeviceSize Alignment, MemoryTypeBits BuffMemType ) noexcept
+    // The call site is forwarded so tracking points at the caller and not at this wrapper
+    [[nodiscard]] std::optional<Allocation> allocate( AllocationType       Type,
+                                                      VkDeviceSize         Size,
+                                                      VkDeviceSize         Alignment,
+                                                      MemoryTypeBits       BuffMemType,
+                                                      Relocatable *        Owner = nullptr,
+                                                      std::source_location Loc   = std::source_location::current() ) noexcept
     {
-      return Ctx.allocate( Type, Size, Alignment, BuffMemType );
+      return Ctx.allocate( Type, Size, Alignment, BuffMemType, Owner, Loc );
+    }
+
+    [[nodiscard]] std::optional<Allocation> allocate( AllocationType       Type,
+                                                      VkBuffer             Buff,
+                                                      Relocatable *        Owner = nullptr,
+                                                      std::source_location Loc   = std::source_location::current() ) noexcept
+    {
+      return Ctx.allocate( Type, Buff, Owner, Loc );
+    }
+
+    [[nodiscard]] std::optional<Allocation> allocate( AllocationType       Type,
+                                                      VkImage              Img,
+                                                      Relocatable *        Owner = nullptr,
+                                                      std::source_location Loc   = std::source_location::current() ) noexcept
+    {
+      return Ctx.allocate( Type, Img, Owner, Loc );
+    }
+
+    [[nodiscard]] std::optional<Allocation> allocate( AllocationType       Type,
+                                                      BufferClass          Class,
+                                                      VkDeviceSize         Size,
+                                                      VkDeviceSize         Alignment,
+                                                      Relocatable *        Owner = nullptr,
+                                                      std::source_location Loc   = std::source_location::current() ) noexcept
+    {
+      return Ctx.allocate( Type, Class, Size, Alignment, Owner, Loc );
     }
 
     void free( AllocationID ID ) noexcept
@@ -19,6 +51,21 @@ namespace Mvk::Engine
       Ctx.free( ID );
     }
 
+    void disown( AllocationID ID ) noexcept
+    {
+      Ctx.disown( ID );
+    }
+
+    void flush( AllocationID ID, VkDeviceSize Off, VkDeviceSize Size ) noexcept
+    {
+      Ctx.flush( ID, Off, Size );
+    }
+
+    void invalidate( AllocationID ID, VkDeviceSize Off, VkDeviceSize Size ) noexcept
+    {
+      Ctx.invalidate( ID, Off, Size );
+    }
+
   private:
     AllocatorContext & Ctx;
   };
@@ -1,74 +1,66 @@
 #include "Engine/AllocatorBlock.hpp"
 
 #include "Engine/VulkanContext.hpp"
-#include "Utility/Verify.hpp"
 
 #include <optional>
 
 namespace Mvk::Engine
 {
-  namespace Detail
-  {
-    static constexpr VkMemoryPropertyFlags getMemProperties( AllocationType Type ) noexcept
-    {
-      switch ( Type )
-      {
-        case AllocationType::CpuOnly: return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-        case AllocationType::GpuOnly: return VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-        case AllocationType::CpuToGpu: return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-      }
-    }
-
-    [[nodiscard]] static std::optional<uint32_t>
-      queryMemType( VkPhysicalDevice PhysicalDevice, uint32_t Filter, VkMemoryPropertyFlags PropFlags )
-    {
-      auto MemProp = VkPhysicalDeviceMemoryProperties();
-      vkGetPhysicalDeviceMemoryProperties( PhysicalDevice, &MemProp );
-
-      auto const TypeCount = MemProp.memoryTypeCount;
-
-      for ( auto i = uint32_t( 0 ); i < TypeCount; ++i )
-      {
-        auto const & CurrentType   = MemProp.memoryTypes[i];
-        auto const   CurrentFlags  = CurrentType.propertyFlags;
-        auto const   MatchesFlags  = ( CurrentFlags & PropFlags ) != 0U;
-        auto const   MatchesFilter = ( Filter & ( 1U << i ) ) != 0U;
-
-        if ( MatchesFlags && MatchesFilter )
-        {
-          return i;
-        }
-      }
-
-      return std::nullopt;
-    }
-
-  };  // namespace Detail
-
-  AllocatorBlock::AllocatorBlock( VkDeviceSize Size, AllocationType AllocType, MemoryTypeBits MemType ) noexcept
+  AllocatorBlock::AllocatorBlock( VkDeviceSize                          Size,
+                                  AllocationType                        AllocType,
+                                  MemoryTypeBits                        MemType,
+                                  uint32_t                              MemTypeIdx,
+                                  ResourceTiling                        Tiling,
+                                  BufferClass                           Class,
+                                  VkMemoryDedicatedAllocateInfo const * Dedicated ) noexcept
     : Size( Size )
     , AllocType( AllocType )
     , MemType( MemType )
+    , MemTypeIdx( MemTypeIdx )
+    , Tiling( Tiling )
+    , Class( Class )
     , Mem( VK_NULL_HANDLE )
-    , OwnerCnt( 0 )
-    , Off( 0 )
+    , Buff( VK_NULL_HANDLE )
+    , Ranges( Size )
     , Data( nullptr )
     , IsTombstone( false )
+    , IsEvacuating( false )
+    , IsDedicated( Dedicated != nullptr )
   {
-    auto const PhysicalDevice = VulkanContext::the().getPhysicalDevice();
-
-    auto const MemTypeIdx = Detail::queryMemType( PhysicalDevice, MemType, Detail::getMemProperties( AllocType ) );
-    MVK_VERIFY( MemTypeIdx.has_value() );
-
     auto MemAllocInfo            = VkMemoryAllocateInfo();
     MemAllocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    MemAllocInfo.pNext           = Dedicated;
     MemAllocInfo.allocationSize  = Size;
-    MemAllocInfo.memoryTypeIndex = MemTypeIdx.value();
+    MemAllocInfo.memoryTypeIndex = MemTypeIdx;
 
     auto const Device = VulkanContext::the().getDevice();
 
-    auto Result = vkAllocateMemory( Device, &MemAllocInfo, nullptr, &Mem );
-    MVK_VERIFY( Result == VK_SUCCESS );
+    // Out of memory is handled by AllocatorContext, it can still happen under budget if something else grabbed the memory
+    if ( auto const Result = vkAllocateMemory( Device, &MemAllocInfo, nullptr, &Mem ); Result != VK_SUCCESS )
+    {
+      Mem = VK_NULL_HANDLE;
+      return;
+    }
+
+    if ( Class != BufferClass::None )
+    {
+      auto BuffCrtInfo        = VkBufferCreateInfo();
+      BuffCrtInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+      BuffCrtInfo.size        = Size;
+      BuffCrtInfo.usage       = getBuffUsage( Class );
+      BuffCrtInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+      // Same as running out of memory
+      if ( auto const Result = vkCreateBuffer( Device, &BuffCrtInfo, nullptr, &Buff ); Result != VK_SUCCESS )
+      {
+        vkFreeMemory( Device, Mem, nullptr );
+        Mem  = VK_NULL_HANDLE;
+        Buff = VK_NULL_HANDLE;
+        return;
+      }
+
+      vkBindBufferMemory( Device, Buff, Mem, 0 );
+    }
 
     if ( AllocType != AllocationType::GpuOnly )
     {
@@ -78,9 +70,36 @@ namespace Mvk::Engine
     }
   }
 
+  [[nodiscard]] std::optional<Tlsf::Allocation> AllocatorBlock::allocate( VkDeviceSize AllocSize, VkDeviceSize Alignment ) noexcept
+  {
+    return Ranges.allocate( AllocSize, Alignment );
+  }
+
+  void AllocatorBlock::free( Tlsf::RangeID ID ) noexcept
+  {
+    Owners.erase( ID );
+    Ranges.free( ID );
+  }
+
+  [[nodiscard]] VkDeviceSize AllocatorBlock::getLargestFree() const noexcept
+  {
+    return Ranges.getLargestFree();
+  }
+
+  void AllocatorBlock::addOwner( RangeOwner const & Owner ) noexcept
+  {
+    Owners[Owner.ID.RangeID] = Owner;
+  }
+
+  void AllocatorBlock::removeOwner( Tlsf::RangeID ID ) noexcept
+  {
+    Owners.erase( ID );
+  }
+
   AllocatorBlock::~AllocatorBlock() noexcept
   {
     auto const Device = VulkanContext::the().getDevice();
+    vkDestroyBuffer( Device, Buff, nullptr );
     // Memory is implicitly unmaped
     vkFreeMemory( Device, Mem, nullptr );
   }
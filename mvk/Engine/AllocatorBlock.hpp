@@ -1,9 +1,12 @@
 #pragma once
 
+#include "Engine/Tlsf.hpp"
 #include "Utility/Macros.hpp"
 
 #include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <unordered_map>
 #include <vulkan/vulkan.h>
 
 namespace Mvk::Engine
@@ -12,43 +15,136 @@ namespace Mvk::Engine
   {
     GpuOnly,
     CpuOnly,
-    CpuToGpu
+    CpuToGpu,
+    // Device local memory the CPU writes to directly, only on UMA and resizable BAR. Allocations fail everywhere else
+    GpuMapped,
+    // Readback, cached when the device has such a type
+    GpuToCpu
   };
 
+  static constexpr size_t AllocationTypeCnt = 5;
+
+  // Optimal tiling images get their own blocks when the device has a bufferImageGranularity, so a linear resource never
+  // shares a granularity page with one
+  enum class ResourceTiling
+  {
+    Linear,
+    Optimal
+  };
+
+  // Blocks of a buffer class own a single VkBuffer covering all their memory and hand out (VkBuffer, offset) views of it,
+  // so objects don't create their own buffers
+  enum class BufferClass
+  {
+    None,
+    // Vertex and index data together so draws can share the bindings
+    Geometry,
+    Uniform,
+    Staging
+  };
+
+  static constexpr size_t BufferClassCnt = 4;
+
+  [[nodiscard]] constexpr VkBufferUsageFlags getBuffUsage( BufferClass Class ) noexcept
+  {
+    switch ( Class )
+    {
+      case BufferClass::None: return 0;
+      // Transfer source as well so the defragmenter can copy out of it
+      case BufferClass::Geometry:
+        return VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+               VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+      case BufferClass::Uniform: return VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+      case BufferClass::Staging: return VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    }
+  }
+
   using MemoryTypeBits = uint32_t;
 
+  class Relocatable;
+
+  struct AllocationID
+  {
+    size_t        BlockID;
+    Tlsf::RangeID RangeID;
+    VkDeviceSize  Off;
+    // log2 of the range size if it can go through the thread caches, 0 otherwise
+    uint32_t      CacheClass;
+  };
+
+  // What the defragmenter needs to move a range
+  struct RangeOwner
+  {
+    Relocatable * Owner;
+    AllocationID  ID;
+    VkDeviceSize  Size;
+    VkDeviceSize  Alignment;
+  };
+
   class AllocatorBlock
   {
   public:
     static constexpr VkDeviceSize MinSize = 1024 * 1024 * 16;
 
-    AllocatorBlock( VkDeviceSize Size, AllocationType AllocType, MemoryTypeBits MemType ) noexcept;
+    // Check getMem, the block is left without memory if vkAllocateMemory fails. Dedicated blocks hold a single resource.
+    // Buffer class blocks expect Size to be aligned to what their buffer requires
+    AllocatorBlock( VkDeviceSize                          Size,
+                    AllocationType                        AllocType,
+                    MemoryTypeBits                        MemType,
+                    uint32_t                              MemTypeIdx,
+                    ResourceTiling                        Tiling,
+                    BufferClass                           Class,
+                    VkMemoryDedicatedAllocateInfo const * Dedicated = nullptr ) noexcept;
     MVK_DEFINE_NON_COPYABLE( AllocatorBlock );
     MVK_DEFINE_NON_MOVABLE( AllocatorBlock );
     ~AllocatorBlock() noexcept;
 
+    [[nodiscard]] std::optional<Tlsf::Allocation> allocate( VkDeviceSize AllocSize, VkDeviceSize Alignment ) noexcept;
+
+    void free( Tlsf::RangeID ID ) noexcept;
+
+    void addOwner( RangeOwner const & Owner ) noexcept;
+    void removeOwner( Tlsf::RangeID ID ) noexcept;
+
     [[nodiscard]] constexpr VkDeviceSize   getSize() const noexcept;
     [[nodiscard]] constexpr AllocationType getAllocType() const noexcept;
     [[nodiscard]] constexpr MemoryTypeBits getMemType() const noexcept;
+    [[nodiscard]] constexpr uint32_t       getMemTypeIdx() const noexcept;
+    [[nodiscard]] constexpr ResourceTiling getTiling() const noexcept;
+    [[nodiscard]] constexpr BufferClass    getBuffClass() const noexcept;
+    [[nodiscard]] constexpr VkBuffer       getBuff() const noexcept;
     [[nodiscard]] constexpr VkDeviceMemory getMem() const noexcept;
     [[nodiscard]] constexpr size_t         getOwnerCnt() const noexcept;
-    [[nodiscard]] constexpr VkDeviceSize   getOff() const noexcept;
+    [[nodiscard]] constexpr VkDeviceSize   getUsed() const noexcept;
     [[nodiscard]] constexpr std::byte *    getData() const noexcept;
     [[nodiscard]] constexpr bool           getIsTombstone() const noexcept;
+    [[nodiscard]] constexpr bool           getIsEvacuating() const noexcept;
+    [[nodiscard]] constexpr bool           getIsDedicated() const noexcept;
+    [[nodiscard]] VkDeviceSize             getLargestFree() const noexcept;
+    [[nodiscard]] constexpr Tlsf const &   getRanges() const noexcept;
+
+    [[nodiscard]] constexpr std::unordered_map<Tlsf::RangeID, RangeOwner> const & getOwners() const noexcept;
 
-    constexpr void setOwnerCnt( size_t NewCnt ) noexcept;
-    constexpr void setOff( VkDeviceSize Off ) noexcept;
     constexpr void setIsTombstone( bool State ) noexcept;
+    constexpr void setIsEvacuating( bool State ) noexcept;
 
   private:
     VkDeviceSize   Size;
     AllocationType AllocType;
     MemoryTypeBits MemType;
+    uint32_t       MemTypeIdx;
+    ResourceTiling Tiling;
+    BufferClass    Class;
     VkDeviceMemory Mem;
-    size_t         OwnerCnt;
-    VkDeviceSize   Off;
+    VkBuffer       Buff;
+    Tlsf           Ranges;
     std::byte *    Data;
     bool           IsTombstone;
+    // Being emptied by the defragmenter, nothing new gets allocated here
+    bool           IsEvacuating;
+    bool           IsDedicated;
+
+    std::unordered_map<Tlsf::RangeID, RangeOwner> Owners;
   };
 
   [[nodiscard]] constexpr VkDeviceSize AllocatorBlock::getSize() const noexcept
@@ -66,6 +162,26 @@ namespace Mvk::Engine
     return MemType;
   }
 
+  [[nodiscard]] constexpr uint32_t AllocatorBlock::getMemTypeIdx() const noexcept
+  {
+    return MemTypeIdx;
+  }
+
+  [[nodiscard]] constexpr ResourceTiling AllocatorBlock::getTiling() const noexcept
+  {
+    return Tiling;
+  }
+
+  [[nodiscard]] constexpr BufferClass AllocatorBlock::getBuffClass() const noexcept
+  {
+    return Class;
+  }
+
+  [[nodiscard]] constexpr VkBuffer AllocatorBlock::getBuff() const noexcept
+  {
+    return Buff;
+  }
+
   [[nodiscard]] constexpr VkDeviceMemory AllocatorBlock::getMem() const noexcept
   {
     return Mem;
@@ -73,12 +189,12 @@ namespace Mvk::Engine
 
   [[nodiscard]] constexpr size_t AllocatorBlock::getOwnerCnt() const noexcept
   {
-    return OwnerCnt;
+    return Ranges.getAllocCnt();
   }
 
-  [[nodiscard]] constexpr VkDeviceSize AllocatorBlock::getOff() const noexcept
+  [[nodiscard]] constexpr VkDeviceSize AllocatorBlock::getUsed() const noexcept
   {
-    return Off;
+    return Ranges.getUsed();
   }
 
   [[nodiscard]] constexpr std::byte * AllocatorBlock::getData() const noexcept
@@ -91,14 +207,24 @@ namespace Mvk::Engine
     return IsTombstone;
   }
 
-  constexpr void AllocatorBlock::setOwnerCnt( size_t NewCnt ) noexcept
+  [[nodiscard]] constexpr bool AllocatorBlock::getIsEvacuating() const noexcept
+  {
+    return IsEvacuating;
+  }
+
+  [[nodiscard]] constexpr bool AllocatorBlock::getIsDedicated() const noexcept
   {
-    OwnerCnt = NewCnt;
+    return IsDedicated;
   }
 
-  constexpr void AllocatorBlock::setOff( VkDeviceSize NewOff ) noexcept
+  [[nodiscard]] constexpr Tlsf const & AllocatorBlock::getRanges() const noexcept
   {
-    Off = NewOff;
+    return Ranges;
+  }
+
+  [[nodiscard]] constexpr std::unordered_map<Tlsf::RangeID, RangeOwner> const & AllocatorBlock::getOwners() const noexcept
+  {
+    return Owners;
   }
 
   constexpr void AllocatorBlock::setIsTombstone( bool State ) noexcept
@@ -106,4 +232,9 @@ namespace Mvk::Engine
     IsTombstone = State;
   }
 
+  constexpr void AllocatorBlock::setIsEvacuating( bool State ) noexcept
+  {
+    IsEvacuating = State;
+  }
+
 }  // namespace Mvk::Engine
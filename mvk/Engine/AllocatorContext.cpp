@@ -1,134 +1,1334 @@
 #include "Engine/AllocatorContext.hpp"
 
+#include "Detail/Misc.hpp"
 #include "Utility/Verify.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <tuple>
+
 namespace Mvk::Engine
 {
   namespace Detail
   {
-    [[nodiscard]] constexpr size_t alignedSize( size_t Size, size_t Alignment ) noexcept
+    [[nodiscard]] static Allocation makeAllocation( size_t BlockID, AllocatorBlock const & Block, Tlsf::Allocation Range ) noexcept
+    {
+      auto * const Data = Block.getData() != nullptr ? Block.getData() + Range.Off : nullptr;
+      return { { BlockID, Range.ID, Range.Off, 0 }, Block.getMem(), Range.Off, Data, Block.getBuff() };
+    }
+
+    [[nodiscard]] static constexpr VkMemoryPropertyFlags getMemProperties( AllocationType Type ) noexcept
+    {
+      switch ( Type )
+      {
+        case AllocationType::CpuOnly: return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        case AllocationType::GpuOnly: return VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        case AllocationType::CpuToGpu: return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        case AllocationType::GpuMapped: return VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        case AllocationType::GpuToCpu: return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+      }
+    }
+
+    // Picked over the other types that have the required properties when there's one
+    [[nodiscard]] static constexpr VkMemoryPropertyFlags getPreferredMemProperties( AllocationType Type ) noexcept
+    {
+      switch ( Type )
+      {
+        case AllocationType::GpuOnly: return 0;
+        // Saves the flushes
+        case AllocationType::CpuOnly:
+        case AllocationType::CpuToGpu:
+        case AllocationType::GpuMapped: return VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        // Reading uncached memory goes all the way to RAM for every load
+        case AllocationType::GpuToCpu: return VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+      }
+    }
+
+    // Merges the ranges that overlap or touch, they are already widened to whole atoms
+    static void coalesceMappedRanges( std::vector<VkMappedMemoryRange> & Ranges ) noexcept
+    {
+      auto const byMemAndOff = []( auto const & Lhs, auto const & Rhs )
+      { return std::tie( Lhs.memory, Lhs.offset ) < std::tie( Rhs.memory, Rhs.offset ); };
+
+      std::sort( std::begin( Ranges ), std::end( Ranges ), byMemAndOff );
+
+      auto Last = size_t( 0 );
+
+      for ( auto Idx = size_t( 1 ); Idx < std::size( Ranges ); ++Idx )
+      {
+        auto &       Merged  = Ranges[Last];
+        auto const & Current = Ranges[Idx];
+
+        if ( Current.memory == Merged.memory && Current.offset <= Merged.offset + Merged.size )
+        {
+          Merged.size = std::max( Merged.offset + Merged.size, Current.offset + Current.size ) - Merged.offset;
+          continue;
+        }
+
+        Ranges[++Last] = Current;
+      }
+
+      Ranges.resize( Ranges.empty() ? 0 : Last + 1 );
+    }
+
+    [[nodiscard]] static float getFragmentation( VkDeviceSize Free, VkDeviceSize Largest ) noexcept
+    {
+      return Free != 0 ? 1.0F - static_cast<float>( Largest ) / static_cast<float>( Free ) : 0.0F;
+    }
+
+    [[nodiscard]] static constexpr char const * getTypeName( AllocationType Type ) noexcept
+    {
+      switch ( Type )
+      {
+        case AllocationType::CpuOnly: return "CpuOnly";
+        case AllocationType::GpuOnly: return "GpuOnly";
+        case AllocationType::CpuToGpu: return "CpuToGpu";
+        case AllocationType::GpuMapped: return "GpuMapped";
+        case AllocationType::GpuToCpu: return "GpuToCpu";
+      }
+    }
+
+    // Function names can have quotes in them
+    static void writeJsonString( std::ostream & Out, std::string_view Str ) noexcept
+    {
+      Out << '"';
+
+      for ( auto const Char : Str )
+      {
+        if ( Char == '"' || Char == '\\' )
+        {
+          Out << '\\';
+        }
+
+        Out << Char;
+      }
+
+      Out << '"';
+    }
+
+  }  // namespace Detail
+
+  void AllocatorContext::initialize( Utility::Badge<VulkanContext> ) noexcept
+  {
+    vkGetPhysicalDeviceMemoryProperties( VulkanContext::the().getPhysicalDevice(), &MemProps );
+    HeapReserved.fill( 0 );
+
+    VramHeapIdx = std::nullopt;
+
+    for ( auto i = uint32_t( 0 ); i < MemProps.memoryHeapCount; ++i )
+    {
+      auto const & Heap = MemProps.memoryHeaps[i];
+
+      if ( ( Heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ) != 0U &&
+           ( !VramHeapIdx.has_value() || Heap.size > MemProps.memoryHeaps[VramHeapIdx.value()].size ) )
+      {
+        VramHeapIdx = i;
+      }
+    }
+
+    auto const Device = VulkanContext::the().getDevice();
+
+    BuffClassReqs[static_cast<size_t>( BufferClass::None )] = { 0, 1, ~MemoryTypeBits( 0 ) };
+
+    // The requirements only depend on the usage, so a tiny buffer tells what every block of the class needs
+    for ( auto const Class : { BufferClass::Geometry, BufferClass::Uniform, BufferClass::Staging } )
+    {
+      auto CrtInfo        = VkBufferCreateInfo();
+      CrtInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+      CrtInfo.size        = 1;
+      CrtInfo.usage       = getBuffUsage( Class );
+      CrtInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+      auto       Buff   = VkBuffer();
+      auto const Result = vkCreateBuffer( Device, &CrtInfo, nullptr, &Buff );
+      MVK_VERIFY( Result == VK_SUCCESS );
+
+      vkGetBufferMemoryRequirements( Device, Buff, &BuffClassReqs[static_cast<size_t>( Class )] );
+      vkDestroyBuffer( Device, Buff, nullptr );
+    }
+  }
+
+  AllocatorContext::ThreadCache::~ThreadCache() noexcept
+  {
+    auto & Ctx = AllocatorContext::the();
+
+    // Hand the cached ranges back so their blocks can be released
+    auto Lock = std::scoped_lock( Ctx.Mtx );
+
+    if ( Generation != Ctx.Generation )
+    {
+      return;
+    }
+
+    for ( auto & [Key, KeyBins] : Bins )
+    {
+      for ( auto & Bin : KeyBins )
+      {
+        for ( auto const & Cached : Bin.Ranges )
+        {
+          Ctx.freeLocked( Cached.ID );
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] uint32_t AllocatorContext::getCacheClass( VkDeviceSize Size, VkDeviceSize Alignment ) noexcept
+  {
+    // Cached ranges are aligned to their own size, so any power of two alignment up to it is fine
+    auto const ClassSize  = std::bit_ceil( std::max( { Size, Alignment, VkDeviceSize( 1 ) << MinCacheClass } ) );
+    auto const CacheClass = static_cast<uint32_t>( std::countr_zero( ClassSize ) );
+    return CacheClass <= MaxCacheClass ? CacheClass : 0;
+  }
+
+  [[nodiscard]] size_t AllocatorContext::getMaxCachedCnt( uint32_t CacheClass ) noexcept
+  {
+    return static_cast<size_t>( MaxCachedBytes >> CacheClass );
+  }
+
+  [[nodiscard]] bool AllocatorContext::wantsDedicated( VkMemoryDedicatedRequirements const & Dedicated,
+                                                       VkMemoryRequirements const &          Req ) noexcept
+  {
+    return Dedicated.requiresDedicatedAllocation != VK_FALSE || Dedicated.prefersDedicatedAllocation != VK_FALSE ||
+           Req.size >= DedicatedMinSize;
+  }
+
+  [[nodiscard]] ResourceTiling AllocatorContext::getImgTiling() noexcept
+  {
+    // Without a granularity images can sit right next to buffers
+    if ( VulkanContext::the().getPhysicalDeviceLimits().bufferImageGranularity > 1 )
+    {
+      return ResourceTiling::Optimal;
+    }
+
+    return ResourceTiling::Linear;
+  }
+
+  [[nodiscard]] AllocatorContext::ThreadCache & AllocatorContext::getThreadCache() noexcept
+  {
+    static thread_local auto Cache = ThreadCache();
+
+    // The context was shutdown since this thread last used it, the cached ranges point to dead blocks
+    if ( auto const CurrentGeneration = Generation.load(); Cache.Generation != CurrentGeneration )
+    {
+      Cache.Bins.clear();
+      Cache.Generation = CurrentGeneration;
+    }
+
+    return Cache;
+  }
+
+  [[nodiscard]] AllocatorContext::CacheBin & AllocatorContext::getBin( uint64_t Key, uint32_t CacheClass ) noexcept
+  {
+    return getThreadCache().Bins[Key][CacheClass - MinCacheClass];
+  }
+
+  [[nodiscard]] std::optional<Allocation> AllocatorContext::allocate( AllocationType       Type,
+                                                                      VkDeviceSize         Size,
+                                                                      VkDeviceSize         Alignment,
+                                                                      MemoryTypeBits       BuffMemType,
+                                                                      Relocatable *        Owner,
+                                                                      std::source_location Loc ) noexcept
+  {
+    auto const Allocated = allocateCached( Type, Size, Alignment, BuffMemType, BufferClass::None, Owner );
+    return track( Allocated, Type, Size, Alignment, Loc );
+  }
+
+  [[nodiscard]] std::optional<Allocation> AllocatorContext::allocate( AllocationType       Type,
+                                                                      BufferClass          Class,
+                                                                      VkDeviceSize         Size,
+                                                                      VkDeviceSize         Alignment,
+                                                                      Relocatable *        Owner,
+                                                                      std::source_location Loc ) noexcept
+  {
+    MVK_VERIFY( Class != BufferClass::None );
+
+    auto const & Req       = BuffClassReqs[static_cast<size_t>( Class )];
+    auto const   Allocated = allocateCached( Type, Size, std::max( Alignment, Req.alignment ), Req.memoryTypeBits, Class, Owner );
+    return track( Allocated, Type, Size, Alignment, Loc );
+  }
+
+  [[nodiscard]] std::optional<Allocation> AllocatorContext::allocateCached( AllocationType Type,
+                                                                            VkDeviceSize   Size,
+                                                                            VkDeviceSize   Alignment,
+                                                                            MemoryTypeBits BuffMemType,
+                                                                            BufferClass    Class,
+                                                                            Relocatable *  Owner ) noexcept
+  {
+    // Owned allocations skip the thread caches, the owner has to be tracked under the lock
+    if ( Owner != nullptr )
+    {
+      return allocateUncached( Type, Size, Alignment, BuffMemType, ResourceTiling::Linear, Class, Owner );
+    }
+
+    auto const CacheClass = getCacheClass( Size, Alignment );
+
+    if ( CacheClass == 0 )
+    {
+      auto Lock = std::scoped_lock( Mtx );
+      return allocateLocked( Type, Size, Alignment, BuffMemType, ResourceTiling::Linear, Class );
+    }
+
+    auto & Bin = getBin( getBucketKey( Type, BuffMemType, ResourceTiling::Linear, Class ), CacheClass );
+
+    // Refill half the bin at once so the lock is taken once every few allocations
+    if ( Bin.Ranges.empty() )
+    {
+      auto const ClassSize = VkDeviceSize( 1 ) << CacheClass;
+      auto const RefillCnt = std::max( getMaxCachedCnt( CacheClass ) / 2, size_t( 1 ) );
+
+      auto Lock = std::scoped_lock( Mtx );
+
+      for ( auto i = size_t( 0 ); i < RefillCnt; ++i )
+      {
+        auto Refill = allocateLocked( Type, ClassSize, ClassSize, BuffMemType, ResourceTiling::Linear, Class );
+
+        // Whatever made it in is enough
+        if ( !Refill.has_value() )
+        {
+          break;
+        }
+
+        Refill->ID.CacheClass = CacheClass;
+        Bin.Ranges.push_back( Refill.value() );
+      }
+
+      if ( Bin.Ranges.empty() )
+      {
+        return std::nullopt;
+      }
+    }
+
+    auto const Cached = Bin.Ranges.back();
+    Bin.Ranges.pop_back();
+    Bin.LowWater = std::min( Bin.LowWater, std::size( Bin.Ranges ) );
+    return Cached;
+  }
+
+  [[nodiscard]] std::optional<Allocation>
+    AllocatorContext::allocate( AllocationType Type, VkBuffer Buff, Relocatable * Owner, std::source_location Loc ) noexcept
+  {
+    auto Dedicated  = VkMemoryDedicatedRequirements();
+    Dedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+    auto Req  = VkMemoryRequirements2();
+    Req.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    Req.pNext = &Dedicated;
+
+    auto ReqInfo   = VkBufferMemoryRequirementsInfo2();
+    ReqInfo.sType  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+    ReqInfo.buffer = Buff;
+
+    vkGetBufferMemoryRequirements2( VulkanContext::the().getDevice(), &ReqInfo, &Req );
+
+    auto const & MemReq = Req.memoryRequirements;
+
+    if ( wantsDedicated( Dedicated, MemReq ) )
+    {
+      auto Lock = std::scoped_lock( Mtx );
+      return track( allocateDedicated( Type, MemReq, Buff, VK_NULL_HANDLE ), Type, MemReq.size, MemReq.alignment, Loc );
+    }
+
+    return allocate( Type, MemReq.size, MemReq.alignment, MemReq.memoryTypeBits, Owner, Loc );
+  }
+
+  [[nodiscard]] std::optional<Allocation>
+    AllocatorContext::allocate( AllocationType Type, VkImage Img, Relocatable * Owner, std::source_location Loc ) noexcept
+  {
+    auto Dedicated  = VkMemoryDedicatedRequirements();
+    Dedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+    auto Req  = VkMemoryRequirements2();
+    Req.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    Req.pNext = &Dedicated;
+
+    auto ReqInfo  = VkImageMemoryRequirementsInfo2();
+    ReqInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+    ReqInfo.image = Img;
+
+    vkGetImageMemoryRequirements2( VulkanContext::the().getDevice(), &ReqInfo, &Req );
+
+    auto const & MemReq = Req.memoryRequirements;
+
+    if ( wantsDedicated( Dedicated, MemReq ) )
+    {
+      auto Lock = std::scoped_lock( Mtx );
+      return track( allocateDedicated( Type, MemReq, VK_NULL_HANDLE, Img ), Type, MemReq.size, MemReq.alignment, Loc );
+    }
+
+    // The thread caches only hold linear ranges
+    auto const Allocated =
+      allocateUncached( Type, MemReq.size, MemReq.alignment, MemReq.memoryTypeBits, getImgTiling(), BufferClass::None, Owner );
+    return track( Allocated, Type, MemReq.size, MemReq.alignment, Loc );
+  }
+
+  [[nodiscard]] std::optional<Allocation> AllocatorContext::allocateUncached( AllocationType Type,
+                                                                              VkDeviceSize   Size,
+                                                                              VkDeviceSize   Alignment,
+                                                                              MemoryTypeBits BuffMemType,
+                                                                              ResourceTiling Tiling,
+                                                                              BufferClass    Class,
+                                                                              Relocatable *  Owner ) noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+
+    auto const Allocated = allocateLocked( Type, Size, Alignment, BuffMemType, Tiling, Class );
+
+    if ( Allocated.has_value() && Owner != nullptr && Type == AllocationType::GpuOnly )
+    {
+      Blocks[Allocated->ID.BlockID]->addOwner( { Owner, Allocated->ID, Size, Alignment } );
+    }
+
+    return Allocated;
+  }
+
+  void AllocatorContext::free( AllocationID FreeID ) noexcept
+  {
+    untrack( FreeID );
+
+    if ( FreeID.CacheClass == 0 )
+    {
+      auto Lock = std::scoped_lock( Mtx );
+      freeLocked( FreeID );
+      return;
+    }
+
+    // The range is still allocated so the block can't be released under us, and its memory and mapping never change
+    auto const & Block = Blocks[FreeID.BlockID];
+    auto const   Data  = Block->getData() != nullptr ? Block->getData() + FreeID.Off : nullptr;
+
+    // Ranges freed on a different thread than the one that allocated them just end up in this thread's cache
+    auto & Bin = getBin( getBucketKey( *Block ), FreeID.CacheClass );
+    Bin.Ranges.push_back( { FreeID, Block->getMem(), FreeID.Off, Data, Block->getBuff() } );
+
+    // Too many cached, give half back
+    if ( auto const MaxCnt = getMaxCachedCnt( FreeID.CacheClass ); std::size( Bin.Ranges ) > MaxCnt )
+    {
+      auto Lock = std::scoped_lock( Mtx );
+
+      while ( std::size( Bin.Ranges ) > MaxCnt / 2 )
+      {
+        freeLocked( Bin.Ranges.back().ID );
+        Bin.Ranges.pop_back();
+      }
+
+      Bin.LowWater = std::min( Bin.LowWater, std::size( Bin.Ranges ) );
+    }
+  }
+
+  void AllocatorContext::disown( AllocationID ID ) noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+    Blocks[ID.BlockID]->removeOwner( ID.RangeID );
+  }
+
+  [[nodiscard]] std::optional<Allocation> AllocatorContext::allocateLocked( AllocationType Type,
+                                                                            VkDeviceSize   Size,
+                                                                            VkDeviceSize   Alignment,
+                                                                            MemoryTypeBits BuffMemType,
+                                                                            ResourceTiling Tiling,
+                                                                            BufferClass    Class ) noexcept
+  {
+    // Flushes and invalidates touch whole atoms, non coherent ranges can't share one
+    if ( Type != AllocationType::GpuOnly )
+    {
+      if ( auto const MemTypeIdx = queryMemType( Type, BuffMemType ); MemTypeIdx.has_value() )
+      {
+        auto const Atom = getAtomSize( MemTypeIdx.value() );
+        Alignment       = std::max( Alignment, Atom );
+        Size            = Mvk::Detail::alignedSize( Size, Atom );
+      }
+    }
+
+    auto & Target = Buckets[getBucketKey( Type, BuffMemType, Tiling, Class )];
+
+    if ( auto const Existing = allocateExisting( Target, Size, Alignment ); Existing.has_value() )
+    {
+      return Existing.value();
+    }
+
+    // No fit blocks where found, allocate a new block
+    auto const MinSize   = Tlsf::getMinSize( Size, Alignment );
+    auto const BlockSize = std::max( MinSize * 2, AllocatorBlock::MinSize );
+    auto const ID        = crtBlock( Target, Type, BlockSize, MinSize, BuffMemType, Tiling, Class );
+
+    if ( !ID.has_value() )
+    {
+      return std::nullopt;
+    }
+
+    auto &     Block = Blocks[ID.value()];
+    auto const Range = Block->allocate( Size, Alignment );
+    MVK_VERIFY( Range.has_value() );
+
+    return Detail::makeAllocation( ID.value(), *Block, Range.value() );
+  }
+
+  [[nodiscard]] std::optional<Allocation>
+    AllocatorContext::allocateDedicated( AllocationType Type, VkMemoryRequirements const & Req, VkBuffer Buff, VkImage Img ) noexcept
+  {
+    auto const MemTypeIdx = queryMemType( Type, Req.memoryTypeBits );
+
+    if ( !MemTypeIdx.has_value() || !hasHeapRoom( MemProps.memoryTypes[MemTypeIdx.value()].heapIndex, Req.size ) )
+    {
+      return std::nullopt;
+    }
+
+    auto const ID = acquireBlockID();
+
+    if ( !ID.has_value() )
+    {
+      return std::nullopt;
+    }
+
+    auto DedicatedInfo   = VkMemoryDedicatedAllocateInfo();
+    DedicatedInfo.sType  = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    DedicatedInfo.buffer = Buff;
+    DedicatedInfo.image  = Img;
+
+    auto const Tiling = Img != VK_NULL_HANDLE ? getImgTiling() : ResourceTiling::Linear;
+    auto &     Block  = Blocks[ID.value()];
+
+    Block = std::make_unique<AllocatorBlock>(
+      Req.size, Type, Req.memoryTypeBits, MemTypeIdx.value(), Tiling, BufferClass::None, &DedicatedInfo );
+
+    if ( Block->getMem() == VK_NULL_HANDLE )
+    {
+      Block.reset();
+      FreeBlockIDs.push_back( ID.value() );
+      return std::nullopt;
+    }
+
+    HeapReserved[MemProps.memoryTypes[MemTypeIdx.value()].heapIndex] += Req.size;
+
+    // Offset 0 satisfies any alignment
+    auto const Range = Block->allocate( Req.size, 1 );
+    MVK_VERIFY( Range.has_value() );
+
+    return Detail::makeAllocation( ID.value(), *Block, Range.value() );
+  }
+
+  [[nodiscard]] std::optional<Allocation>
+    AllocatorContext::allocateExisting( Bucket & Target, VkDeviceSize Size, VkDeviceSize Alignment ) noexcept
+  {
+    // Newer blocks are at the back and are the most likely to have space
+    for ( auto Idx = std::size( Target.Avail ); Idx != 0; --Idx )
+    {
+      auto const ID    = Target.Avail[Idx - 1];
+      auto &     Block = Blocks[ID];
+
+      // Blocks being emptied by the defragmenter don't take anything new
+      if ( Block->getIsEvacuating() )
+      {
+        continue;
+      }
+
+      // If the block doesn't have a free range big enough go next
+      auto const Range = Block->allocate( Size, Alignment );
+      if ( !Range.has_value() )
+      {
+        continue;
+      }
+
+      // If the block was marked as "Tombstone" it's alive again
+      Block->setIsTombstone( false );
+
+      // Full blocks leave the list until something is freed
+      if ( Block->getUsed() == Block->getSize() )
+      {
+        Target.Avail[Idx - 1] = Target.Avail.back();
+        Target.Avail.pop_back();
+      }
+
+      return Detail::makeAllocation( ID, *Block, Range.value() );
+    }
+
+    return std::nullopt;
+  }
+
+  void AllocatorContext::freeLocked( AllocationID FreeID ) noexcept
+  {
+    // Blocks that became empty on the previous frees and weren't reused get released now
+    reclaimTombstones();
+
+    auto & Block = Blocks[FreeID.BlockID];
+
+    MVK_VERIFY( Block );
+    MVK_VERIFY( Block->getOwnerCnt() != 0 );
+
+    // Nothing else can go in a dedicated block
+    if ( Block->getIsDedicated() )
+    {
+      releaseBlock( FreeID.BlockID );
+      return;
+    }
+
+    auto const WasFull = Block->getUsed() == Block->getSize();
+
+    Block->free( FreeID.RangeID );
+
+    if ( WasFull )
+    {
+      Buckets[getBucketKey( *Block )].Avail.push_back( FreeID.BlockID );
+    }
+
+    if ( Block->getOwnerCnt() == 0 )
+    {
+      Block->setIsTombstone( true );
+      Tombstones.push_back( FreeID.BlockID );
+    }
+  }
+
+  [[nodiscard]] std::optional<size_t> AllocatorContext::crtBlock( Bucket &       Target,
+                                                                 AllocationType Type,
+                                                                 VkDeviceSize   Size,
+                                                                 VkDeviceSize   MinSize,
+                                                                 MemoryTypeBits BuffMemType,
+                                                                 ResourceTiling Tiling,
+                                                                 BufferClass    Class ) noexcept
+  {
+    auto const MemTypeIdx = queryMemType( Type, BuffMemType );
+
+    if ( !MemTypeIdx.has_value() )
+    {
+      return std::nullopt;
+    }
+
+    // The idle block kept by reclaimTombstones didn't fit, it's no longer the last one so let it go
+    for ( auto const AvailID : Target.Avail )
+    {
+      if ( Blocks[AvailID]->getIsTombstone() )
+      {
+        Tombstones.push_back( AvailID );
+      }
+    }
+
+    auto const HeapIdx = MemProps.memoryTypes[MemTypeIdx.value()].heapIndex;
+
+    // The buffer of the block has to cover all of its memory
+    auto const BuffAlignment = BuffClassReqs[static_cast<size_t>( Class )].alignment;
+
+    // Rather a block that only fits the allocation than nothing
+    for ( auto const UnalignedSize : { Size, MinSize } )
+    {
+      auto const TrySize = ( UnalignedSize + BuffAlignment - 1 ) / BuffAlignment * BuffAlignment;
+
+      if ( !hasHeapRoom( HeapIdx, TrySize ) )
+      {
+        continue;
+      }
+
+      auto Block = std::make_unique<AllocatorBlock>( TrySize, Type, BuffMemType, MemTypeIdx.value(), Tiling, Class );
+
+      // The budget is only an estimate, the driver can still run out
+      if ( Block->getMem() == VK_NULL_HANDLE )
+      {
+        continue;
+      }
+
+      auto const ID = acquireBlockID();
+
+      if ( !ID.has_value() )
+      {
+        return std::nullopt;
+      }
+
+      Blocks[ID.value()] = std::move( Block );
+      Target.Avail.push_back( ID.value() );
+      ++Target.BlockCnt;
+      HeapReserved[HeapIdx] += TrySize;
+      return ID;
+    }
+
+    return std::nullopt;
+  }
+
+  [[nodiscard]] std::optional<size_t> AllocatorContext::acquireBlockID() noexcept
+  {
+    if ( !FreeBlockIDs.empty() )
+    {
+      auto const ID = FreeBlockIDs.back();
+      FreeBlockIDs.pop_back();
+      return ID;
+    }
+
+    if ( BlockCnt == MaxBlockCnt )
+    {
+      return std::nullopt;
+    }
+
+    return BlockCnt++;
+  }
+
+  [[nodiscard]] std::optional<uint32_t> AllocatorContext::queryMemType( AllocationType Type, MemoryTypeBits BuffMemType ) const noexcept
+  {
+    auto const ReqFlags       = Detail::getMemProperties( Type );
+    auto const PreferredFlags = ReqFlags | Detail::getPreferredMemProperties( Type );
+
+    for ( auto const PropFlags : { PreferredFlags, ReqFlags } )
+    {
+      for ( auto i = uint32_t( 0 ); i < MemProps.memoryTypeCount; ++i )
+      {
+        auto const CurrentFlags  = MemProps.memoryTypes[i].propertyFlags;
+        auto const MatchesFlags  = ( CurrentFlags & PropFlags ) == PropFlags;
+        auto const MatchesFilter = ( BuffMemType & ( 1U << i ) ) != 0U;
+
+        // Without resizable BAR the mappable device local type sits in a small heap of its own, not worth spending on
+        // resources that can be staged
+        auto const MatchesHeap = Type != AllocationType::GpuMapped || MemProps.memoryTypes[i].heapIndex == VramHeapIdx;
+
+        if ( MatchesFlags && MatchesFilter && MatchesHeap )
+        {
+          return i;
+        }
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  [[nodiscard]] bool AllocatorContext::getIsCoherent( uint32_t MemTypeIdx ) const noexcept
+  {
+    auto const Flags = MemProps.memoryTypes[MemTypeIdx].propertyFlags;
+    return ( Flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ) == 0U || ( Flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT ) != 0U;
+  }
+
+  [[nodiscard]] VkDeviceSize AllocatorContext::getAtomSize( uint32_t MemTypeIdx ) const noexcept
+  {
+    if ( getIsCoherent( MemTypeIdx ) )
     {
-      if ( auto Mod = Size % Alignment; Mod != 0 )
-      {
-        return Size + Alignment - Mod;
-      }
+      return 1;
+    }
+
+    return std::max( VulkanContext::the().getPhysicalDeviceLimits().nonCoherentAtomSize, VkDeviceSize( 1 ) );
+  }
+
+  void AllocatorContext::flush( AllocationID ID, VkDeviceSize Off, VkDeviceSize Size ) noexcept
+  {
+    queueMappedRange( PendingFlushes, ID, Off, Size );
+  }
+
+  void AllocatorContext::invalidate( AllocationID ID, VkDeviceSize Off, VkDeviceSize Size ) noexcept
+  {
+    queueMappedRange( PendingInvalidates, ID, Off, Size );
+  }
 
-      return Size;
+  void AllocatorContext::queueMappedRange( std::vector<VkMappedMemoryRange> & Queue,
+                                           AllocationID                       ID,
+                                           VkDeviceSize                       Off,
+                                           VkDeviceSize                       Size ) noexcept
+  {
+    // The block can't go away while one of its ranges is allocated, so no need for Mtx
+    auto const & Block = *Blocks[ID.BlockID];
+
+    if ( getIsCoherent( Block.getMemTypeIdx() ) )
+    {
+      return;
     }
 
-  }  // namespace Detail
+    auto const Atom = getAtomSize( Block.getMemTypeIdx() );
+
+    // Ranges have to start on an atom and end on one or at the end of the memory
+    auto const Start = ( ID.Off + Off ) / Atom * Atom;
+    auto const End   = std::min( Mvk::Detail::alignedSize( ID.Off + Off + Size, Atom ), Block.getSize() );
+
+    auto Range   = VkMappedMemoryRange();
+    Range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    Range.memory = Block.getMem();
+    Range.offset = Start;
+    Range.size   = End - Start;
+
+    auto Lock = std::scoped_lock( MappedMtx );
+    Queue.push_back( Range );
+  }
+
+  void AllocatorContext::flushMappedRanges() noexcept
+  {
+    auto Lock = std::scoped_lock( MappedMtx );
+
+    if ( PendingFlushes.empty() )
+    {
+      return;
+    }
+
+    Detail::coalesceMappedRanges( PendingFlushes );
+
+    auto const Result = vkFlushMappedMemoryRanges(
+      VulkanContext::the().getDevice(), static_cast<uint32_t>( std::size( PendingFlushes ) ), std::data( PendingFlushes ) );
+    MVK_VERIFY( Result == VK_SUCCESS );
+
+    PendingFlushes.clear();
+  }
+
+  void AllocatorContext::invalidateMappedRanges() noexcept
+  {
+    auto Lock = std::scoped_lock( MappedMtx );
+
+    if ( PendingInvalidates.empty() )
+    {
+      return;
+    }
+
+    Detail::coalesceMappedRanges( PendingInvalidates );
+
+    auto const Result = vkInvalidateMappedMemoryRanges( VulkanContext::the().getDevice(),
+                                                        static_cast<uint32_t>( std::size( PendingInvalidates ) ),
+                                                        std::data( PendingInvalidates ) );
+    MVK_VERIFY( Result == VK_SUCCESS );
+
+    PendingInvalidates.clear();
+  }
+
+  [[nodiscard]] VkPhysicalDeviceMemoryBudgetPropertiesEXT AllocatorContext::queryBudget() const noexcept
+  {
+    auto Budget  = VkPhysicalDeviceMemoryBudgetPropertiesEXT();
+    Budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    if ( VulkanContext::the().getHasMemoryBudget() )
+    {
+      auto Props  = VkPhysicalDeviceMemoryProperties2();
+      Props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+      Props.pNext = &Budget;
+
+      vkGetPhysicalDeviceMemoryProperties2( VulkanContext::the().getPhysicalDevice(), &Props );
+      return Budget;
+    }
 
-  void AllocatorContext::initialize( Utility::Badge<VulkanContext> ) noexcept {}
+    for ( auto i = uint32_t( 0 ); i < MemProps.memoryHeapCount; ++i )
+    {
+      Budget.heapBudget[i] = MemProps.memoryHeaps[i].size * HeapBudgetPercent / 100;
+      Budget.heapUsage[i]  = HeapReserved[i];
+    }
+
+    return Budget;
+  }
 
-  [[nodiscard]] Allocation
-    AllocatorContext::allocate( AllocationType Type, VkDeviceSize Size, VkDeviceSize Alignment, MemoryTypeBits BuffMemType ) noexcept
+  [[nodiscard]] VkDeviceSize AllocatorContext::getHeapAvail( uint32_t HeapIdx ) const noexcept
   {
-    auto const AlignedSize = Detail::alignedSize( Size, Alignment );
+    auto const Budget = queryBudget();
+    auto const Usage  = Budget.heapUsage[HeapIdx];
+    return Budget.heapBudget[HeapIdx] > Usage ? Budget.heapBudget[HeapIdx] - Usage : 0;
+  }
+
+  [[nodiscard]] bool AllocatorContext::hasHeapRoom( uint32_t HeapIdx, VkDeviceSize Size ) noexcept
+  {
+    if ( getHeapAvail( HeapIdx ) >= Size )
+    {
+      return true;
+    }
+
+    evictIdleBlocks( HeapIdx );
+    return getHeapAvail( HeapIdx ) >= Size;
+  }
 
-    for ( auto ID = AllocationID( 0 ); ID != std::size( Blocks ); ++ID )
+  void AllocatorContext::reclaimTombstones() noexcept
+  {
+    // Every block is pushed once per time it becomes empty, so this is amortized constant
+    for ( auto const ID : Tombstones )
     {
       auto & Block = Blocks[ID];
 
-      // Deleted block slots will be used on the next step if no fit blocks are found
-      if ( Block == nullptr )
+      // Already released or reused since it was marked
+      if ( Block == nullptr || !Block->getIsTombstone() )
       {
         continue;
       }
 
-      // If the memory type and allocation type don't match, go next
-      if ( Block->getMemType() != BuffMemType || Block->getAllocType() != Type )
+      auto & Target = Buckets[getBucketKey( *Block )];
+
+      // Keep the last block of the bucket around so alloc/free cycles don't hit vkAllocateMemory every time
+      if ( Target.BlockCnt == 1 && !Block->getIsEvacuating() )
       {
         continue;
       }
 
-      auto const BlockSize = Block->getSize();
-      // If the allocation doesn't fit in the block size go next
-      if ( BlockSize < AlignedSize )
+      releaseBlock( ID );
+    }
+
+    Tombstones.clear();
+  }
+
+  void AllocatorContext::evictIdleBlocks( uint32_t HeapIdx ) noexcept
+  {
+    for ( auto ID = size_t( 0 ); ID != BlockCnt; ++ID )
+    {
+      auto const & Block = Blocks[ID];
+
+      if ( Block != nullptr && Block->getIsTombstone() && MemProps.memoryTypes[Block->getMemTypeIdx()].heapIndex == HeapIdx )
+      {
+        releaseBlock( ID );
+      }
+    }
+  }
+
+  void AllocatorContext::releaseBlock( size_t ID ) noexcept
+  {
+    auto & Block = Blocks[ID];
+
+    // Dedicated blocks are never part of a bucket
+    if ( !Block->getIsDedicated() )
+    {
+      auto & Target = Buckets[getBucketKey( *Block )];
+
+      // Empty blocks are never full so they're always on the list
+      auto const It = std::find( std::begin( Target.Avail ), std::end( Target.Avail ), ID );
+      MVK_VERIFY( It != std::end( Target.Avail ) );
+
+      *It = Target.Avail.back();
+      Target.Avail.pop_back();
+      --Target.BlockCnt;
+    }
+
+    HeapReserved[MemProps.memoryTypes[Block->getMemTypeIdx()].heapIndex] -= Block->getSize();
+
+    // Whatever is still queued for the memory would touch it after it's freed
+    if ( !getIsCoherent( Block->getMemTypeIdx() ) )
+    {
+      auto const isReleased = [Mem = Block->getMem()]( auto const & Range ) { return Range.memory == Mem; };
+
+      auto MappedLock = std::scoped_lock( MappedMtx );
+      std::erase_if( PendingFlushes, isReleased );
+      std::erase_if( PendingInvalidates, isReleased );
+    }
+
+    Block.reset();
+    FreeBlockIDs.push_back( ID );
+    ++ReleasedBlockCnt;
+  }
+
+  [[nodiscard]] AllocatorStats AllocatorContext::getStats() noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+
+    auto Stats    = AllocatorStats();
+    Stats.HeapCnt = MemProps.memoryHeapCount;
+    Stats.TypeCnt = MemProps.memoryTypeCount;
+
+    auto TypeFree    = std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES>();
+    auto TypeLargest = std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES>();
+    auto HeapFree    = std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS>();
+    auto HeapLargest = std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS>();
+
+    for ( auto ID = size_t( 0 ); ID != BlockCnt; ++ID )
+    {
+      auto const & Block = Blocks[ID];
+
+      if ( Block == nullptr )
       {
         continue;
       }
 
-      // If the block is marked as "Tombstone", and the allocation fits use this block
-      if ( Block->getIsTombstone() )
+      auto const TypeIdx = Block->getMemTypeIdx();
+      auto const HeapIdx = MemProps.memoryTypes[TypeIdx].heapIndex;
+      auto const Free    = Block->getSize() - Block->getUsed();
+      auto const Largest = Block->getLargestFree();
+
+      for ( auto * const Mem : { &Stats.Types[TypeIdx], &Stats.Heaps[HeapIdx].Mem } )
+      {
+        Mem->ReservedBytes += Block->getSize();
+        Mem->UsedBytes += Block->getUsed();
+        Mem->BlockCnt += 1;
+        Mem->AllocationCnt += Block->getOwnerCnt();
+      }
+
+      TypeFree[TypeIdx] += Free;
+      HeapFree[HeapIdx] += Free;
+      TypeLargest[TypeIdx] = std::max( TypeLargest[TypeIdx], Largest );
+      HeapLargest[HeapIdx] = std::max( HeapLargest[HeapIdx], Largest );
+    }
+
+    for ( auto i = uint32_t( 0 ); i < Stats.TypeCnt; ++i )
+    {
+      Stats.Types[i].Fragmentation = Detail::getFragmentation( TypeFree[i], TypeLargest[i] );
+    }
+
+    auto const Budget = queryBudget();
+
+    for ( auto i = uint32_t( 0 ); i < Stats.HeapCnt; ++i )
+    {
+      Stats.Heaps[i].Mem.Fragmentation = Detail::getFragmentation( HeapFree[i], HeapLargest[i] );
+      Stats.Heaps[i].DriverUsage       = Budget.heapUsage[i];
+      Stats.Heaps[i].DriverBudget      = Budget.heapBudget[i];
+    }
+
+    return Stats;
+  }
+
+  [[nodiscard]] DefragStats AllocatorContext::defragment( VkCommandBuffer CmdBuff, VkDeviceSize ByteBudget ) noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+
+    auto Stats       = DefragStats{ 0, 0, ReleasedBlockCnt, {} };
+    ReleasedBlockCnt = 0;
+
+    auto IsOutOfBudget = false;
+
+    while ( !IsOutOfBudget )
+    {
+      auto const SrcID = pickDefragSrc();
+
+      if ( !SrcID.has_value() )
       {
-        Block->setOff( AlignedSize );
-        Block->setIsTombstone( false );
-        Block->setOwnerCnt( 1 );
-        return { ID, Block->getMem(), 0, Block->getData() };
+        break;
       }
 
-      // If the allocation doesn't fit in the remaining space go next
-      auto const BlockAlignedOff = Detail::alignedSize( Block->getOff(), Alignment );
-      if ( BlockSize - BlockAlignedOff < AlignedSize )
+      auto & Src = *Blocks[SrcID.value()];
+      Src.setIsEvacuating( true );
+
+      auto & Target = Buckets[getBucketKey( Src )];
+
+      // Owners are removed from the block as they are moved
+      auto const Owners = std::vector<std::pair<Tlsf::RangeID const, RangeOwner>>( std::begin( Src.getOwners() ),
+                                                                                   std::end( Src.getOwners() ) );
+
+      auto MovedFromSrc = size_t( 0 );
+
+      for ( auto const & [RangeID, Owner] : Owners )
       {
-        continue;
+        if ( Stats.BytesMoved + Owner.Size > ByteBudget )
+        {
+          IsOutOfBudget = true;
+          break;
+        }
+
+        // Only move into blocks that already exist, growing memory to defragment it would be silly
+        auto const NewAlloc = allocateExisting( Target, Owner.Size, Owner.Alignment );
+
+        if ( !NewAlloc.has_value() )
+        {
+          break;
+        }
+
+        // Whatever touched the old ranges in previous frames has to be done before they're copied
+        if ( Stats.AllocationsMoved == 0 )
+        {
+          auto Barrier          = VkMemoryBarrier();
+          Barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+          Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+          Barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+          vkCmdPipelineBarrier(
+            CmdBuff, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &Barrier, 0, nullptr, 0, nullptr );
+        }
+
+        Owner.Owner->relocate( CmdBuff, NewAlloc.value() );
+
+        Blocks[NewAlloc->ID.BlockID]->addOwner( { Owner.Owner, NewAlloc->ID, Owner.Size, Owner.Alignment } );
+        Src.removeOwner( RangeID );
+
+        // The copy still reads the old range, it can only be freed once the GPU is done with this frame
+        retrack( Owner.ID, NewAlloc->ID );
+        VulkanContext::the().addGarbage( Owner.ID );
+
+        Stats.BytesMoved += Owner.Size;
+        ++Stats.AllocationsMoved;
+        Stats.Relocated.push_back( Owner.Owner );
+        ++MovedFromSrc;
+      }
+
+      // Nothing else fits anywhere, give up on the block for now
+      if ( MovedFromSrc == 0 )
+      {
+        Src.setIsEvacuating( false );
+        break;
+      }
+
+      if ( !Src.getOwners().empty() )
+      {
+        break;
       }
+    }
+
+    // Make the moved data visible to the draws
+    if ( Stats.AllocationsMoved != 0 )
+    {
+      auto Barrier          = VkMemoryBarrier();
+      Barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+      Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      Barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
 
-      Block->setOff( BlockAlignedOff + AlignedSize );
-      auto const OwnrCnt = Block->getOwnerCnt();
-      Block->setOwnerCnt( OwnrCnt + 1 );
-      return { ID, Block->getMem(), BlockAlignedOff, Block->getData() + BlockAlignedOff };
+      vkCmdPipelineBarrier( CmdBuff,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                            0,
+                            1,
+                            &Barrier,
+                            0,
+                            nullptr,
+                            0,
+                            nullptr );
     }
 
-    // No fit blocks where found, find any empty slots to allcate a new block
-    for ( auto ID = AllocationID( 0 ); ID != std::size( Blocks ); ++ID )
+    return Stats;
+  }
+
+  [[nodiscard]] std::optional<size_t> AllocatorContext::pickDefragSrc() const noexcept
+  {
+    auto Picked     = std::optional<size_t>();
+    auto PickedUsed = VkDeviceSize( 0 );
+
+    for ( auto ID = size_t( 0 ); ID != BlockCnt; ++ID )
     {
-      if ( auto & Block = Blocks[ID]; Block == nullptr )
+      auto const & Block = Blocks[ID];
+
+      if ( Block == nullptr || Block->getIsDedicated() || Block->getAllocType() != AllocationType::GpuOnly || Block->getOwners().empty() )
+      {
+        continue;
+      }
+
+      // Finish what was started on a previous pass first
+      if ( Block->getIsEvacuating() )
+      {
+        return ID;
+      }
+
+      // Anything without an owner can't be moved so the block could never be released
+      if ( std::size( Block->getOwners() ) != Block->getOwnerCnt() )
+      {
+        continue;
+      }
+
+      auto const Used = Block->getUsed();
+
+      if ( Used * 100 >= Block->getSize() * DefragMaxUsagePercent )
       {
-        auto const BlockSize = std::max( Size * 2, AllocatorBlock::MinSize );
+        continue;
+      }
 
-        Block = std::make_unique<AllocatorBlock>( BlockSize, Type, BuffMemType );
+      if ( auto const & Target = Buckets.at( getBucketKey( *Block ) ); Target.BlockCnt < 2 )
+      {
+        continue;
+      }
 
-        Block->setOff( AlignedSize );
-        Block->setOwnerCnt( 1 );
-        return { ID, Block->getMem(), 0, Block->getData() };
+      // The emptier the block the cheaper it is to release
+      if ( !Picked.has_value() || Used < PickedUsed )
+      {
+        Picked     = ID;
+        PickedUsed = Used;
       }
     }
 
-    // No fit blocks found, not empty slots
-    auto const BlockSize = std::max( Size * 2, AllocatorBlock::MinSize );
+    return Picked;
+  }
+
+  void AllocatorContext::setIsTracking( bool State ) noexcept
+  {
+    auto Lock  = std::scoped_lock( TrackingMtx );
+    IsTracking = State;
 
-    Blocks.push_back( std::make_unique<AllocatorBlock>( BlockSize, Type, BuffMemType ) );
-    auto & Block = Blocks.back();
-    Block->setOff( AlignedSize );
-    Block->setOwnerCnt( 1 );
-    return { std::size( Blocks ) - 1, Block->getMem(), 0, Block->getData() };
+    if ( !State )
+    {
+      Records.clear();
+    }
   }
 
-  void AllocatorContext::free( AllocationID FreeID ) noexcept
+  void AllocatorContext::nextFrame() noexcept
   {
-    // Do the cleanup
-    for ( auto ID = AllocationID( 0 ); ID != std::size( Blocks ); ++ID )
+    ++Frame;
+
+    auto & Cache = getThreadCache();
+    auto   Lock  = std::unique_lock( Mtx, std::defer_lock );
+
+    // Ranges that weren't needed for a whole frame likely won't be, the bins refill on demand anyway
+    for ( auto & [Key, KeyBins] : Cache.Bins )
     {
-      // If the block was marked tombstone the last free, and it wasn't used free the block
-      if ( auto & Block = Blocks[ID]; Block != nullptr )
+      for ( auto & Bin : KeyBins )
       {
-        if ( Block->getIsTombstone() )
+        if ( Bin.LowWater != 0 && !Lock.owns_lock() )
+        {
+          Lock.lock();
+        }
+
+        for ( auto Idx = size_t( 0 ); Idx < Bin.LowWater; ++Idx )
         {
-          Block.reset();
+          freeLocked( Bin.Ranges.back().ID );
+          Bin.Ranges.pop_back();
         }
+
+        Bin.LowWater = std::size( Bin.Ranges );
       }
     }
+  }
 
-    auto & Block = Blocks[FreeID];
+  [[nodiscard]] std::optional<Allocation> AllocatorContext::track( std::optional<Allocation> const & Allocated,
+                                                                   AllocationType                    Type,
+                                                                   VkDeviceSize                      Size,
+                                                                   VkDeviceSize                      Alignment,
+                                                                   std::source_location const &      Loc ) noexcept
+  {
+    if ( !IsTracking || !Allocated.has_value() )
+    {
+      return Allocated;
+    }
 
-    MVK_VERIFY( Block );
+    // The range is allocated, so the block can be read without the lock
+    auto const MemTypeIdx = Blocks[Allocated->ID.BlockID]->getMemTypeIdx();
 
-    auto const OwnerCnt = Block->getOwnerCnt();
+    auto Lock                              = std::scoped_lock( TrackingMtx );
+    Records[getRecordKey( Allocated->ID )] = { Type, Size, Alignment, MemTypeIdx, Frame, Loc };
 
-    MVK_VERIFY( OwnerCnt != 0 );
+    return Allocated;
+  }
 
-    if ( OwnerCnt == 1 )
+  void AllocatorContext::untrack( AllocationID ID ) noexcept
+  {
+    if ( !IsTracking )
     {
-      Block->setIsTombstone( true );
+      return;
+    }
+
+    auto Lock = std::scoped_lock( TrackingMtx );
+    Records.erase( getRecordKey( ID ) );
+  }
+
+  void AllocatorContext::retrack( AllocationID From, AllocationID To ) noexcept
+  {
+    if ( !IsTracking )
+    {
+      return;
+    }
+
+    auto Lock = std::scoped_lock( TrackingMtx );
+
+    if ( auto Found = Records.extract( getRecordKey( From ) ); !Found.empty() )
+    {
+      Found.key() = getRecordKey( To );
+      Records.insert( std::move( Found ) );
+    }
+  }
+
+  void AllocatorContext::reportLeaks() noexcept
+  {
+    auto Lock = std::scoped_lock( TrackingMtx );
+
+    if ( Records.empty() )
+    {
+      return;
+    }
+
+    auto LeakedBytes = VkDeviceSize( 0 );
+
+    for ( auto const & [Key, Record] : Records )
+    {
+      LeakedBytes += Record.Size;
+    }
+
+    std::cerr << std::size( Records ) << " allocations (" << LeakedBytes << " bytes) still alive at shutdown\n";
+
+    for ( auto const & [Key, Record] : Records )
+    {
+      std::cerr << "  " << Record.Size << " bytes, alignment " << Record.Alignment << ", " << Detail::getTypeName( Record.Type )
+                << ", memory type " << Record.MemTypeIdx << ", frame " << Record.Frame << ", " << Record.Loc.file_name() << ':'
+                << Record.Loc.line() << ' ' << Record.Loc.function_name() << '\n';
+    }
+
+    Records.clear();
+  }
+
+  [[nodiscard]] bool AllocatorContext::dumpJson( std::filesystem::path const & Path ) noexcept
+  {
+    auto File = std::ofstream( Path );
+
+    if ( !File.is_open() )
+    {
+      return false;
+    }
+
+    auto Lock = std::scoped_lock( Mtx, TrackingMtx );
+
+    File << "{\n  \"frame\": " << Frame << ",\n  \"tracking\": " << ( IsTracking ? "true" : "false" ) << ",\n  \"heaps\": [";
+
+    for ( auto i = uint32_t( 0 ); i < MemProps.memoryHeapCount; ++i )
+    {
+      File << ( i != 0 ? ", " : "" ) << "{ \"size\": " << MemProps.memoryHeaps[i].size << ", \"reserved\": " << HeapReserved[i]
+           << " }";
+    }
+
+    File << "],\n  \"types\": [";
+
+    for ( auto i = uint32_t( 0 ); i < MemProps.memoryTypeCount; ++i )
+    {
+      File << ( i != 0 ? ", " : "" ) << "{ \"heap\": " << MemProps.memoryTypes[i].heapIndex
+           << ", \"flags\": " << MemProps.memoryTypes[i].propertyFlags << " }";
+    }
+
+    File << "],\n  \"blocks\": [";
+
+    auto IsFirstBlock = true;
+
+    for ( auto ID = size_t( 0 ); ID != BlockCnt; ++ID )
+    {
+      auto const & Block = Blocks[ID];
+
+      if ( Block == nullptr )
+      {
+        continue;
+      }
+
+      File << ( IsFirstBlock ? "\n" : ",\n" ) << "    { \"id\": " << ID << ", \"type\": \"" << Detail::getTypeName( Block->getAllocType() )
+           << "\", \"memoryType\": " << Block->getMemTypeIdx() << ", \"tiling\": \""
+           << ( Block->getTiling() == ResourceTiling::Linear ? "Linear" : "Optimal" ) << "\", \"dedicated\": "
+           << ( Block->getIsDedicated() ? "true" : "false" ) << ", \"tombstone\": " << ( Block->getIsTombstone() ? "true" : "false" )
+           << ", \"size\": " << Block->getSize() << ", \"used\": " << Block->getUsed() << ",\n      \"ranges\": [";
+
+      IsFirstBlock = false;
+
+      auto IsFirstRange = true;
+
+      Block->getRanges().forEachRange(
+        [&]( VkDeviceSize Off, VkDeviceSize Size, Tlsf::RangeID RangeID, bool IsFree )
+        {
+          File << ( IsFirstRange ? "\n" : ",\n" ) << "        { \"offset\": " << Off << ", \"size\": " << Size
+               << ", \"free\": " << ( IsFree ? "true" : "false" );
+
+          IsFirstRange = false;
+
+          auto const Found = Records.find( getRecordKey( { ID, RangeID, Off, 0 } ) );
+
+          if ( !IsFree && Found != std::end( Records ) )
+          {
+            auto const & Record = Found->second;
+
+            File << ", \"alignment\": " << Record.Alignment << ", \"frame\": " << Record.Frame << ", \"file\": ";
+            Detail::writeJsonString( File, Record.Loc.file_name() );
+            File << ", \"line\": " << Record.Loc.line() << ", \"function\": ";
+            Detail::writeJsonString( File, Record.Loc.function_name() );
+          }
+
+          File << " }";
+        } );
+
+      File << "\n      ] }";
     }
 
-    Block->setOwnerCnt( OwnerCnt - 1 );
+    File << "\n  ]\n}\n";
+
+    return static_cast<bool>( File );
   }
 
   void AllocatorContext::shutdown() noexcept
   {
-    Blocks.clear();
+    reportLeaks();
+
+    auto Lock = std::scoped_lock( Mtx );
+
+    // Invalidates every thread cache
+    ++Generation;
+
+    Tombstones.clear();
+    FreeBlockIDs.clear();
+    Buckets.clear();
+
+    for ( auto & Block : Blocks )
+    {
+      Block.reset();
+    }
+
+    BlockCnt         = 0;
+    ReleasedBlockCnt = 0;
+    HeapReserved.fill( 0 );
   }
 
 }  // namespace Mvk::Engine
\ No newline at end of file
@@ -1,27 +1,84 @@
 #pragma once
 
 #include "Engine/AllocatorBlock.hpp"
+#include "Engine/Relocatable.hpp"
 #include "Engine/VulkanContext.hpp"
 #include "Utility/Badge.hpp"
 #include "Utility/Macros.hpp"
 #include "Utility/Singleton.hpp"
 
+#include <array>
+#include <atomic>
+#include <filesystem>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <source_location>
+#include <unordered_map>
 #include <vector>
 
 namespace Mvk::Engine
 {
-  using AllocationID = size_t;
-
   struct Allocation
   {
     AllocationID   ID;
     VkDeviceMemory Mem;
     VkDeviceSize   Off;
     std::byte *    Data;
+    // Only for buffer class allocations, Off is also the offset into it
+    VkBuffer       Buff;
+  };
+
+  struct MemoryStats
+  {
+    VkDeviceSize ReservedBytes;
+    VkDeviceSize UsedBytes;
+    // 1 - largest free range / free bytes, 0 means all the free space is a single range
+    float        Fragmentation;
+    size_t       BlockCnt;
+    size_t       AllocationCnt;
+  };
+
+  struct HeapStats
+  {
+    MemoryStats  Mem;
+    // What the driver reports for the whole process with VK_EXT_memory_budget, estimated from the heap size otherwise
+    VkDeviceSize DriverUsage;
+    VkDeviceSize DriverBudget;
+  };
+
+  // Ranges sitting in the thread caches count as used
+  struct AllocatorStats
+  {
+    uint32_t                                     HeapCnt;
+    uint32_t                                     TypeCnt;
+    std::array<HeapStats, VK_MAX_MEMORY_HEAPS>   Heaps;
+    std::array<MemoryStats, VK_MAX_MEMORY_TYPES> Types;
+  };
+
+  struct DefragStats
+  {
+    VkDeviceSize                     BytesMoved;
+    size_t                           AllocationsMoved;
+    // Blocks given back to the driver since the last pass
+    size_t                           BlocksReleased;
+    // Everything relocate was called on, in the order they moved
+    std::vector<Relocatable const *> Relocated;
+  };
+
+  // Only kept while tracking is on, Loc is wherever allocate was called from
+  struct AllocationRecord
+  {
+    AllocationType       Type;
+    VkDeviceSize         Size;
+    VkDeviceSize         Alignment;
+    uint32_t             MemTypeIdx;
+    uint64_t             Frame;
+    std::source_location Loc;
   };
 
   // TODO(samuel): make part of Context
+  // Safe to use from any thread, small allocations are served from a per thread cache without taking the lock
   class AllocatorContext : public Utility::Singleton<AllocatorContext>
   {
   public:
@@ -29,15 +86,257 @@ namespace Mvk::Engine
 
     void initialize( Utility::Badge<VulkanContext> ) noexcept;
 
-    [[nodiscard]] Allocation
-      allocate( AllocationType Type, VkDeviceSize Size, VkDeviceSize Alignment, MemoryTypeBits BuffMemType ) noexcept;
+    // GpuOnly allocations with an owner can be moved around by defragment. Returns nothing instead of going over the memory
+    // budget or when the driver is out of memory
+    [[nodiscard]] std::optional<Allocation> allocate( AllocationType       Type,
+                                                      VkDeviceSize         Size,
+                                                      VkDeviceSize         Alignment,
+                                                      MemoryTypeBits       BuffMemType,
+                                                      Relocatable *        Owner = nullptr,
+                                                      std::source_location Loc   = std::source_location::current() ) noexcept;
+
+    // Query the requirements of the resource, big resources or the ones the driver prefers get their own VkDeviceMemory.
+    // Images are expected to use optimal tiling
+    [[nodiscard]] std::optional<Allocation> allocate( AllocationType       Type,
+                                                      VkBuffer             Buff,
+                                                      Relocatable *        Owner = nullptr,
+                                                      std::source_location Loc   = std::source_location::current() ) noexcept;
+    [[nodiscard]] std::optional<Allocation> allocate( AllocationType       Type,
+                                                      VkImage              Img,
+                                                      Relocatable *        Owner = nullptr,
+                                                      std::source_location Loc   = std::source_location::current() ) noexcept;
+
+    // A view into the buffer of a block of that class, creating the object using it doesn't need to touch Vulkan
+    [[nodiscard]] std::optional<Allocation> allocate( AllocationType       Type,
+                                                      BufferClass          Class,
+                                                      VkDeviceSize         Size,
+                                                      VkDeviceSize         Alignment,
+                                                      Relocatable *        Owner = nullptr,
+                                                      std::source_location Loc   = std::source_location::current() ) noexcept;
 
     void free( AllocationID ID ) noexcept;
 
+    // Defragment leaves the allocation where it is from then on, for owners that switched to another one and free this one
+    // through the garbage queue
+    void disown( AllocationID ID ) noexcept;
+
+    // Only do something for non coherent memory, Off is relative to the allocation. The ranges are queued and handled all
+    // at once by flushMappedRanges and invalidateMappedRanges, a range can be queued before writing to it as long as the
+    // writes are done by the time it's flushed
+    void flush( AllocationID ID, VkDeviceSize Off, VkDeviceSize Size ) noexcept;
+    void invalidate( AllocationID ID, VkDeviceSize Off, VkDeviceSize Size ) noexcept;
+
+    // Expected before the submissions that read the queued ranges
+    void flushMappedRanges() noexcept;
+    // Expected after waiting on the submissions that wrote the queued ranges
+    void invalidateMappedRanges() noexcept;
+
+    // Records every allocation made from now on, whatever is still alive at shutdown gets reported. Turning it off forgets
+    // everything recorded so far
+    void setIsTracking( bool State ) noexcept;
+
+    // Expected to be called once per frame by the thread that draws, allocations are recorded with the frame they were made
+    // in. The ranges its thread cache didn't need since the last call are given back
+    void nextFrame() noexcept;
+
+    // Every block with its ranges, the tracked ones include their record
+    [[nodiscard]] bool dumpJson( std::filesystem::path const & Path ) noexcept;
+
+    // Moves owned GpuOnly allocations out of sparse blocks, recording at most ByteBudget bytes worth of copies into CmdBuff.
+    // The source ranges are freed through the VulkanContext garbage queue, so emptied blocks are released a few frames later
+    [[nodiscard]] DefragStats defragment( VkCommandBuffer CmdBuff, VkDeviceSize ByteBudget ) noexcept;
+
+    [[nodiscard]] AllocatorStats getStats() noexcept;
+
     void shutdown() noexcept;
 
   private:
-    std::vector<std::unique_ptr<AllocatorBlock>> Blocks;
+    // Vulkan only guarantees 4096 live allocations (maxMemoryAllocationCount), the fixed table lets the thread caches read
+    // blocks without the lock since a block can't go away while one of its ranges is allocated
+    static constexpr size_t MaxBlockCnt = 4096;
+
+    // Cached ranges are rounded up to a power of two, so they can take up to twice what was asked for. On top of that every
+    // thread keeps up to MaxCachedBytes per class and bucket, which nextFrame only trims for the thread that draws. Other
+    // threads give theirs back when they exit
+    static constexpr uint32_t     MinCacheClass  = 8;
+    static constexpr uint32_t     MaxCacheClass  = 16;
+    static constexpr uint32_t     CacheClassCnt  = MaxCacheClass - MinCacheClass + 1;
+    static constexpr VkDeviceSize MaxCachedBytes = 256 * 1024;
+
+    // Blocks under this usage are worth emptying
+    static constexpr VkDeviceSize DefragMaxUsagePercent = 50;
+
+    // Without VK_EXT_memory_budget only this much of a heap is used, the rest is left for everything else
+    static constexpr VkDeviceSize HeapBudgetPercent = 80;
+
+    // Anything bigger would leave most of a block unused
+    static constexpr VkDeviceSize DedicatedMinSize = AllocatorBlock::MinSize / 2;
+
+    struct CacheBin
+    {
+      std::vector<Allocation> Ranges;
+      // Fewest ranges the bin had since the last trim, that many sat there the whole time
+      size_t                  LowWater = 0;
+    };
+
+    struct ThreadCache
+    {
+      ThreadCache() noexcept = default;
+      MVK_DEFINE_NON_COPYABLE( ThreadCache );
+      MVK_DEFINE_NON_MOVABLE( ThreadCache );
+      ~ThreadCache() noexcept;
+
+      uint64_t                                                          Generation = 0;
+      std::unordered_map<uint64_t, std::array<CacheBin, CacheClassCnt>> Bins;
+    };
+
+    // Blocks sharing the same memory type bits, allocation type, tiling and buffer class
+    struct Bucket
+    {
+      std::vector<size_t> Avail;
+      size_t              BlockCnt;
+    };
+
+    [[nodiscard]] static constexpr uint64_t getBucketKey( AllocationType Type,
+                                                          MemoryTypeBits BuffMemType,
+                                                          ResourceTiling Tiling = ResourceTiling::Linear,
+                                                          BufferClass    Class  = BufferClass::None ) noexcept;
+    [[nodiscard]] static constexpr uint64_t getBucketKey( AllocatorBlock const & Block ) noexcept;
+    [[nodiscard]] static uint32_t           getCacheClass( VkDeviceSize Size, VkDeviceSize Alignment ) noexcept;
+    [[nodiscard]] static size_t             getMaxCachedCnt( uint32_t CacheClass ) noexcept;
+    [[nodiscard]] static ResourceTiling     getImgTiling() noexcept;
+    [[nodiscard]] static bool               wantsDedicated( VkMemoryDedicatedRequirements const & Dedicated,
+                                                            VkMemoryRequirements const &          Req ) noexcept;
+
+    [[nodiscard]] static constexpr uint64_t getRecordKey( AllocationID ID ) noexcept;
+
+    [[nodiscard]] ThreadCache & getThreadCache() noexcept;
+    [[nodiscard]] CacheBin &    getBin( uint64_t Key, uint32_t CacheClass ) noexcept;
+
+    // Goes through the thread caches unless there's an owner
+    [[nodiscard]] std::optional<Allocation> allocateCached( AllocationType Type,
+                                                            VkDeviceSize   Size,
+                                                            VkDeviceSize   Alignment,
+                                                            MemoryTypeBits BuffMemType,
+                                                            BufferClass    Class,
+                                                            Relocatable *  Owner ) noexcept;
+
+    // Takes the lock, skipping the thread caches
+    [[nodiscard]] std::optional<Allocation> allocateUncached( AllocationType Type,
+                                                              VkDeviceSize   Size,
+                                                              VkDeviceSize   Alignment,
+                                                              MemoryTypeBits BuffMemType,
+                                                              ResourceTiling Tiling,
+                                                              BufferClass    Class,
+                                                              Relocatable *  Owner ) noexcept;
+
+    [[nodiscard]] std::optional<Allocation> allocateLocked( AllocationType Type,
+                                                            VkDeviceSize   Size,
+                                                            VkDeviceSize   Alignment,
+                                                            MemoryTypeBits BuffMemType,
+                                                            ResourceTiling Tiling = ResourceTiling::Linear,
+                                                            BufferClass    Class  = BufferClass::None ) noexcept;
+
+    // Either Buff or Img is set
+    [[nodiscard]] std::optional<Allocation>
+      allocateDedicated( AllocationType Type, VkMemoryRequirements const & Req, VkBuffer Buff, VkImage Img ) noexcept;
+
+    [[nodiscard]] std::optional<Allocation> allocateExisting( Bucket & Target, VkDeviceSize Size, VkDeviceSize Alignment ) noexcept;
+
+    [[nodiscard]] std::optional<size_t> pickDefragSrc() const noexcept;
+
+    void freeLocked( AllocationID ID ) noexcept;
+
+    [[nodiscard]] std::optional<size_t> crtBlock( Bucket &       Target,
+                                                  AllocationType Type,
+                                                  VkDeviceSize   Size,
+                                                  VkDeviceSize   MinSize,
+                                                  MemoryTypeBits BuffMemType,
+                                                  ResourceTiling Tiling,
+                                                  BufferClass    Class ) noexcept;
+
+    [[nodiscard]] std::optional<size_t> acquireBlockID() noexcept;
+
+    [[nodiscard]] std::optional<uint32_t> queryMemType( AllocationType Type, MemoryTypeBits BuffMemType ) const noexcept;
+
+    // Device only types count as coherent, there's nothing to flush for them
+    [[nodiscard]] bool         getIsCoherent( uint32_t MemTypeIdx ) const noexcept;
+    // nonCoherentAtomSize for non coherent types, 1 for everything else
+    [[nodiscard]] VkDeviceSize getAtomSize( uint32_t MemTypeIdx ) const noexcept;
+
+    void queueMappedRange( std::vector<VkMappedMemoryRange> & Queue, AllocationID ID, VkDeviceSize Off, VkDeviceSize Size ) noexcept;
+
+    // Without the extension the usage is what this context has reserved
+    [[nodiscard]] VkPhysicalDeviceMemoryBudgetPropertiesEXT queryBudget() const noexcept;
+    [[nodiscard]] VkDeviceSize                              getHeapAvail( uint32_t HeapIdx ) const noexcept;
+
+    // Evicts idle blocks if needed
+    [[nodiscard]] bool hasHeapRoom( uint32_t HeapIdx, VkDeviceSize Size ) noexcept;
+
+    // Pass the allocation through, recording it if tracking is on
+    [[nodiscard]] std::optional<Allocation> track( std::optional<Allocation> const & Allocated,
+                                                   AllocationType                    Type,
+                                                   VkDeviceSize                      Size,
+                                                   VkDeviceSize                      Alignment,
+                                                   std::source_location const &      Loc ) noexcept;
+
+    void untrack( AllocationID ID ) noexcept;
+
+    // The defragmenter moved the allocation, the record follows it
+    void retrack( AllocationID From, AllocationID To ) noexcept;
+
+    void reportLeaks() noexcept;
+
+    void reclaimTombstones() noexcept;
+
+    // Lets go of the empty blocks kept around by reclaimTombstones in the heap
+    void evictIdleBlocks( uint32_t HeapIdx ) noexcept;
+
+    void releaseBlock( size_t ID ) noexcept;
+
+    std::mutex                                               Mtx;
+    std::atomic<uint64_t>                                    Generation       = 1;
+    std::array<std::unique_ptr<AllocatorBlock>, MaxBlockCnt> Blocks;
+    size_t                                                   BlockCnt         = 0;
+    size_t                                                   ReleasedBlockCnt = 0;
+    std::vector<size_t>                                      FreeBlockIDs;
+    std::vector<size_t>                                      Tombstones;
+    std::unordered_map<uint64_t, Bucket>                     Buckets;
+    VkPhysicalDeviceMemoryProperties                         MemProps;
+    // Memory type bits and alignment of the buffers of each class
+    std::array<VkMemoryRequirements, BufferClassCnt>         BuffClassReqs;
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS>            HeapReserved;
+    // Largest device local heap
+    std::optional<uint32_t>                                  VramHeapIdx;
+
+    // Non coherent ranges waiting for flushMappedRanges and invalidateMappedRanges, only taken after Mtx when both are
+    // needed
+    std::mutex                       MappedMtx;
+    std::vector<VkMappedMemoryRange> PendingFlushes;
+    std::vector<VkMappedMemoryRange> PendingInvalidates;
+
+    // Tracking, only taken after Mtx when both are needed
+    std::mutex                                     TrackingMtx;
+    std::atomic<bool>                              IsTracking = false;
+    std::atomic<uint64_t>                          Frame      = 0;
+    std::unordered_map<uint64_t, AllocationRecord> Records;
   };
 
+  [[nodiscard]] constexpr uint64_t
+    AllocatorContext::getBucketKey( AllocationType Type, MemoryTypeBits BuffMemType, ResourceTiling Tiling, BufferClass Class ) noexcept
+  {
+    return ( static_cast<uint64_t>( BuffMemType ) << 32U ) | ( static_cast<uint64_t>( Class ) << 16U ) |
+           ( static_cast<uint64_t>( Tiling ) << 8U ) | static_cast<uint64_t>( Type );
+  }
+
+  [[nodiscard]] constexpr uint64_t AllocatorContext::getBucketKey( AllocatorBlock const & Block ) noexcept
+  {
+    return getBucketKey( Block.getAllocType(), Block.getMemType(), Block.getTiling(), Block.getBuffClass() );
+  }
+
+  [[nodiscard]] constexpr uint64_t AllocatorContext::getRecordKey( AllocationID ID ) noexcept
+  {
+    return ( static_cast<uint64_t>( ID.BlockID ) << 32U ) | static_cast<uint64_t>( ID.RangeID );
+  }
+
 }  // namespace Mvk::Engine
\ No newline at end of file
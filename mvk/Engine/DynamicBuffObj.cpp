@@ -0,0 +1,90 @@
+#include "Engine/DynamicBuffObj.hpp"
+
+#include "Detail/Misc.hpp"
+#include "Engine/VulkanContext.hpp"
+
+namespace Mvk::Engine
+{
+  DynamicBuffObj::DynamicBuffObj( VkDeviceSize RegionSize, size_t RegionCnt, VkBufferUsageFlags Usage, Allocator Alloc ) noexcept
+    : Alloc( Alloc )
+    , Usage( Usage )
+    , Buff( VK_NULL_HANDLE )
+    , Data( nullptr )
+    , RegionSize( RegionSize )
+    , RegionCnt( RegionCnt )
+    , RegionEnd( RegionSize )
+    , Off( 0 )
+    , IsOverflowed( false )
+  {
+    crtBuff();
+  }
+
+  void DynamicBuffObj::crtBuff() noexcept
+  {
+    auto CrtInfo        = VkBufferCreateInfo();
+    CrtInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    CrtInfo.size        = RegionSize * RegionCnt;
+    CrtInfo.usage       = Usage;
+    CrtInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    auto const Device = VulkanContext::the().getDevice();
+
+    auto Result = vkCreateBuffer( Device, &CrtInfo, nullptr, &Buff );
+    MVK_VERIFY( Result == VK_SUCCESS );
+
+    auto Allocation = Alloc.allocate( AllocationType::CpuToGpu, Buff );
+    MVK_VERIFY( Allocation.has_value() );
+
+    vkBindBufferMemory( Device, Buff, Allocation->Mem, Allocation->Off );
+
+    ID   = Allocation->ID;
+    Data = Allocation->Data;
+  }
+
+  DynamicBuffObj::~DynamicBuffObj() noexcept
+  {
+    auto const Device = VulkanContext::the().getDevice();
+    vkDestroyBuffer( Device, Buff, nullptr );
+
+    Alloc.free( ID );
+  }
+
+  [[nodiscard]] std::optional<DynamicBuffObj::AllocResult> DynamicBuffObj::allocate( VkDeviceSize Size, VkDeviceSize Alignment ) noexcept
+  {
+    // Offsets are relative to the buffer, which is what dynamic offsets and binds expect
+    auto const AlignedOff = Detail::alignedSize( Off, Alignment );
+
+    if ( AlignedOff + Size > RegionEnd )
+    {
+      IsOverflowed = true;
+      return std::nullopt;
+    }
+
+    Off = AlignedOff + Size;
+    Alloc.flush( ID, AlignedOff, Size );
+
+    return AllocResult{ Buff, AlignedOff, Data + AlignedOff };
+  }
+
+  void DynamicBuffObj::grow() noexcept
+  {
+    VulkanContext::the().addGarbage( Buff );
+    VulkanContext::the().addGarbage( ID );
+
+    RegionSize   *= 2;
+    RegionEnd     = 0;
+    Off           = 0;
+    IsOverflowed  = false;
+
+    crtBuff();
+  }
+
+  void DynamicBuffObj::reset( size_t RegionIdx ) noexcept
+  {
+    MVK_VERIFY( RegionIdx < RegionCnt );
+
+    Off       = RegionSize * RegionIdx;
+    RegionEnd = Off + RegionSize;
+  }
+
+}  // namespace Mvk::Engine
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Engine/Allocator.hpp"
+#include "Utility/Macros.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Engine
+{
+  // Persistently mapped buffer split in one region per frame in flight, allocations are just an offset bump and the whole
+  // region is reset once the frame that used it is done
+  class DynamicBuffObj
+  {
+  public:
+    struct AllocResult
+    {
+      VkBuffer     Buff;
+      VkDeviceSize Off;
+      std::byte *  Data;
+    };
+
+    DynamicBuffObj( VkDeviceSize RegionSize, size_t RegionCnt, VkBufferUsageFlags Usage, Allocator Alloc = Allocator() ) noexcept;
+    MVK_DEFINE_NON_COPYABLE( DynamicBuffObj );
+    MVK_DEFINE_NON_MOVABLE( DynamicBuffObj );
+    ~DynamicBuffObj() noexcept;
+
+    // Nothing once the region is full, the buffer is flagged so it can be grown before the next frame
+    [[nodiscard]] std::optional<AllocResult> allocate( VkDeviceSize Size, VkDeviceSize Alignment ) noexcept;
+
+    // Only call once the fence of the frame that used the region was signaled
+    void reset( size_t RegionIdx ) noexcept;
+
+    // Switches to a buffer with twice the region size, frames in flight keep the old one until the garbage queue takes it.
+    // Whatever points to getBuff() has to be updated, reset has to be called before the next allocate
+    void grow() noexcept;
+
+    [[nodiscard]] constexpr VkBuffer     getBuff() const noexcept;
+    [[nodiscard]] constexpr VkDeviceSize getRegionSize() const noexcept;
+    [[nodiscard]] constexpr bool         getIsOverflowed() const noexcept;
+
+  private:
+    void crtBuff() noexcept;
+
+    Allocator          Alloc;
+    VkBufferUsageFlags Usage;
+    VkBuffer           Buff;
+    std::byte *        Data;
+    AllocationID       ID;
+    VkDeviceSize       RegionSize;
+    size_t             RegionCnt;
+    VkDeviceSize       RegionEnd;
+    VkDeviceSize       Off;
+    // An allocate didn't fit since the last grow
+    bool               IsOverflowed;
+  };
+
+  [[nodiscard]] constexpr VkBuffer DynamicBuffObj::getBuff() const noexcept
+  {
+    return Buff;
+  }
+
+  [[nodiscard]] constexpr VkDeviceSize DynamicBuffObj::getRegionSize() const noexcept
+  {
+    return RegionSize;
+  }
+
+  [[nodiscard]] constexpr bool DynamicBuffObj::getIsOverflowed() const noexcept
+  {
+    return IsOverflowed;
+  }
+
+}  // namespace Mvk::Engine
@@ -0,0 +1,88 @@
+#include "Engine/GarbageQueue.hpp"
+
+#include "Engine/AllocatorContext.hpp"
+
+namespace Mvk::Engine
+{
+  void GarbageQueue::add( VkBuffer Buff ) noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+    Garbages[CurrentIdx].Buffs.push_back( Buff );
+  }
+
+  void GarbageQueue::add( VkImage Img ) noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+    Garbages[CurrentIdx].Imgs.push_back( Img );
+  }
+
+  void GarbageQueue::add( VkImageView ImgView ) noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+    Garbages[CurrentIdx].ImgViews.push_back( ImgView );
+  }
+
+  void GarbageQueue::add( VkDescriptorPool Pool, VkDescriptorSet DescSet ) noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+    Garbages[CurrentIdx].DescSets.emplace_back( Pool, DescSet );
+  }
+
+  void GarbageQueue::add( AllocationID ID ) noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+    Garbages[CurrentIdx].Allocs.push_back( ID );
+  }
+
+  void GarbageQueue::collect( VkDevice Device ) noexcept
+  {
+    auto Trash = Garbage();
+
+    // The allocator adds garbage while holding its own lock, so nothing can be destroyed while holding this one
+    {
+      auto Lock  = std::scoped_lock( Mtx );
+      CurrentIdx = ( CurrentIdx + 1 ) % BuffCount;
+      std::swap( Trash, Garbages[CurrentIdx] );
+    }
+
+    dstr( Device, Trash );
+  }
+
+  void GarbageQueue::flush( VkDevice Device ) noexcept
+  {
+    for ( auto Idx = size_t( 0 ); Idx < BuffCount; ++Idx )
+    {
+      collect( Device );
+    }
+  }
+
+  void GarbageQueue::dstr( VkDevice Device, Garbage & Trash ) noexcept
+  {
+    for ( auto const & [Pool, DescSet] : Trash.DescSets )
+    {
+      vkFreeDescriptorSets( Device, Pool, 1, &DescSet );
+    }
+
+    for ( auto const ImgView : Trash.ImgViews )
+    {
+      vkDestroyImageView( Device, ImgView, nullptr );
+    }
+
+    for ( auto const Img : Trash.Imgs )
+    {
+      vkDestroyImage( Device, Img, nullptr );
+    }
+
+    for ( auto const Buff : Trash.Buffs )
+    {
+      vkDestroyBuffer( Device, Buff, nullptr );
+    }
+
+    // Memory goes last, nothing can be bound to it anymore
+    for ( auto const ID : Trash.Allocs )
+    {
+      AllocatorContext::the().free( ID );
+    }
+  }
+
+}  // namespace Mvk::Engine
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Engine/AllocatorBlock.hpp"
+#include "Utility/Macros.hpp"
+
+#include <array>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Engine
+{
+  // Objects that may still be in use by the GPU, they're destroyed BuffCount collect calls after being added. Shared by
+  // the VulkanContext and the allocator bench's headless one
+  class GarbageQueue
+  {
+  public:
+    static constexpr size_t BuffCount = 2;
+
+    GarbageQueue() noexcept = default;
+    MVK_DEFINE_NON_COPYABLE( GarbageQueue );
+    MVK_DEFINE_NON_MOVABLE( GarbageQueue );
+    ~GarbageQueue() noexcept = default;
+
+    // Safe to call from any thread
+    void add( VkBuffer Buff ) noexcept;
+    void add( VkImage Img ) noexcept;
+    void add( VkImageView ImgView ) noexcept;
+    void add( VkDescriptorPool Pool, VkDescriptorSet DescSet ) noexcept;
+    void add( AllocationID ID ) noexcept;
+
+    void collect( VkDevice Device ) noexcept;
+
+    // Doesn't wait for the device, the caller has to
+    void flush( VkDevice Device ) noexcept;
+
+  private:
+    struct Garbage
+    {
+      std::vector<VkBuffer>                                     Buffs;
+      std::vector<VkImage>                                      Imgs;
+      std::vector<VkImageView>                                  ImgViews;
+      std::vector<std::pair<VkDescriptorPool, VkDescriptorSet>> DescSets;
+      std::vector<AllocationID>                                 Allocs;
+    };
+
+    static void dstr( VkDevice Device, Garbage & Trash ) noexcept;
+
+    std::mutex                     Mtx;
+    std::array<Garbage, BuffCount> Garbages;
+    size_t                         CurrentIdx = 0;
+  };
+
+}  // namespace Mvk::Engine
@@ -2,45 +2,76 @@
 #include "Engine/IdxBuffObj.hpp"
 
 #include "Engine/VulkanContext.hpp"
+#include "Utility/Verify.hpp"
+
+#include <cstring>
 
 namespace Mvk::Engine
 {
   IdxBuffObj::IdxBuffObj( VkDeviceSize ByteSize, Allocator Alloc ) noexcept
-    : Stage( std::make_unique<StagingBuffObj>( ByteSize, Alloc ) ), Buff( VK_NULL_HANDLE )
+    : Alloc( Alloc ), Size( ByteSize ), Buff( VK_NULL_HANDLE ), Off( 0 ), Data( nullptr )
   {
-    auto CrtInfo        = VkBufferCreateInfo();
-    CrtInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    CrtInfo.size        = ByteSize;
-    CrtInfo.usage       = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-    CrtInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    // Written in place when the device local memory can be mapped, staged otherwise
+    auto Allocation = Alloc.allocate( AllocationType::GpuMapped, BufferClass::Geometry, ByteSize, Alignment, this );
 
-    auto const Device = VulkanContext::the().getDevice();
+    if ( !Allocation.has_value() )
+    {
+      Allocation = Alloc.allocate( AllocationType::GpuOnly, BufferClass::Geometry, ByteSize, Alignment, this );
+    }
 
-    auto Result = vkCreateBuffer( Device, &CrtInfo, nullptr, &Buff );
-    MVK_VERIFY( Result == VK_SUCCESS );
+    // Over the memory budget, the owner checks getIsAllocated and tries again later
+    if ( !Allocation.has_value() )
+    {
+      return;
+    }
 
-    auto Req = VkMemoryRequirements();
-    vkGetBufferMemoryRequirements( Device, Buff, &Req );
+    Buff = Allocation->Buff;
+    Off  = Allocation->Off;
+    Data = Allocation->Data;
+    ID   = Allocation->ID;
+  }
 
-    auto Allocation = Stage->getAllocator().allocate( AllocationType::GpuOnly, Req.size, Req.alignment, Req.memoryTypeBits );
+  void IdxBuffObj::relocate( VkCommandBuffer CmdBuff, Allocation const & NewAlloc ) noexcept
+  {
+    auto CopyRegion      = VkBufferCopy();
+    CopyRegion.srcOffset = Off;
+    CopyRegion.dstOffset = NewAlloc.Off;
+    CopyRegion.size      = Size;
 
-    vkBindBufferMemory( Device, Buff, Allocation.Mem, Allocation.Off );
+    // The old range is freed by the allocator
+    vkCmdCopyBuffer( CmdBuff, Buff, NewAlloc.Buff, 1, &CopyRegion );
 
-    ID = Allocation.ID;
+    Buff = NewAlloc.Buff;
+    Off  = NewAlloc.Off;
+    ID   = NewAlloc.ID;
   }
 
-  void IdxBuffObj::map( VkCommandBuffer CmdBuff, std::span<uint32_t const> Data ) noexcept
+  void IdxBuffObj::map( VkCommandBuffer CmdBuff, StagingRing & Stage, std::span<uint32_t const> Src ) noexcept
   {
-    Cnt = std::size( Data );
-    Stage->map( std::as_bytes( Data ) ).copyTo( CmdBuff, Buff );
+    Cnt = std::size( Src );
+
+    if ( getIsMapped() )
+    {
+      std::memcpy( Data, std::data( Src ), std::size( Src ) * sizeof( uint32_t ) );
+      Alloc.flush( ID, 0, std::size( Src ) * sizeof( uint32_t ) );
+      return;
+    }
+
+    Stage.copyTo( CmdBuff, std::as_bytes( Src ), Buff, Off );
   }
 
-  IdxBuffObj::~IdxBuffObj() noexcept
+  void IdxBuffObj::map( VkCommandBuffer CmdBuff, StagingRing & Stage, StagingRing::AllocResult const & From ) noexcept
   {
-    auto const Device = VulkanContext::the().getDevice();
-    vkDestroyBuffer( Device, Buff, nullptr );
+    Cnt = static_cast<uint32_t>( Size / sizeof( uint32_t ) );
+    Stage.copyTo( CmdBuff, From, Size, Buff, Off );
+  }
 
-    Stage->getAllocator().free( ID );
+  IdxBuffObj::~IdxBuffObj() noexcept
+  {
+    if ( getIsAllocated() )
+    {
+      Alloc.free( ID );
+    }
   }
 
 }  // namespace Mvk::Engine
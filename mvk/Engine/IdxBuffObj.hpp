@@ -1,12 +1,13 @@
 
 #pragma once
 
-#include "Engine/StagingBuffObj.hpp"
+#include "Engine/Relocatable.hpp"
+#include "Engine/StagingRing.hpp"
 #include "Utility/Macros.hpp"
 
 namespace Mvk::Engine
 {
-  class IdxBuffObj
+  class IdxBuffObj : public Relocatable
   {
   public:
     struct MapResult
@@ -19,22 +20,49 @@ namespace Mvk::Engine
     MVK_DEFINE_NON_MOVABLE( IdxBuffObj );
     ~IdxBuffObj() noexcept;
 
-    void map( VkCommandBuffer CmdBuff, std::span<uint32_t const> Data ) noexcept;
+    // Doesn't record anything when the buffer is mapped
+    void map( VkCommandBuffer CmdBuff, StagingRing & Stage, std::span<uint32_t const> Src ) noexcept;
+    // Fills the whole buffer from data that's already staged, always a copy
+    void map( VkCommandBuffer CmdBuff, StagingRing & Stage, StagingRing::AllocResult const & From ) noexcept;
+    void relocate( VkCommandBuffer CmdBuff, Allocation const & NewAlloc ) noexcept override;
 
     [[nodiscard]] constexpr VkBuffer getBuff() const noexcept
     {
       return Buff;
     }
+    [[nodiscard]] constexpr VkDeviceSize getOff() const noexcept
+    {
+      return Off;
+    }
+    [[nodiscard]] constexpr VkDeviceSize getSize() const noexcept
+    {
+      return Size;
+    }
+    [[nodiscard]] constexpr bool getIsMapped() const noexcept
+    {
+      return Data != nullptr;
+    }
+    // False when the memory budget had no room for it, it can only be destroyed then
+    [[nodiscard]] constexpr bool getIsAllocated() const noexcept
+    {
+      return Buff != VK_NULL_HANDLE;
+    }
     [[nodiscard]] constexpr uint32_t getCnt() const noexcept
     {
       return Cnt;
     }
 
   private:
-    std::unique_ptr<StagingBuffObj> Stage;
-    VkBuffer                        Buff;
-    uint32_t                        Cnt;
-    AllocationID                    ID;
+    // Offsets bound as index buffers have to be a multiple of the index size
+    static constexpr VkDeviceSize Alignment = sizeof( uint32_t );
+
+    Allocator    Alloc;
+    VkDeviceSize Size;
+    VkBuffer     Buff;
+    VkDeviceSize Off;
+    std::byte *  Data;
+    uint32_t     Cnt;
+    AllocationID ID;
   };
 
 }  // namespace Mvk::Engine
\ No newline at end of file
@@ -3,16 +3,13 @@
 #include "Detail/Misc.hpp"
 #include "Engine/AllocatorContext.hpp"
 
-namespace Mvk::Engine
+#include <algorithm>
+#include <vector>
+
+// Kept in Mvk::Detail so an Engine::Detail doesn't hide the helpers from Detail/Misc.hpp
+namespace Mvk::Detail
 {
-  ImgObj::ImgObj( size_t Width, size_t Height, Allocator Alloc ) noexcept
-    : MipLvl( Detail::calcMipLvl( Width, Height ) )
-    , Width( Width )
-    , Height( Height )
-    , Stage( Width * Height * RGBASize, Alloc )
-    , Img( VK_NULL_HANDLE )
-    , ImgView( VK_NULL_HANDLE )
-    , Sampler( VK_NULL_HANDLE )
+  [[nodiscard]] static VkImage crtImg( size_t Width, size_t Height, VkFormat Format, uint32_t MipLvl ) noexcept
   {
     auto ImgCrtInfo          = VkImageCreateInfo();
     ImgCrtInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -22,7 +19,7 @@ namespace Mvk::Engine
     ImgCrtInfo.extent.depth  = 1;
     ImgCrtInfo.mipLevels     = MipLvl;
     ImgCrtInfo.arrayLayers   = 1;
-    ImgCrtInfo.format        = VK_FORMAT_R8G8B8A8_SRGB;
+    ImgCrtInfo.format        = Format;
     ImgCrtInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
     ImgCrtInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     ImgCrtInfo.usage         = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
@@ -30,36 +27,127 @@ namespace Mvk::Engine
     ImgCrtInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
     ImgCrtInfo.flags         = 0;
 
-    auto const Device = VulkanContext::the().getDevice();
-
-    auto Result = vkCreateImage( Device, &ImgCrtInfo, nullptr, &Img );
-
-    auto Req = VkMemoryRequirements();
-    vkGetImageMemoryRequirements( Device, Img, &Req );
-
-    auto Allocation = Stage.getAllocator().allocate( AllocationType::GpuOnly, Req.size, Req.alignment, Req.memoryTypeBits );
+    auto Img    = VkImage();
+    auto Result = vkCreateImage( Engine::VulkanContext::the().getDevice(), &ImgCrtInfo, nullptr, &Img );
+    MVK_VERIFY( Result == VK_SUCCESS );
 
-    ID = Allocation.ID;
-    vkBindImageMemory( Device, Img, Allocation.Mem, Allocation.Off );
+    return Img;
+  }
 
+  [[nodiscard]] static VkImageView crtImgView( VkImage Img, VkFormat Format, uint32_t MipLvl ) noexcept
+  {
     auto ImgViewCrtInfo                            = VkImageViewCreateInfo();
     ImgViewCrtInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     ImgViewCrtInfo.image                           = Img;
     ImgViewCrtInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
-    ImgViewCrtInfo.format                          = VK_FORMAT_R8G8B8A8_SRGB;
+    ImgViewCrtInfo.format                          = Format;
     ImgViewCrtInfo.components.r                    = VK_COMPONENT_SWIZZLE_IDENTITY;
     ImgViewCrtInfo.components.g                    = VK_COMPONENT_SWIZZLE_IDENTITY;
     ImgViewCrtInfo.components.b                    = VK_COMPONENT_SWIZZLE_IDENTITY;
     ImgViewCrtInfo.components.a                    = VK_COMPONENT_SWIZZLE_IDENTITY;
     ImgViewCrtInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
     ImgViewCrtInfo.subresourceRange.baseMipLevel   = 0;
-    ImgViewCrtInfo.subresourceRange.levelCount     = ImgCrtInfo.mipLevels;
+    ImgViewCrtInfo.subresourceRange.levelCount     = MipLvl;
     ImgViewCrtInfo.subresourceRange.baseArrayLayer = 0;
     ImgViewCrtInfo.subresourceRange.layerCount     = 1;
 
-    Result = vkCreateImageView( Device, &ImgViewCrtInfo, nullptr, &ImgView );
+    auto ImgView = VkImageView();
+    auto Result  = vkCreateImageView( Engine::VulkanContext::the().getDevice(), &ImgViewCrtInfo, nullptr, &ImgView );
     MVK_VERIFY( Result == VK_SUCCESS );
 
+    return ImgView;
+  }
+
+  [[nodiscard]] static uint32_t getLvlDim( size_t Dim, uint32_t Lvl ) noexcept
+  {
+    return static_cast<uint32_t>( std::max( Dim >> Lvl, size_t( 1 ) ) );
+  }
+
+  // Levels [FromLvl, ToLvl) of the chain, the images hold the chain from their first level on. Both are expected in the
+  // transfer layouts
+  static void copyImgLvls( VkCommandBuffer CmdBuff,
+                           VkImage         Src,
+                           uint32_t        SrcFirstLvl,
+                           VkImage         Dst,
+                           uint32_t        DstFirstLvl,
+                           uint32_t        FromLvl,
+                           uint32_t        ToLvl,
+                           size_t          Width,
+                           size_t          Height ) noexcept
+  {
+    auto Regions = std::vector<VkImageCopy>();
+
+    for ( auto Lvl = FromLvl; Lvl < ToLvl; ++Lvl )
+    {
+      auto & Region                        = Regions.emplace_back();
+      Region.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+      Region.srcSubresource.mipLevel       = Lvl - SrcFirstLvl;
+      Region.srcSubresource.baseArrayLayer = 0;
+      Region.srcSubresource.layerCount     = 1;
+      Region.srcOffset                     = { 0, 0, 0 };
+      Region.dstSubresource                = Region.srcSubresource;
+      Region.dstSubresource.mipLevel       = Lvl - DstFirstLvl;
+      Region.dstOffset                     = { 0, 0, 0 };
+      Region.extent.width                  = getLvlDim( Width, Lvl );
+      Region.extent.height                 = getLvlDim( Height, Lvl );
+      Region.extent.depth                  = 1;
+    }
+
+    vkCmdCopyImage( CmdBuff,
+                    Src,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    Dst,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    static_cast<uint32_t>( std::size( Regions ) ),
+                    std::data( Regions ) );
+  }
+
+}  // namespace Mvk::Detail
+
+namespace Mvk::Engine
+{
+  ImgObj::ImgObj( size_t Width, size_t Height, Allocator Alloc ) noexcept
+    : ImgObj( Width, Height, Detail::TexFormat::Rgba8, 0, 0, Alloc )
+  {}
+
+  ImgObj::ImgObj( size_t Width, size_t Height, Detail::TexFormat Format, uint32_t LvlCnt, uint32_t FirstLvl, Allocator Alloc ) noexcept
+    : Alloc( Alloc )
+    , Format( Format )
+    , MipLvl( LvlCnt != 0 ? LvlCnt : Detail::calcMipLvl( Width, Height ) )
+    , FirstLvl( FirstLvl )
+    , IsMipGenerated( LvlCnt == 0 )
+    , Width( Width )
+    , Height( Height )
+    , Img( VK_NULL_HANDLE )
+    , ImgView( VK_NULL_HANDLE )
+    , Sampler( VK_NULL_HANDLE )
+    , PendingImg( VK_NULL_HANDLE )
+    , PendingFirstLvl( FirstLvl )
+  {
+    // Blits don't work on compressed formats and need the first level
+    MVK_VERIFY( !IsMipGenerated || ( Format == Detail::TexFormat::Rgba8 && FirstLvl == 0 ) );
+    MVK_VERIFY( FirstLvl < MipLvl );
+
+    Img = Detail::crtImg(
+      Detail::getLvlDim( Width, FirstLvl ), Detail::getLvlDim( Height, FirstLvl ), Detail::getVkFormat( Format ), getMipLvl() );
+
+    auto const Device = VulkanContext::the().getDevice();
+
+    // Over the memory budget, the owner checks getIsAllocated and tries again later
+    auto Allocation = Alloc.allocate( AllocationType::GpuOnly, Img, this );
+
+    if ( !Allocation.has_value() )
+    {
+      vkDestroyImage( Device, Img, nullptr );
+      Img = VK_NULL_HANDLE;
+      return;
+    }
+
+    ID = Allocation->ID;
+    vkBindImageMemory( Device, Img, Allocation->Mem, Allocation->Off );
+
+    ImgView = Detail::crtImgView( Img, Detail::getVkFormat( Format ), getMipLvl() );
+
     auto SamplerCrtInfo                    = VkSamplerCreateInfo();
     SamplerCrtInfo.sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     SamplerCrtInfo.magFilter               = VK_FILTER_LINEAR;
@@ -79,25 +167,168 @@ namespace Mvk::Engine
     SamplerCrtInfo.minLod                  = 0.0F;
     SamplerCrtInfo.maxLod                  = std::numeric_limits<float>::max();
 
-    Result = vkCreateSampler( Device, &SamplerCrtInfo, nullptr, &Sampler );
+    auto Result = vkCreateSampler( Device, &SamplerCrtInfo, nullptr, &Sampler );
     MVK_VERIFY( Result == VK_SUCCESS );
   }
 
-  void ImgObj::map( VkCommandBuffer CmdBuff, std::span<std::byte const> Data ) noexcept
+  void ImgObj::map( VkCommandBuffer CmdBuff, StagingRing & Stage, std::span<std::byte const> Data ) noexcept
+  {
+    map( CmdBuff, Stage, Data, 0 );
+  }
+
+  void ImgObj::map( VkCommandBuffer CmdBuff, StagingRing & Stage, std::span<std::byte const> Data, uint32_t Lvl ) noexcept
+  {
+    MVK_VERIFY( Lvl >= FirstLvl && Lvl < MipLvl );
+    MVK_VERIFY( std::size( Data ) == Detail::getLevelSize( Format, Width, Height, Lvl ) );
+    Stage.copyTo( CmdBuff, Data, Img, Detail::getLvlDim( Width, Lvl ), Detail::getLvlDim( Height, Lvl ), Lvl - FirstLvl );
+  }
+
+  void ImgObj::map( VkCommandBuffer CmdBuff, StagingRing & Stage, StagingRing::AllocResult const & From, uint32_t Lvl ) noexcept
   {
-    Stage.map( Data ).copyTo( CmdBuff, Img, Width, Height );
+    MVK_VERIFY( Lvl >= FirstLvl && Lvl < MipLvl );
+    Stage.copyTo( CmdBuff, From, Img, Detail::getLvlDim( Width, Lvl ), Detail::getLvlDim( Height, Lvl ), Lvl - FirstLvl );
   }
 
   void ImgObj::transitionLayout( VkCommandBuffer CmdBuff, VkImageLayout OldLay, VkImageLayout NewLay ) noexcept
   {
-    Detail::transitionImgLayout( CmdBuff, Img, OldLay, NewLay, MipLvl );
+    Detail::transitionImgLayout( CmdBuff, Img, OldLay, NewLay, getMipLvl() );
   }
 
   void ImgObj::generateMips( VkCommandBuffer CmdBuff ) noexcept
   {
+    if ( !IsMipGenerated )
+    {
+      transitionLayout( CmdBuff, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+      return;
+    }
+
     Detail::generateMip( CmdBuff, Img, Width, Height, MipLvl );
   }
 
+  [[nodiscard]] bool ImgObj::isSupported( Detail::TexFormat Format ) noexcept
+  {
+    auto Props = VkFormatProperties();
+    vkGetPhysicalDeviceFormatProperties( VulkanContext::the().getPhysicalDevice(), Detail::getVkFormat( Format ), &Props );
+
+    auto const Required = VkFormatFeatureFlags( VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+                                                | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT );
+
+    return ( Props.optimalTilingFeatures & Required ) == Required;
+  }
+
+  [[nodiscard]] bool
+    ImgObj::beginResidency( VkCommandBuffer CmdBuff, StagingRing & Stage, uint32_t NewFirstLvl, Detail::TexView const & Src ) noexcept
+  {
+    MVK_VERIFY( PendingImg == VK_NULL_HANDLE && !IsMipGenerated && NewFirstLvl < MipLvl && NewFirstLvl != FirstLvl );
+    MVK_VERIFY( Src.File != nullptr );
+
+    auto const LvlCnt = MipLvl - NewFirstLvl;
+    auto const NewImg = Detail::crtImg(
+      Detail::getLvlDim( Width, NewFirstLvl ), Detail::getLvlDim( Height, NewFirstLvl ), Detail::getVkFormat( Format ), LvlCnt );
+
+    // Over the memory budget, the caller can evict something else and try again
+    auto const Allocation = Alloc.allocate( AllocationType::GpuOnly, NewImg, this );
+
+    if ( !Allocation.has_value() )
+    {
+      vkDestroyImage( VulkanContext::the().getDevice(), NewImg, nullptr );
+      return false;
+    }
+
+    vkBindImageMemory( VulkanContext::the().getDevice(), NewImg, Allocation->Mem, Allocation->Off );
+
+    // The new levels come first in the new image
+    if ( NewFirstLvl < FirstLvl )
+    {
+      Detail::transitionImgLayout(
+        CmdBuff, NewImg, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, FirstLvl - NewFirstLvl );
+
+      for ( auto Lvl = NewFirstLvl; Lvl < FirstLvl; ++Lvl )
+      {
+        auto const Level = Src.Levels[Lvl];
+        MVK_VERIFY( std::size( Level ) == Detail::getLevelSize( Format, Width, Height, Lvl ) );
+
+        auto const Staged = Stage.stage( Src.File, Src.File->getOff( Level ), std::size( Level ) );
+        Stage.copyTo( CmdBuff, Staged, NewImg, Detail::getLvlDim( Width, Lvl ), Detail::getLvlDim( Height, Lvl ), Lvl - NewFirstLvl );
+      }
+    }
+
+    PendingImg      = NewImg;
+    PendingID       = Allocation->ID;
+    PendingFirstLvl = NewFirstLvl;
+
+    return true;
+  }
+
+  void ImgObj::endResidency( VkCommandBuffer CmdBuff ) noexcept
+  {
+    MVK_VERIFY( PendingImg != VK_NULL_HANDLE );
+
+    auto const LvlCnt = MipLvl - PendingFirstLvl;
+    // Levels of the new image that beginResidency filled
+    auto const Staged = FirstLvl > PendingFirstLvl ? FirstLvl - PendingFirstLvl : 0;
+
+    transitionLayout( CmdBuff, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL );
+    Detail::transitionImgLayout(
+      CmdBuff, PendingImg, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, LvlCnt - Staged, Staged );
+
+    Detail::copyImgLvls(
+      CmdBuff, Img, FirstLvl, PendingImg, PendingFirstLvl, std::max( FirstLvl, PendingFirstLvl ), MipLvl, Width, Height );
+
+    Detail::transitionImgLayout(
+      CmdBuff, PendingImg, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, LvlCnt );
+
+    // Frames in flight may still sample the old image. Its range stays with us until the garbage queue frees it, so the
+    // defragmenter must not move it in the meantime
+    VulkanContext::the().addGarbage( ImgView );
+    VulkanContext::the().addGarbage( Img );
+    Alloc.disown( ID );
+    VulkanContext::the().addGarbage( ID );
+
+    Img        = PendingImg;
+    ID         = PendingID;
+    FirstLvl   = PendingFirstLvl;
+    ImgView    = Detail::crtImgView( Img, Detail::getVkFormat( Format ), LvlCnt );
+    PendingImg = VK_NULL_HANDLE;
+  }
+
+  [[nodiscard]] VkDeviceSize ImgObj::getResidentSize() const noexcept
+  {
+    auto Size = VkDeviceSize( 0 );
+
+    for ( auto Lvl = FirstLvl; Lvl < MipLvl; ++Lvl )
+    {
+      Size += Detail::getLevelSize( Format, Width, Height, Lvl );
+    }
+
+    return Size;
+  }
+
+  void ImgObj::relocate( VkCommandBuffer CmdBuff, Allocation const & NewAlloc ) noexcept
+  {
+    auto const NewImg = Detail::crtImg(
+      Detail::getLvlDim( Width, FirstLvl ), Detail::getLvlDim( Height, FirstLvl ), Detail::getVkFormat( Format ), getMipLvl() );
+
+    vkBindImageMemory( VulkanContext::the().getDevice(), NewImg, NewAlloc.Mem, NewAlloc.Off );
+
+    // Relocation only happens between frames, by then the image has been uploaded and is only sampled
+    transitionLayout( CmdBuff, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL );
+    Detail::transitionImgLayout( CmdBuff, NewImg, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, getMipLvl() );
+
+    Detail::copyImgLvls( CmdBuff, Img, FirstLvl, NewImg, FirstLvl, FirstLvl, MipLvl, Width, Height );
+
+    Detail::transitionImgLayout(
+      CmdBuff, NewImg, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, getMipLvl() );
+
+    // The old range is freed by the allocator
+    VulkanContext::the().addGarbage( ImgView );
+    VulkanContext::the().addGarbage( Img );
+
+    Img     = NewImg;
+    ImgView = Detail::crtImgView( Img, Detail::getVkFormat( Format ), getMipLvl() );
+    ID      = NewAlloc.ID;
+  }
+
   ImgObj::~ImgObj() noexcept
   {
     auto const Device = VulkanContext::the().getDevice();
@@ -105,7 +336,16 @@ namespace Mvk::Engine
     vkDestroyImageView( Device, ImgView, nullptr );
     vkDestroySampler( Device, Sampler, nullptr );
 
-    Stage.getAllocator().free( ID );
+    if ( getIsAllocated() )
+    {
+      Alloc.free( ID );
+    }
+
+    if ( PendingImg != VK_NULL_HANDLE )
+    {
+      vkDestroyImage( Device, PendingImg, nullptr );
+      Alloc.free( PendingID );
+    }
   }
 
 }  // namespace Mvk::Engine
\ No newline at end of file
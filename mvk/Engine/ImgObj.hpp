@@ -1,24 +1,106 @@
 #pragma once
 
+#include "Detail/Ktx2.hpp"
+#include "Detail/TexFormat.hpp"
 #include "Engine/AllocatorContext.hpp"
-#include "Engine/StagingBuffObj.hpp"
+#include "Engine/Relocatable.hpp"
+#include "Engine/StagingRing.hpp"
 #include "Utility/Macros.hpp"
 
 namespace Mvk::Engine
 {
-  class ImgObj
+  class ImgObj : public Relocatable
   {
   public:
     static constexpr auto RGBASize = 4;
 
     ImgObj( size_t Width, size_t Height, Allocator Alloc = Allocator() ) noexcept;
+    // LvlCnt levels that are all mapped, 0 gives the full chain generated from the first level which only works for RGBA8.
+    // Only the levels from FirstLvl on are resident, see beginResidency
+    ImgObj( size_t            Width,
+            size_t            Height,
+            Detail::TexFormat Format,
+            uint32_t          LvlCnt,
+            uint32_t          FirstLvl = 0,
+            Allocator         Alloc    = Allocator() ) noexcept;
     MVK_DEFINE_NON_COPYABLE( ImgObj );
     MVK_DEFINE_NON_MOVABLE( ImgObj );
     ~ImgObj() noexcept;
 
-    void map( VkCommandBuffer CmdBuff, std::span<std::byte const> Data ) noexcept;
+    void map( VkCommandBuffer CmdBuff, StagingRing & Stage, std::span<std::byte const> Data ) noexcept;
+    // Level Lvl of the chain, blocks tightly packed
+    void map( VkCommandBuffer CmdBuff, StagingRing & Stage, std::span<std::byte const> Data, uint32_t Lvl ) noexcept;
+    // Same from a level that's already staged
+    void map( VkCommandBuffer CmdBuff, StagingRing & Stage, StagingRing::AllocResult const & From, uint32_t Lvl ) noexcept;
     void transitionLayout( VkCommandBuffer CmdBuff, VkImageLayout OldLay, VkImageLayout NewLay ) noexcept;
+    // Only blits when the levels weren't mapped, either way the image is ready to be sampled after
     void generateMips( VkCommandBuffer CmdBuff ) noexcept;
+    void relocate( VkCommandBuffer CmdBuff, Allocation const & NewAlloc ) noexcept override;
+
+    // Switches to an image holding the levels from NewFirstLvl on, which is all the view and so the sampler ever see. The
+    // levels that become resident are staged from the mapping of Src, which has the whole chain, on CmdBuff which isn't
+    // touched otherwise. They are levels [0, FirstLvl - NewFirstLvl) of getPendingImg() and in the transfer destination
+    // layout. False when the new image doesn't fit, nothing changed then
+    [[nodiscard]] bool
+      beginResidency( VkCommandBuffer CmdBuff, StagingRing & Stage, uint32_t NewFirstLvl, Detail::TexView const & Src ) noexcept;
+    // Recorded by the queue that samples the image once the copies of beginResidency are visible to it, brings over the
+    // levels both images have and retires the old one
+    void endResidency( VkCommandBuffer CmdBuff ) noexcept;
+
+    // Sampled with linear filtering and copied both ways, which is what loading and relocating need
+    [[nodiscard]] static bool isSupported( Detail::TexFormat Format ) noexcept;
+
+    // Bytes of the resident levels
+    [[nodiscard]] VkDeviceSize getResidentSize() const noexcept;
+
+    [[nodiscard]] constexpr VkImage getImg() noexcept
+    {
+      return Img;
+    }
+
+    // False when the memory budget had no room for it, it can only be destroyed then
+    [[nodiscard]] constexpr bool getIsAllocated() const noexcept
+    {
+      return Img != VK_NULL_HANDLE;
+    }
+
+    // Levels of the image, the resident ones
+    [[nodiscard]] constexpr uint32_t getMipLvl() const noexcept
+    {
+      return MipLvl - FirstLvl;
+    }
+
+    // Levels of the whole chain
+    [[nodiscard]] constexpr uint32_t getChainLvl() const noexcept
+    {
+      return MipLvl;
+    }
+
+    // Finest resident level of the chain
+    [[nodiscard]] constexpr uint32_t getFirstLvl() const noexcept
+    {
+      return FirstLvl;
+    }
+
+    [[nodiscard]] constexpr size_t getWidth() const noexcept
+    {
+      return Width;
+    }
+
+    [[nodiscard]] constexpr size_t getHeight() const noexcept
+    {
+      return Height;
+    }
+
+    [[nodiscard]] constexpr VkImage getPendingImg() noexcept
+    {
+      return PendingImg;
+    }
+
+    [[nodiscard]] constexpr Detail::TexFormat getFormat() const noexcept
+    {
+      return Format;
+    }
 
     [[nodiscard]] constexpr VkImageView getImgView() noexcept
     {
@@ -31,14 +113,21 @@ namespace Mvk::Engine
     }
 
   private:
-    uint32_t       MipLvl;
-    size_t         Width;
-    size_t         Height;
-    StagingBuffObj Stage;
-    VkImage        Img;
-    VkImageView    ImgView;
-    VkSampler      Sampler;
-    AllocationID   ID;
+    Allocator         Alloc;
+    Detail::TexFormat Format;
+    uint32_t          MipLvl;
+    uint32_t          FirstLvl;
+    bool              IsMipGenerated;
+    size_t            Width;
+    size_t            Height;
+    VkImage           Img;
+    VkImageView       ImgView;
+    VkSampler         Sampler;
+    AllocationID      ID;
+    // Between beginResidency and endResidency
+    VkImage           PendingImg;
+    AllocationID      PendingID;
+    uint32_t          PendingFirstLvl;
   };
 
 }  // namespace Mvk::Engine
@@ -0,0 +1,163 @@
+#include "Engine/ImmediateContext.hpp"
+
+#include "Engine/AllocatorContext.hpp"
+#include "Utility/Verify.hpp"
+
+#include <limits>
+
+namespace Mvk::Engine
+{
+  ImmediateContext::ImmediateContext( VkQueue Queue, QueueFamilyIdx FamilyIdx ) noexcept
+    : Queue( Queue ), CmdPool( VK_NULL_HANDLE ), Current( VK_NULL_HANDLE ), LastSubmitted( 0 ), LastDone( 0 )
+  {
+    auto CmdPoolCrtInfo             = VkCommandPoolCreateInfo();
+    CmdPoolCrtInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    CmdPoolCrtInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    CmdPoolCrtInfo.queueFamilyIndex = FamilyIdx;
+
+    auto const Result = vkCreateCommandPool( VulkanContext::the().getDevice(), &CmdPoolCrtInfo, nullptr, &CmdPool );
+    MVK_VERIFY( Result == VK_SUCCESS );
+  }
+
+  ImmediateContext::~ImmediateContext() noexcept
+  {
+    flush();
+    wait( LastSubmitted );
+
+    auto const Device = VulkanContext::the().getDevice();
+
+    for ( auto const Fence : FreeFences )
+    {
+      vkDestroyFence( Device, Fence, nullptr );
+    }
+
+    vkDestroyCommandPool( Device, CmdPool, nullptr );
+  }
+
+  [[nodiscard]] VkCommandBuffer ImmediateContext::getCmdBuff() noexcept
+  {
+    if ( Current != VK_NULL_HANDLE )
+    {
+      return Current;
+    }
+
+    reclaim();
+
+    if ( FreeCmdBuffs.empty() )
+    {
+      auto CmdBuffAllocInfo               = VkCommandBufferAllocateInfo();
+      CmdBuffAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      CmdBuffAllocInfo.commandPool        = CmdPool;
+      CmdBuffAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+      CmdBuffAllocInfo.commandBufferCount = 1;
+
+      auto const Result = vkAllocateCommandBuffers( VulkanContext::the().getDevice(), &CmdBuffAllocInfo, &Current );
+      MVK_VERIFY( Result == VK_SUCCESS );
+    }
+    else
+    {
+      Current = FreeCmdBuffs.back();
+      FreeCmdBuffs.pop_back();
+    }
+
+    auto CmdBuffBeginInfo             = VkCommandBufferBeginInfo();
+    CmdBuffBeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    CmdBuffBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    CmdBuffBeginInfo.pInheritanceInfo = nullptr;
+
+    vkBeginCommandBuffer( Current, &CmdBuffBeginInfo );
+
+    return Current;
+  }
+
+  ImmediateContext::Ticket ImmediateContext::flush() noexcept
+  {
+    if ( Current == VK_NULL_HANDLE )
+    {
+      return 0;
+    }
+
+    auto const Device = VulkanContext::the().getDevice();
+
+    vkEndCommandBuffer( Current );
+    AllocatorContext::the().flushMappedRanges();
+
+    auto Fence = VkFence( VK_NULL_HANDLE );
+
+    if ( FreeFences.empty() )
+    {
+      auto FenceCrtInfo  = VkFenceCreateInfo();
+      FenceCrtInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+      FenceCrtInfo.flags = 0;
+
+      auto const Result = vkCreateFence( Device, &FenceCrtInfo, nullptr, &Fence );
+      MVK_VERIFY( Result == VK_SUCCESS );
+    }
+    else
+    {
+      Fence = FreeFences.back();
+      FreeFences.pop_back();
+    }
+
+    auto SubmitInfo               = VkSubmitInfo();
+    SubmitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.commandBufferCount = 1;
+    SubmitInfo.pCommandBuffers    = &Current;
+
+    auto const Result = vkQueueSubmit( Queue, 1, &SubmitInfo, Fence );
+    MVK_VERIFY( Result == VK_SUCCESS );
+
+    InFlight.push_back( { Current, Fence, ++LastSubmitted } );
+    Current = VK_NULL_HANDLE;
+
+    return LastSubmitted;
+  }
+
+  void ImmediateContext::wait( Ticket Value ) noexcept
+  {
+    MVK_VERIFY( Value <= LastSubmitted );
+
+    if ( Value <= LastDone )
+    {
+      return;
+    }
+
+    // Fences signal in submission order, so the submission's own fence covers the earlier ones too
+    auto const & Waited = InFlight[Value - LastDone - 1];
+    vkWaitForFences( VulkanContext::the().getDevice(), 1, &Waited.Fence, VK_TRUE, std::numeric_limits<uint64_t>::max() );
+
+    while ( !InFlight.empty() && InFlight.front().Value <= Value )
+    {
+      retire();
+    }
+  }
+
+  [[nodiscard]] bool ImmediateContext::isDone( Ticket Value ) noexcept
+  {
+    reclaim();
+    return Value <= LastDone;
+  }
+
+  void ImmediateContext::reclaim() noexcept
+  {
+    auto const Device = VulkanContext::the().getDevice();
+
+    while ( !InFlight.empty() && vkGetFenceStatus( Device, InFlight.front().Fence ) == VK_SUCCESS )
+    {
+      retire();
+    }
+  }
+
+  void ImmediateContext::retire() noexcept
+  {
+    auto const & Done = InFlight.front();
+
+    vkResetFences( VulkanContext::the().getDevice(), 1, &Done.Fence );
+    FreeFences.push_back( Done.Fence );
+    FreeCmdBuffs.push_back( Done.CmdBuff );
+    LastDone = Done.Value;
+
+    InFlight.pop_front();
+  }
+
+}  // namespace Mvk::Engine
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Engine/VulkanContext.hpp"
+#include "Utility/Macros.hpp"
+
+#include <deque>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Engine
+{
+  // One-off work outside of the frames (layout transitions, copies, mip generation). Everything recorded between two
+  // flushes goes in the same submission, the command buffers and fences are reused once the submission that used them is
+  // done
+  class ImmediateContext
+  {
+  public:
+    // Increases with every flush, waiting on one also waits on every earlier one
+    using Ticket = uint64_t;
+
+    ImmediateContext( VkQueue Queue, QueueFamilyIdx FamilyIdx ) noexcept;
+    MVK_DEFINE_NON_COPYABLE( ImmediateContext );
+    MVK_DEFINE_NON_MOVABLE( ImmediateContext );
+    ~ImmediateContext() noexcept;
+
+    // Begins a command buffer if nothing was recorded since the last flush
+    [[nodiscard]] VkCommandBuffer getCmdBuff() noexcept;
+
+    // 0 when nothing was recorded
+    Ticket flush() noexcept;
+
+    void               wait( Ticket Value ) noexcept;
+    [[nodiscard]] bool isDone( Ticket Value ) noexcept;
+
+    // Recycles the command buffers and fences of finished submissions, never blocks
+    void reclaim() noexcept;
+
+  private:
+    struct Submission
+    {
+      VkCommandBuffer CmdBuff;
+      VkFence         Fence;
+      Ticket          Value;
+    };
+
+    void retire() noexcept;
+
+    VkQueue                      Queue;
+    VkCommandPool                CmdPool;
+    VkCommandBuffer              Current;
+    Ticket                       LastSubmitted;
+    Ticket                       LastDone;
+    std::deque<Submission>       InFlight;
+    std::vector<VkCommandBuffer> FreeCmdBuffs;
+    std::vector<VkFence>         FreeFences;
+  };
+
+}  // namespace Mvk::Engine
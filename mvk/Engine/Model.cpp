@@ -4,8 +4,14 @@
 
 namespace Mvk::Engine
 {
-  Model::Model( VkDeviceSize VtxSize, VkDeviceSize IdxSize, VkDeviceSize PvmSize, size_t TexWidth, size_t TexHeight ) noexcept
-    : Ubo( PvmSize ), Vbo( VtxSize ), Ibo( IdxSize ), Tex( TexWidth, TexHeight )
+  Model::Model( VkDeviceSize      VtxSize,
+                VkDeviceSize      IdxSize,
+                size_t            TexWidth,
+                size_t            TexHeight,
+                Detail::TexFormat TexFormat,
+                uint32_t          TexLvlCnt,
+                uint32_t          TexFirstLvl ) noexcept
+    : Vbo( VtxSize ), Ibo( IdxSize ), Tex( TexWidth, TexHeight, TexFormat, TexLvlCnt, TexFirstLvl ), Dequant(), TexSrc()
   {}
 
 }  // namespace Mvk::Engine
@@ -1,9 +1,10 @@
 #pragma once
 
+#include "Detail/Ktx2.hpp"
 #include "Engine/IdxBuffObj.hpp"
 #include "Engine/ImgObj.hpp"
-#include "Engine/UniformBuffObj.hpp"
 #include "Engine/VtxBuffObj.hpp"
+#include "ShaderTypes.hpp"
 #include "Utility/Badge.hpp"
 #include "Utility/Macros.hpp"
 
@@ -11,16 +12,34 @@ namespace Mvk::Engine
 {
   class VulkanRenderer;
 
+  using ModelID = size_t;
+
   struct Model
   {
   public:
     // All sizes in bytes
     // Take ownership of the DescSet
-    Model( VkDeviceSize VtxSize, VkDeviceSize IdxSize, VkDeviceSize PvmSize, size_t TexWidth, size_t TexHeight ) noexcept;
+    // TexLvlCnt 0 generates the mips of an RGBA8 texture, see ImgObj
+    Model( VkDeviceSize      VtxSize,
+           VkDeviceSize      IdxSize,
+           size_t            TexWidth,
+           size_t            TexHeight,
+           Detail::TexFormat TexFormat   = Detail::TexFormat::Rgba8,
+           uint32_t          TexLvlCnt   = 0,
+           uint32_t          TexFirstLvl = 0 ) noexcept;
+
+    // A model that didn't fit has to be destroyed, whatever did fit is given back then
+    [[nodiscard]] constexpr bool getIsAllocated() const noexcept
+    {
+      return Vbo.getIsAllocated() && Ibo.getIsAllocated() && Tex.getIsAllocated();
+    }
 
-    UniformBuffObj Ubo;
-    VtxBuffObj     Vbo;
-    IdxBuffObj     Ibo;
-    ImgObj         Tex;
+    VtxBuffObj      Vbo;
+    IdxBuffObj      Ibo;
+    ImgObj          Tex;
+    // Of the packed vertices in Vbo
+    pos_dequant     Dequant;
+    // Where the levels that aren't resident come from, no levels when the texture is always fully resident
+    Detail::TexView TexSrc;
   };
 }  // namespace Mvk::Engine
\ No newline at end of file
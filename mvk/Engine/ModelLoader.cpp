@@ -0,0 +1,189 @@
+#include "Engine/ModelLoader.hpp"
+
+#include "Detail/Misc.hpp"
+#include "Detail/MipChain.hpp"
+#include "Detail/Readers.hpp"
+
+namespace Mvk::Engine
+{
+  [[nodiscard]] ModelData readModelData( ModelPaths const & Paths, TexFormatMask TexFormats, Detail::AssetCache const * Cache ) noexcept
+  {
+    auto Data = ModelData();
+
+    // Written by tex-encoder with the whole mip chain, the levels point straight into the mapping
+    auto Tex = Detail::readKtx2( Paths.CompressedTex );
+
+    if ( Tex.has_value() && TexFormats.test( static_cast<size_t>( Tex->Format ) ) )
+    {
+      Data.Tex = std::move( *Tex );
+    }
+    else
+    {
+      auto const TexKey = Cache != nullptr ? Cache->getKey( Paths.Tex, Detail::AssetKind::Tex ) : std::nullopt;
+
+      if ( TexKey.has_value() )
+      {
+        Tex = Cache->findTex( *TexKey );
+      }
+
+      if ( !Tex.has_value() )
+      {
+        auto [Texture, Width, Height] = Detail::loadTex( Paths.Tex );
+
+        // The mips are made here instead of on the GPU so they can be stored, then everything is mapped back like a hit.
+        // The pages are still in memory, so it costs little more than keeping the levels around
+        if ( TexKey.has_value() && Cache->storeTex( *TexKey, Width, Height, Detail::genMipChain( Texture, Width, Height ) ) )
+        {
+          Tex = Cache->findTex( *TexKey );
+        }
+
+        if ( !Tex.has_value() )
+        {
+          Data.TexPixels = std::move( Texture );
+          Tex = Detail::TexView{ nullptr, Detail::TexFormat::Rgba8, Width, Height, { std::as_bytes( std::span( Data.TexPixels ) ) } };
+        }
+      }
+
+      Data.Tex = std::move( *Tex );
+    }
+
+    // Written by mesh-converter, the spans point straight into the mapping. Skipped when it has other vertices than the
+    // layout reads or was made from another version of the OBJ. The OBJ is only read when its size or write time changed,
+    // a copy or a checkout of the same file still matches the hash. Without the OBJ the .mvkm is taken as is
+    auto const ObjStamp = Detail::getFileStamp( Paths.Obj );
+    auto       ObjHash  = std::optional<uint64_t>();
+    auto       Mesh     = Detail::readMesh( Paths.Mesh, ModelVtxLayout::Stride );
+
+    if ( Mesh.has_value() && ObjStamp.has_value() && Mesh->SrcStamp != *ObjStamp )
+    {
+      ObjHash = Detail::hashSrc( Paths.Obj, Detail::AssetKind::Mesh, ModelVtxLayout::Stride );
+    }
+
+    if ( Mesh.has_value() && ( !ObjStamp.has_value() || Mesh->SrcStamp == *ObjStamp || Mesh->SrcHash == ObjHash ) )
+    {
+      Data.Mesh = std::move( *Mesh );
+      return Data;
+    }
+
+    if ( Cache != nullptr && !ObjHash.has_value() )
+    {
+      ObjHash = Detail::hashSrc( Paths.Obj, Detail::AssetKind::Mesh, ModelVtxLayout::Stride );
+    }
+
+    // Same format as above, written by the first run that parsed this OBJ. The key is the same hash
+    auto const MeshKey = Cache != nullptr ? ObjHash : std::nullopt;
+    Mesh               = std::nullopt;
+
+    if ( MeshKey.has_value() )
+    {
+      Mesh = Cache->findMesh( *MeshKey, ModelVtxLayout::Stride );
+    }
+
+    if ( Mesh.has_value() )
+    {
+      Data.Mesh = std::move( *Mesh );
+      return Data;
+    }
+
+    auto [Vtx, Idx] = Detail::readObj( Paths.Obj );
+    Data.ObjVtxs    = Detail::buildVtxs<ModelVtxLayout::Vertex>( Vtx );
+    Data.ObjIdxs    = std::move( Idx );
+
+    Data.Mesh = Detail::MeshView{ nullptr,
+                                  std::as_bytes( std::span( Data.ObjVtxs.Vtxs ) ),
+                                  Data.ObjIdxs,
+                                  static_cast<uint32_t>( std::size( Data.ObjVtxs.Vtxs ) ),
+                                  Data.ObjVtxs.Dequant,
+                                  ObjHash.value_or( 0 ),
+                                  ObjStamp.value_or( Detail::FileStamp() ) };
+
+    if ( MeshKey.has_value() )
+    {
+      static_cast<void>( Cache->storeMesh( *MeshKey, Data.Mesh ) );
+    }
+
+    return Data;
+  }
+
+  ModelLoader::ModelLoader( uint32_t WorkerCnt, TexFormatMask TexFormats, std::filesystem::path const & CacheDir ) noexcept
+    : TexFormats( TexFormats ), IsStopping( false )
+  {
+    if ( !CacheDir.empty() )
+    {
+      Cache.emplace( CacheDir );
+    }
+
+    Workers.reserve( WorkerCnt );
+
+    for ( auto Idx = uint32_t( 0 ); Idx < WorkerCnt; ++Idx )
+    {
+      Workers.emplace_back( [this] { work(); } );
+    }
+  }
+
+  ModelLoader::~ModelLoader() noexcept
+  {
+    {
+      auto Lock  = std::scoped_lock( Mtx );
+      IsStopping = true;
+    }
+
+    HasRequests.notify_all();
+
+    for ( auto & Worker : Workers )
+    {
+      Worker.join();
+    }
+  }
+
+  void ModelLoader::push( ModelID ID, ModelPaths Paths ) noexcept
+  {
+    {
+      auto Lock = std::scoped_lock( Mtx );
+      Requests.push_back( { ID, std::move( Paths ) } );
+    }
+
+    HasRequests.notify_one();
+  }
+
+  [[nodiscard]] std::optional<ModelLoader::Result> ModelLoader::pop() noexcept
+  {
+    auto Lock = std::scoped_lock( Mtx );
+
+    if ( Results.empty() )
+    {
+      return std::nullopt;
+    }
+
+    auto Front = std::move( Results.front() );
+    Results.pop_front();
+    return Front;
+  }
+
+  void ModelLoader::work() noexcept
+  {
+    while ( true )
+    {
+      auto Current = Request();
+
+      {
+        auto Lock = std::unique_lock( Mtx );
+        HasRequests.wait( Lock, [this] { return IsStopping || !Requests.empty(); } );
+
+        if ( IsStopping )
+        {
+          return;
+        }
+
+        Current = std::move( Requests.front() );
+        Requests.pop_front();
+      }
+
+      auto Data = readModelData( Current.Paths, TexFormats, getCache() );
+
+      auto Lock = std::scoped_lock( Mtx );
+      Results.push_back( { Current.ID, std::move( Data ) } );
+    }
+  }
+
+}  // namespace Mvk::Engine
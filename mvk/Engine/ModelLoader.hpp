@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Detail/AssetCache.hpp"
+#include "Detail/Ktx2.hpp"
+#include "Detail/MeshFile.hpp"
+#include "Detail/VtxPack.hpp"
+#include "Engine/VtxLayout.hpp"
+#include "Engine/Model.hpp"
+#include "Utility/Macros.hpp"
+
+#include <bitset>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace Mvk::Engine
+{
+  struct ModelPaths
+  {
+    // Tried first, the OBJ is only parsed when it's missing or from another version and the cache doesn't have it
+    std::filesystem::path Mesh;
+    std::filesystem::path Obj;
+    // Same, the PNG is the fallback for a missing KTX2 or one in a format the device can't sample
+    std::filesystem::path CompressedTex;
+    std::filesystem::path Tex;
+  };
+
+  // Everything loadModel needs before touching the GPU
+  struct ModelData
+  {
+    // Points into ObjVtxs and ObjIdxs when the OBJ was parsed, moving the vectors keeps their storage so the spans
+    // survive moving the whole struct
+    Detail::MeshView                         Mesh;
+    Detail::MeshVtxs<ModelVtxLayout::Vertex> ObjVtxs;
+    std::vector<uint32_t>                    ObjIdxs;
+    // Every level of the KTX2 or of the cached PNG, or only the first one of the PNG in TexPixels, same as above
+    Detail::TexView                          Tex;
+    std::vector<unsigned char>               TexPixels;
+  };
+
+  using TexFormatMask = std::bitset<Detail::TexFormatCnt>;
+
+  // File IO, decoding and parsing, safe to call from any thread. TexFormats are the formats the KTX2 can be in, indexed by
+  // Detail::TexFormat. Without a cache the OBJ and the PNG are processed every time
+  [[nodiscard]] ModelData
+    readModelData( ModelPaths const & Paths, TexFormatMask TexFormats, Detail::AssetCache const * Cache = nullptr ) noexcept;
+
+  // Runs readModelData on worker threads. The results are collected by the render thread, which does the uploads
+  class ModelLoader
+  {
+  public:
+    struct Result
+    {
+      ModelID   ID;
+      ModelData Data;
+    };
+
+    // An empty CacheDir disables the cache
+    ModelLoader( uint32_t WorkerCnt, TexFormatMask TexFormats, std::filesystem::path const & CacheDir ) noexcept;
+    MVK_DEFINE_NON_COPYABLE( ModelLoader );
+    MVK_DEFINE_NON_MOVABLE( ModelLoader );
+    // Requests nobody started on are dropped, the ones in progress are waited on
+    ~ModelLoader() noexcept;
+
+    void push( ModelID ID, ModelPaths Paths ) noexcept;
+
+    // Oldest finished request, never blocks
+    [[nodiscard]] std::optional<Result> pop() noexcept;
+
+    [[nodiscard]] TexFormatMask getTexFormats() const noexcept
+    {
+      return TexFormats;
+    }
+
+    [[nodiscard]] Detail::AssetCache const * getCache() const noexcept
+    {
+      return Cache.has_value() ? &*Cache : nullptr;
+    }
+
+  private:
+    struct Request
+    {
+      ModelID    ID;
+      ModelPaths Paths;
+    };
+
+    void work() noexcept;
+
+    // Never change, the workers read them without the lock
+    TexFormatMask                     TexFormats;
+    std::optional<Detail::AssetCache> Cache;
+    std::mutex                        Mtx;
+    std::condition_variable           HasRequests;
+    std::deque<Request>               Requests;
+    std::deque<Result>                Results;
+    bool                              IsStopping;
+    std::vector<std::thread>          Workers;
+  };
+
+}  // namespace Mvk::Engine
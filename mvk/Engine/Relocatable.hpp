@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Engine
+{
+  struct Allocation;
+
+  // Owners of GpuOnly allocations that AllocatorContext::defragment is allowed to move
+  class Relocatable
+  {
+  public:
+    // Record the copy of the contents into NewAlloc and switch over to it, the old Vulkan objects go to the garbage queue.
+    // The old allocation is freed by the allocator once the GPU is done with it
+    virtual void relocate( VkCommandBuffer CmdBuff, Allocation const & NewAlloc ) noexcept = 0;
+
+  protected:
+    Relocatable() noexcept  = default;
+    ~Relocatable() noexcept = default;
+  };
+
+}  // namespace Mvk::Engine
@@ -0,0 +1,344 @@
+#include "Engine/StagingRing.hpp"
+
+#include "Detail/Misc.hpp"
+#include "Engine/VulkanContext.hpp"
+
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace Mvk::Engine
+{
+  StagingRing::StagingRing( VkDeviceSize Size, Allocator Alloc ) noexcept
+    : Alloc( Alloc ), Buff( VK_NULL_HANDLE ), BuffOff( 0 ), Data( nullptr ), Size( Size ), Head( 0 ), Tail( 0 )
+  {
+    auto Allocation = Alloc.allocate( AllocationType::CpuToGpu, BufferClass::Staging, Size, DefaultAlignment );
+    MVK_VERIFY( Allocation.has_value() );
+
+    Buff    = Allocation->Buff;
+    BuffOff = Allocation->Off;
+    Data    = Allocation->Data;
+    ID      = Allocation->ID;
+  }
+
+  StagingRing::~StagingRing() noexcept
+  {
+    auto const Device = VulkanContext::the().getDevice();
+
+    for ( auto & Pending : Batches )
+    {
+      vkWaitForFences( Device, 1, &Pending.Fence, VK_TRUE, std::numeric_limits<uint64_t>::max() );
+      retire( Pending );
+    }
+
+    // Never submitted, so nothing can be reading them
+    for ( auto const Overflow : Overflows )
+    {
+      Alloc.free( Overflow );
+    }
+
+    for ( auto const & Imported : Imports )
+    {
+      dstrImport( Imported );
+    }
+
+    for ( auto const Fence : FreeFences )
+    {
+      vkDestroyFence( Device, Fence, nullptr );
+    }
+
+    Alloc.free( ID );
+  }
+
+  [[nodiscard]] StagingRing::AllocResult StagingRing::allocate( VkDeviceSize AllocSize, VkDeviceSize Alignment ) noexcept
+  {
+    auto const Device = VulkanContext::the().getDevice();
+
+    while ( true )
+    {
+      if ( auto const Allocated = allocateRing( AllocSize, Alignment ); Allocated.has_value() )
+      {
+        return *Allocated;
+      }
+
+      if ( Batches.empty() )
+      {
+        break;
+      }
+
+      // The oldest batch sits right after the head, so it's the one in the way
+      auto & Oldest = Batches.front();
+      vkWaitForFences( Device, 1, &Oldest.Fence, VK_TRUE, std::numeric_limits<uint64_t>::max() );
+      retire( Oldest );
+      Batches.pop_front();
+    }
+
+    // Bigger than what the ring can hold, or the open batch alone already fills it
+    auto Allocation = Alloc.allocate( AllocationType::CpuToGpu, BufferClass::Staging, AllocSize, Alignment );
+    MVK_VERIFY( Allocation.has_value() );
+
+    // Queued ahead of the write, it only goes out with the submission anyway
+    Alloc.flush( Allocation->ID, 0, AllocSize );
+
+    Overflows.push_back( Allocation->ID );
+    return { Allocation->Buff, Allocation->Off, Allocation->Data };
+  }
+
+  [[nodiscard]] StagingRing::AllocResult
+    StagingRing::stage( std::shared_ptr<Detail::MappedFile const> File, size_t Off, size_t Size ) noexcept
+  {
+    MVK_VERIFY( Off <= File->getSize() && Size <= File->getSize() - Off );
+
+    if ( auto const Imported = importFile( File, Off, Size ); Imported.has_value() )
+    {
+      return *Imported;
+    }
+
+    // Faulting the pages in straight from the mapping, there's no copy in between
+    auto const Staged = allocate( Size );
+    std::memcpy( Staged.Data, std::data( File->getData() ) + Off, Size );
+
+    return Staged;
+  }
+
+  void StagingRing::copyTo( VkCommandBuffer CmdBuff, std::span<std::byte const> Src, VkBuffer ToBuff, VkDeviceSize ToOff ) noexcept
+  {
+    auto const Staged = allocate( std::size( Src ) );
+    std::memcpy( Staged.Data, std::data( Src ), std::size( Src ) );
+
+    copyTo( CmdBuff, Staged, std::size( Src ), ToBuff, ToOff );
+  }
+
+  void StagingRing::copyTo(
+    VkCommandBuffer CmdBuff, std::span<std::byte const> Src, VkImage ToImg, size_t Width, size_t Height, uint32_t MipLvl ) noexcept
+  {
+    auto const Staged = allocate( std::size( Src ) );
+    std::memcpy( Staged.Data, std::data( Src ), std::size( Src ) );
+
+    copyTo( CmdBuff, Staged, ToImg, Width, Height, MipLvl );
+  }
+
+  void StagingRing::copyTo(
+    VkCommandBuffer CmdBuff, AllocResult const & From, VkDeviceSize CopySize, VkBuffer ToBuff, VkDeviceSize ToOff ) noexcept
+  {
+    auto CopyRegion      = VkBufferCopy();
+    CopyRegion.srcOffset = From.Off;
+    CopyRegion.dstOffset = ToOff;
+    CopyRegion.size      = CopySize;
+
+    vkCmdCopyBuffer( CmdBuff, From.Buff, ToBuff, 1, &CopyRegion );
+  }
+
+  void StagingRing::copyTo(
+    VkCommandBuffer CmdBuff, AllocResult const & From, VkImage ToImg, size_t Width, size_t Height, uint32_t MipLvl ) noexcept
+  {
+    auto CopyRegion                            = VkBufferImageCopy();
+    CopyRegion.bufferOffset                    = From.Off;
+    CopyRegion.bufferRowLength                 = 0;
+    CopyRegion.bufferImageHeight               = 0;
+    CopyRegion.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    CopyRegion.imageSubresource.mipLevel       = MipLvl;
+    CopyRegion.imageSubresource.baseArrayLayer = 0;
+    CopyRegion.imageSubresource.layerCount     = 1;
+    CopyRegion.imageOffset.x                   = 0;
+    CopyRegion.imageOffset.y                   = 0;
+    CopyRegion.imageOffset.z                   = 0;
+    CopyRegion.imageExtent.width               = Width;
+    CopyRegion.imageExtent.height              = Height;
+    CopyRegion.imageExtent.depth               = 1;
+
+    vkCmdCopyBufferToImage( CmdBuff, From.Buff, ToImg, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &CopyRegion );
+  }
+
+  [[nodiscard]] VkFence StagingRing::endBatch() noexcept
+  {
+    auto Fence = VkFence( VK_NULL_HANDLE );
+
+    if ( FreeFences.empty() )
+    {
+      auto FenceCrtInfo  = VkFenceCreateInfo();
+      FenceCrtInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+      FenceCrtInfo.flags = 0;
+
+      auto const Result = vkCreateFence( VulkanContext::the().getDevice(), &FenceCrtInfo, nullptr, &Fence );
+      MVK_VERIFY( Result == VK_SUCCESS );
+    }
+    else
+    {
+      Fence = FreeFences.back();
+      FreeFences.pop_back();
+    }
+
+    Batches.push_back( { Head, Fence, std::move( Overflows ), std::move( Imports ) } );
+    Overflows.clear();
+    Imports.clear();
+
+    return Fence;
+  }
+
+  void StagingRing::reclaim() noexcept
+  {
+    auto const Device = VulkanContext::the().getDevice();
+
+    while ( !Batches.empty() && vkGetFenceStatus( Device, Batches.front().Fence ) == VK_SUCCESS )
+    {
+      retire( Batches.front() );
+      Batches.pop_front();
+    }
+  }
+
+  [[nodiscard]] std::optional<StagingRing::AllocResult> StagingRing::allocateRing( VkDeviceSize AllocSize,
+                                                                                    VkDeviceSize Alignment ) noexcept
+  {
+    // Alignment is relative to the start of the buffer, which is what the copies see
+    auto const Pos     = Head % Size;
+    auto       Padding = Detail::alignedSize( BuffOff + Pos, Alignment ) - ( BuffOff + Pos );
+
+    // Ranges never wrap around, skip to the start of the ring instead
+    if ( Pos + Padding + AllocSize > Size )
+    {
+      Padding = Size - Pos + Detail::alignedSize( BuffOff, Alignment ) - BuffOff;
+    }
+
+    auto const Start = Head + Padding;
+    auto const End   = Start + AllocSize;
+
+    if ( End - Tail > Size )
+    {
+      return std::nullopt;
+    }
+
+    Head = End;
+
+    auto const Off = Start % Size;
+    Alloc.flush( ID, Off, AllocSize );
+
+    return AllocResult{ Buff, BuffOff + Off, Data + Off };
+  }
+
+  [[nodiscard]] std::optional<StagingRing::AllocResult>
+    StagingRing::importFile( std::shared_ptr<Detail::MappedFile const> const & File, size_t Off, size_t Size ) noexcept
+  {
+    auto const & Ctx = VulkanContext::the();
+
+    if ( !Ctx.getHasHostImport() || Size < MinImportSize )
+    {
+      return std::nullopt;
+    }
+
+    // Sections of a file staged together, like the vertices and the indices of a mesh, share one import
+    for ( auto const & Imported : Imports )
+    {
+      if ( Imported.File == File && Imported.Off <= Off && Off + Size <= Imported.Off + Imported.Size )
+      {
+        return AllocResult{ Imported.Buff, Off - Imported.Off, nullptr };
+      }
+    }
+
+    // Mappings start at a page, which is usually all the alignment the import asks for. The range gets widened to it on
+    // both ends, the tail of the last page is still part of the mapping
+    auto const Alignment  = Ctx.getHostImportAlignment();
+    auto const ImportOff  = Off - Off % Alignment;
+    auto const ImportSize = Detail::alignedSize( Off + Size - ImportOff, Alignment );
+
+    if ( reinterpret_cast<uintptr_t>( std::data( File->getData() ) ) % Alignment != 0 || ImportOff + ImportSize > File->getMappedSize() )
+    {
+      return std::nullopt;
+    }
+
+    auto const   Device  = Ctx.getDevice();
+    auto * const HostPtr = const_cast<std::byte *>( std::data( File->getData() ) + ImportOff );
+
+    auto const GetHostPtrProps = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+      vkGetDeviceProcAddr( Device, "vkGetMemoryHostPointerPropertiesEXT" ) );
+
+    auto HostPtrProps  = VkMemoryHostPointerPropertiesEXT();
+    HostPtrProps.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+
+    auto Result = GetHostPtrProps( Device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, HostPtr, &HostPtrProps );
+
+    if ( Result != VK_SUCCESS )
+    {
+      return std::nullopt;
+    }
+
+    auto ExternalBuffCrtInfo        = VkExternalMemoryBufferCreateInfo();
+    ExternalBuffCrtInfo.sType       = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+    ExternalBuffCrtInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+
+    auto BuffCrtInfo        = VkBufferCreateInfo();
+    BuffCrtInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BuffCrtInfo.pNext       = &ExternalBuffCrtInfo;
+    BuffCrtInfo.size        = ImportSize;
+    BuffCrtInfo.usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    BuffCrtInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    auto ImportBuff = VkBuffer( VK_NULL_HANDLE );
+    Result          = vkCreateBuffer( Device, &BuffCrtInfo, nullptr, &ImportBuff );
+    MVK_VERIFY( Result == VK_SUCCESS );
+
+    auto MemReqs = VkMemoryRequirements();
+    vkGetBufferMemoryRequirements( Device, ImportBuff, &MemReqs );
+
+    auto const MemTypeBits = MemReqs.memoryTypeBits & HostPtrProps.memoryTypeBits;
+
+    if ( MemTypeBits == 0 )
+    {
+      vkDestroyBuffer( Device, ImportBuff, nullptr );
+      return std::nullopt;
+    }
+
+    auto ImportInfo         = VkImportMemoryHostPointerInfoEXT();
+    ImportInfo.sType        = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+    ImportInfo.handleType   = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+    ImportInfo.pHostPointer = HostPtr;
+
+    auto MemAllocInfo            = VkMemoryAllocateInfo();
+    MemAllocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    MemAllocInfo.pNext           = &ImportInfo;
+    MemAllocInfo.allocationSize  = ImportSize;
+    MemAllocInfo.memoryTypeIndex = static_cast<uint32_t>( std::countr_zero( MemTypeBits ) );
+
+    auto Mem = VkDeviceMemory( VK_NULL_HANDLE );
+    Result   = vkAllocateMemory( Device, &MemAllocInfo, nullptr, &Mem );
+
+    // Not every driver can pin file backed pages, the copy still works
+    if ( Result != VK_SUCCESS )
+    {
+      vkDestroyBuffer( Device, ImportBuff, nullptr );
+      return std::nullopt;
+    }
+
+    Result = vkBindBufferMemory( Device, ImportBuff, Mem, 0 );
+    MVK_VERIFY( Result == VK_SUCCESS );
+
+    Imports.push_back( { ImportBuff, Mem, File, ImportOff, ImportSize } );
+    return AllocResult{ ImportBuff, Off - ImportOff, nullptr };
+  }
+
+  void StagingRing::retire( Batch & Retired ) noexcept
+  {
+    Tail = Retired.End;
+
+    for ( auto const Overflow : Retired.Overflows )
+    {
+      Alloc.free( Overflow );
+    }
+
+    for ( auto const & Imported : Retired.Imports )
+    {
+      dstrImport( Imported );
+    }
+
+    vkResetFences( VulkanContext::the().getDevice(), 1, &Retired.Fence );
+    FreeFences.push_back( Retired.Fence );
+  }
+
+  void StagingRing::dstrImport( Import const & Imported ) noexcept
+  {
+    auto const Device = VulkanContext::the().getDevice();
+    vkDestroyBuffer( Device, Imported.Buff, nullptr );
+    vkFreeMemory( Device, Imported.Mem, nullptr );
+  }
+
+}  // namespace Mvk::Engine
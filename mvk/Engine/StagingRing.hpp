@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Detail/MappedFile.hpp"
+#include "Engine/Allocator.hpp"
+#include "Utility/Macros.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Engine
+{
+  // Persistently mapped staging buffer shared by every upload. Ranges are handed out in order and grouped in batches, a
+  // batch is closed by the submission that reads it and its ranges are recycled once that submission's fence signals
+  class StagingRing
+  {
+  public:
+    struct AllocResult
+    {
+      VkBuffer     Buff;
+      VkDeviceSize Off;
+      // Null for imported files
+      std::byte *  Data;
+    };
+
+    explicit StagingRing( VkDeviceSize Size, Allocator Alloc = Allocator() ) noexcept;
+    MVK_DEFINE_NON_COPYABLE( StagingRing );
+    MVK_DEFINE_NON_MOVABLE( StagingRing );
+    ~StagingRing() noexcept;
+
+    // Waits on older batches when the ring is full, uploads that can't fit even then get their own staging range
+    [[nodiscard]] AllocResult allocate( VkDeviceSize AllocSize, VkDeviceSize Alignment = DefaultAlignment ) noexcept;
+
+    // Stages Size bytes of File from Off for the copies of the open batch without reading them into memory first. Big
+    // sections are imported with VK_EXT_external_memory_host and read by the GPU straight from the page cache, anything
+    // else is copied from the mapping into the ring. Imported files stay mapped until the batch is done
+    [[nodiscard]] AllocResult stage( std::shared_ptr<Detail::MappedFile const> File, size_t Off, size_t Size ) noexcept;
+
+    void copyTo( VkCommandBuffer CmdBuff, std::span<std::byte const> Src, VkBuffer ToBuff, VkDeviceSize ToOff ) noexcept;
+    // Width and Height are the ones of level MipLvl
+    void copyTo(
+      VkCommandBuffer CmdBuff, std::span<std::byte const> Src, VkImage ToImg, size_t Width, size_t Height, uint32_t MipLvl = 0 ) noexcept;
+
+    // From something already staged, From.Off is where the copy starts
+    void copyTo( VkCommandBuffer CmdBuff, AllocResult const & From, VkDeviceSize CopySize, VkBuffer ToBuff, VkDeviceSize ToOff ) noexcept;
+    void copyTo(
+      VkCommandBuffer CmdBuff, AllocResult const & From, VkImage ToImg, size_t Width, size_t Height, uint32_t MipLvl = 0 ) noexcept;
+
+    // Closes the batch with everything allocated since the last call, the returned fence has to be passed to the submission
+    // that reads it
+    [[nodiscard]] VkFence endBatch() noexcept;
+
+    // Recycles the batches whose fence already signaled, never blocks
+    void reclaim() noexcept;
+
+    [[nodiscard]] constexpr VkDeviceSize getSize() const noexcept;
+
+  private:
+    // Buffer to image copies need offsets aligned to the texel size
+    static constexpr VkDeviceSize DefaultAlignment = 16;
+    // Below this a copy through the ring is cheaper than creating a buffer and pinning the pages
+    static constexpr VkDeviceSize MinImportSize    = 4 * 1024 * 1024;
+
+    struct Import
+    {
+      VkBuffer                                  Buff;
+      VkDeviceMemory                            Mem;
+      std::shared_ptr<Detail::MappedFile const> File;
+      // Range of the file the buffer starts at and covers
+      size_t                                    Off;
+      size_t                                    Size;
+    };
+
+    struct Batch
+    {
+      VkDeviceSize              End;
+      VkFence                   Fence;
+      std::vector<AllocationID> Overflows;
+      std::vector<Import>       Imports;
+    };
+
+    [[nodiscard]] std::optional<AllocResult> allocateRing( VkDeviceSize AllocSize, VkDeviceSize Alignment ) noexcept;
+    [[nodiscard]] std::optional<AllocResult>
+      importFile( std::shared_ptr<Detail::MappedFile const> const & File, size_t Off, size_t Size ) noexcept;
+    void                                     retire( Batch & Retired ) noexcept;
+    void                                     dstrImport( Import const & Imported ) noexcept;
+
+    Allocator                 Alloc;
+    VkBuffer                  Buff;
+    VkDeviceSize              BuffOff;
+    std::byte *               Data;
+    AllocationID              ID;
+    VkDeviceSize              Size;
+    // Both keep growing, the offset in the ring is them modulo Size
+    VkDeviceSize              Head;
+    VkDeviceSize              Tail;
+    std::deque<Batch>         Batches;
+    std::vector<AllocationID> Overflows;
+    std::vector<Import>       Imports;
+    std::vector<VkFence>      FreeFences;
+  };
+
+  [[nodiscard]] constexpr VkDeviceSize StagingRing::getSize() const noexcept
+  {
+    return Size;
+  }
+
+}  // namespace Mvk::Engine
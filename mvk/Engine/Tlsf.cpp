@@ -0,0 +1,319 @@
+#include "Engine/Tlsf.hpp"
+
+#include "Utility/Verify.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace Mvk::Engine
+{
+  namespace Detail
+  {
+    [[nodiscard]] constexpr VkDeviceSize alignedOff( VkDeviceSize Off, VkDeviceSize Alignment ) noexcept
+    {
+      if ( auto Mod = Off % Alignment; Mod != 0 )
+      {
+        return Off + Alignment - Mod;
+      }
+
+      return Off;
+    }
+
+  }  // namespace Detail
+
+  Tlsf::Tlsf( VkDeviceSize Size ) noexcept : Size( Size ), Used( 0 ), AllocCnt( 0 ), FLBitmap( 0 ), SLBitmaps()
+  {
+    for ( auto & SLHeads : Heads )
+    {
+      SLHeads.fill( NullRange );
+    }
+
+    // The first node always starts at offset 0, coalescing keeps the lower node so it never goes away
+    auto const ID = acquireNode();
+    Nodes[ID]     = { 0, Size, NullRange, NullRange, NullRange, NullRange, true };
+    insertFree( ID );
+  }
+
+  [[nodiscard]] Tlsf::Idx Tlsf::mapping( VkDeviceSize Size ) noexcept
+  {
+    if ( Size < SmallSize )
+    {
+      return { 0, static_cast<uint32_t>( Size / ( SmallSize / SLCount ) ) };
+    }
+
+    auto const Log2 = static_cast<uint32_t>( std::bit_width( Size ) - 1 );
+    auto const FL   = Log2 - SmallShift + 1;
+    auto const SL   = static_cast<uint32_t>( Size >> ( Log2 - SLBits ) ) ^ SLCount;
+    return { FL, SL };
+  }
+
+  [[nodiscard]] Tlsf::Idx Tlsf::mappingRoundUp( VkDeviceSize Size ) noexcept
+  {
+    // Round up to the next list so that any range found in it is big enough
+    if ( Size < SmallSize )
+    {
+      Size += ( SmallSize / SLCount ) - 1;
+    }
+    else
+    {
+      auto const Log2 = static_cast<uint32_t>( std::bit_width( Size ) - 1 );
+      Size += ( VkDeviceSize( 1 ) << ( Log2 - SLBits ) ) - 1;
+    }
+
+    return mapping( Size );
+  }
+
+  [[nodiscard]] VkDeviceSize Tlsf::getMinSize( VkDeviceSize AllocSize, VkDeviceSize Alignment ) noexcept
+  {
+    return AllocSize + Alignment - 1;
+  }
+
+  [[nodiscard]] Tlsf::RangeID Tlsf::findSuitable( Idx Start ) const noexcept
+  {
+    auto FL    = Start.FL;
+    auto SLMap = SLBitmaps[FL] & ( ~0U << Start.SL );
+
+    if ( SLMap == 0 )
+    {
+      auto const FLMap = FL + 1 < FLCount ? FLBitmap & ( ~uint64_t( 0 ) << ( FL + 1 ) ) : uint64_t( 0 );
+
+      if ( FLMap == 0 )
+      {
+        return NullRange;
+      }
+
+      FL    = static_cast<uint32_t>( std::countr_zero( FLMap ) );
+      SLMap = SLBitmaps[FL];
+    }
+
+    auto const SL = static_cast<uint32_t>( std::countr_zero( SLMap ) );
+    return Heads[FL][SL];
+  }
+
+  [[nodiscard]] Tlsf::RangeID Tlsf::findInList( Idx List, VkDeviceSize Size ) const noexcept
+  {
+    for ( auto ID = Heads[List.FL][List.SL]; ID != NullRange; ID = Nodes[ID].NextFree )
+    {
+      if ( Nodes[ID].Size >= Size )
+      {
+        return ID;
+      }
+    }
+
+    return NullRange;
+  }
+
+  [[nodiscard]] Tlsf::RangeID Tlsf::acquireNode() noexcept
+  {
+    if ( !FreeNodes.empty() )
+    {
+      auto const ID = FreeNodes.back();
+      FreeNodes.pop_back();
+      return ID;
+    }
+
+    Nodes.emplace_back();
+    return static_cast<RangeID>( std::size( Nodes ) - 1 );
+  }
+
+  void Tlsf::releaseNode( RangeID ID ) noexcept
+  {
+    FreeNodes.push_back( ID );
+  }
+
+  void Tlsf::insertFree( RangeID ID ) noexcept
+  {
+    auto const [FL, SL] = mapping( Nodes[ID].Size );
+    auto &     Current  = Nodes[ID];
+    auto &     Head     = Heads[FL][SL];
+
+    Current.IsFree   = true;
+    Current.PrevFree = NullRange;
+    Current.NextFree = Head;
+
+    if ( Head != NullRange )
+    {
+      Nodes[Head].PrevFree = ID;
+    }
+
+    Head = ID;
+    FLBitmap |= uint64_t( 1 ) << FL;
+    SLBitmaps[FL] |= 1U << SL;
+  }
+
+  void Tlsf::removeFree( RangeID ID ) noexcept
+  {
+    auto & Current = Nodes[ID];
+
+    if ( Current.PrevFree != NullRange )
+    {
+      Nodes[Current.PrevFree].NextFree = Current.NextFree;
+    }
+
+    if ( Current.NextFree != NullRange )
+    {
+      Nodes[Current.NextFree].PrevFree = Current.PrevFree;
+    }
+
+    auto const [FL, SL] = mapping( Current.Size );
+    auto &     Head     = Heads[FL][SL];
+
+    if ( Head == ID )
+    {
+      Head = Current.NextFree;
+
+      if ( Head == NullRange )
+      {
+        SLBitmaps[FL] &= ~( 1U << SL );
+
+        if ( SLBitmaps[FL] == 0 )
+        {
+          FLBitmap &= ~( uint64_t( 1 ) << FL );
+        }
+      }
+    }
+
+    Current.IsFree   = false;
+    Current.PrevFree = NullRange;
+    Current.NextFree = NullRange;
+  }
+
+  [[nodiscard]] std::optional<Tlsf::Allocation> Tlsf::allocate( VkDeviceSize AllocSize, VkDeviceSize Alignment ) noexcept
+  {
+    MVK_VERIFY( AllocSize != 0 );
+    MVK_VERIFY( Alignment != 0 );
+
+    // Worst case the range starts right after an aligned offset
+    auto const SearchSize = AllocSize + Alignment - 1;
+
+    if ( SearchSize > Size )
+    {
+      return std::nullopt;
+    }
+
+    auto const Start = mappingRoundUp( SearchSize );
+    auto       ID    = Start.FL < FLCount ? findSuitable( Start ) : NullRange;
+
+    // Rounding up skips the list SearchSize falls in, which is the only one that has a fit when allocating a whole
+    // (or close to) block
+    if ( ID == NullRange )
+    {
+      ID = findInList( mapping( SearchSize ), SearchSize );
+    }
+
+    if ( ID == NullRange )
+    {
+      return std::nullopt;
+    }
+
+    removeFree( ID );
+
+    // Nodes might reallocate when splitting, so no references are held across acquireNode
+    auto const Off        = Nodes[ID].Off;
+    auto const AlignedOff = Detail::alignedOff( Off, Alignment );
+
+    // The previous physical range is always used (otherwise it would have been coalesced), so the padding becomes its own free range
+    if ( auto const Pad = AlignedOff - Off; Pad != 0 )
+    {
+      auto const PadID = acquireNode();
+      auto const Prev  = Nodes[ID].PrevPhys;
+
+      Nodes[PadID] = { Off, Pad, Prev, ID, NullRange, NullRange, true };
+
+      if ( Prev != NullRange )
+      {
+        Nodes[Prev].NextPhys = PadID;
+      }
+
+      Nodes[ID].PrevPhys = PadID;
+      Nodes[ID].Off      = AlignedOff;
+      Nodes[ID].Size -= Pad;
+      insertFree( PadID );
+    }
+
+    if ( auto const Remainder = Nodes[ID].Size - AllocSize; Remainder != 0 )
+    {
+      auto const RemID = acquireNode();
+      auto const Next  = Nodes[ID].NextPhys;
+
+      Nodes[RemID] = { AlignedOff + AllocSize, Remainder, ID, Next, NullRange, NullRange, true };
+
+      if ( Next != NullRange )
+      {
+        Nodes[Next].PrevPhys = RemID;
+      }
+
+      Nodes[ID].NextPhys = RemID;
+      Nodes[ID].Size     = AllocSize;
+      insertFree( RemID );
+    }
+
+    Used += AllocSize;
+    ++AllocCnt;
+
+    return Allocation{ AlignedOff, ID };
+  }
+
+  void Tlsf::free( RangeID ID ) noexcept
+  {
+    MVK_VERIFY( ID < std::size( Nodes ) );
+    MVK_VERIFY( !Nodes[ID].IsFree );
+
+    Used -= Nodes[ID].Size;
+    --AllocCnt;
+
+    if ( auto const Prev = Nodes[ID].PrevPhys; Prev != NullRange && Nodes[Prev].IsFree )
+    {
+      removeFree( Prev );
+
+      Nodes[Prev].Size += Nodes[ID].Size;
+      Nodes[Prev].NextPhys = Nodes[ID].NextPhys;
+
+      if ( auto const Next = Nodes[ID].NextPhys; Next != NullRange )
+      {
+        Nodes[Next].PrevPhys = Prev;
+      }
+
+      releaseNode( ID );
+      ID = Prev;
+    }
+
+    if ( auto const Next = Nodes[ID].NextPhys; Next != NullRange && Nodes[Next].IsFree )
+    {
+      removeFree( Next );
+
+      Nodes[ID].Size += Nodes[Next].Size;
+      Nodes[ID].NextPhys = Nodes[Next].NextPhys;
+
+      if ( auto const NextNext = Nodes[Next].NextPhys; NextNext != NullRange )
+      {
+        Nodes[NextNext].PrevPhys = ID;
+      }
+
+      releaseNode( Next );
+    }
+
+    insertFree( ID );
+  }
+
+  [[nodiscard]] VkDeviceSize Tlsf::getLargestFree() const noexcept
+  {
+    if ( FLBitmap == 0 )
+    {
+      return 0;
+    }
+
+    auto const FL = static_cast<uint32_t>( std::bit_width( FLBitmap ) - 1 );
+    auto const SL = static_cast<uint32_t>( std::bit_width( SLBitmaps[FL] ) - 1 );
+
+    auto Largest = VkDeviceSize( 0 );
+
+    for ( auto ID = Heads[FL][SL]; ID != NullRange; ID = Nodes[ID].NextFree )
+    {
+      Largest = std::max( Largest, Nodes[ID].Size );
+    }
+
+    return Largest;
+  }
+
+}  // namespace Mvk::Engine
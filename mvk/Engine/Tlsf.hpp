@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Utility/Macros.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Engine
+{
+  // Two level segregated fit allocator (http://www.gii.upv.es/tlsf/), it only keeps track of the ranges, the memory is owned by
+  // whoever uses it. Allocation and free are O(1), free ranges are coalesced with their physical neighbours right away
+  class Tlsf
+  {
+  public:
+    using RangeID = uint32_t;
+
+    static constexpr RangeID NullRange = std::numeric_limits<RangeID>::max();
+
+    struct Allocation
+    {
+      VkDeviceSize Off;
+      RangeID      ID;
+    };
+
+    explicit Tlsf( VkDeviceSize Size ) noexcept;
+    MVK_DEFINE_NON_COPYABLE( Tlsf );
+    MVK_DEFINE_DEFAULT_MOVABLE( Tlsf );
+    ~Tlsf() noexcept = default;
+
+    [[nodiscard]] std::optional<Allocation> allocate( VkDeviceSize Size, VkDeviceSize Alignment ) noexcept;
+
+    void free( RangeID ID ) noexcept;
+
+    // Smallest Tlsf where allocate always succeeds
+    [[nodiscard]] static VkDeviceSize getMinSize( VkDeviceSize AllocSize, VkDeviceSize Alignment ) noexcept;
+
+    // Walks a single free list, the one holding the biggest ranges
+    [[nodiscard]] VkDeviceSize getLargestFree() const noexcept;
+
+    [[nodiscard]] constexpr VkDeviceSize getSize() const noexcept;
+    [[nodiscard]] constexpr VkDeviceSize getUsed() const noexcept;
+    [[nodiscard]] constexpr size_t       getAllocCnt() const noexcept;
+
+    // Calls Fn( Off, Size, ID, IsFree ) for every range in offset order
+    template <typename Fn> void forEachRange( Fn && Func ) const noexcept;
+
+  private:
+    // Sizes under SmallSize are split linearly in the first level, the rest in power of two first levels and SLCount second levels
+    static constexpr uint32_t     SLBits     = 4;
+    static constexpr uint32_t     SLCount    = 1U << SLBits;
+    static constexpr uint32_t     SmallShift = 8;
+    static constexpr VkDeviceSize SmallSize  = VkDeviceSize( 1 ) << SmallShift;
+    static constexpr uint32_t     FLCount    = std::numeric_limits<VkDeviceSize>::digits - SmallShift + 1;
+
+    // Acquired by the constructor, coalescing keeps the lower node so it's always the range at offset 0
+    static constexpr RangeID FirstRange = 0;
+
+    struct Node
+    {
+      VkDeviceSize Off;
+      VkDeviceSize Size;
+      RangeID      PrevPhys;
+      RangeID      NextPhys;
+      RangeID      PrevFree;
+      RangeID      NextFree;
+      bool         IsFree;
+    };
+
+    struct Idx
+    {
+      uint32_t FL;
+      uint32_t SL;
+    };
+
+    [[nodiscard]] static Idx mapping( VkDeviceSize Size ) noexcept;
+    [[nodiscard]] static Idx mappingRoundUp( VkDeviceSize Size ) noexcept;
+
+    [[nodiscard]] RangeID findSuitable( Idx Start ) const noexcept;
+    [[nodiscard]] RangeID findInList( Idx List, VkDeviceSize Size ) const noexcept;
+    [[nodiscard]] RangeID acquireNode() noexcept;
+    void                  releaseNode( RangeID ID ) noexcept;
+    void                  insertFree( RangeID ID ) noexcept;
+    void                  removeFree( RangeID ID ) noexcept;
+
+    VkDeviceSize                                      Size;
+    VkDeviceSize                                      Used;
+    size_t                                            AllocCnt;
+    std::vector<Node>                                 Nodes;
+    std::vector<RangeID>                              FreeNodes;
+    uint64_t                                          FLBitmap;
+    std::array<uint32_t, FLCount>                     SLBitmaps;
+    std::array<std::array<RangeID, SLCount>, FLCount> Heads;
+  };
+
+  [[nodiscard]] constexpr VkDeviceSize Tlsf::getSize() const noexcept
+  {
+    return Size;
+  }
+
+  [[nodiscard]] constexpr VkDeviceSize Tlsf::getUsed() const noexcept
+  {
+    return Used;
+  }
+
+  [[nodiscard]] constexpr size_t Tlsf::getAllocCnt() const noexcept
+  {
+    return AllocCnt;
+  }
+
+  template <typename Fn> void Tlsf::forEachRange( Fn && Func ) const noexcept
+  {
+    for ( auto ID = FirstRange; ID != NullRange; ID = Nodes[ID].NextPhys )
+    {
+      auto const & Range = Nodes[ID];
+      Func( Range.Off, Range.Size, ID, Range.IsFree );
+    }
+  }
+
+}  // namespace Mvk::Engine
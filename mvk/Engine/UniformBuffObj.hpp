@@ -26,6 +26,7 @@ namespace Mvk::Engine
     {
       MVK_VERIFY( std::size( Data ) >= std::size( NewData ) );
       std::copy( std::begin( NewData ), std::end( NewData ), std::begin( Data ) );
+      Alloc.flush( ID, 0, std::size( NewData ) );
     }
 
     [[nodiscard]] constexpr VkBuffer getBuffer() const noexcept
@@ -33,9 +34,15 @@ namespace Mvk::Engine
       return Buff;
     }
 
+    [[nodiscard]] constexpr VkDeviceSize getOff() const noexcept
+    {
+      return Off;
+    }
+
   private:
     Allocator            Alloc;
     VkBuffer             Buff;
+    VkDeviceSize         Off;
     std::span<std::byte> Data;
     AllocationID         ID;
   };
@@ -0,0 +1,268 @@
+#include "Engine/UploadQueue.hpp"
+
+#include "Engine/AllocatorContext.hpp"
+#include "Utility/Verify.hpp"
+
+#include <limits>
+
+namespace Mvk::Engine
+{
+  UploadQueue::UploadQueue( VkDeviceSize StagingSize ) noexcept
+    : Queue( VulkanContext::the().getTransferQueue() )
+    , FamilyIdx( VulkanContext::the().getTransferQueueFamilyIdx() )
+    , GfxFamilyIdx( VulkanContext::the().getGraphicsQueueFamilyIdx() )
+    , IsDedicated( FamilyIdx != GfxFamilyIdx )
+    , CmdPool( VK_NULL_HANDLE )
+    , Timeline( VK_NULL_HANDLE )
+    , Staging( StagingSize )
+    , Current( VK_NULL_HANDLE )
+    , LastSubmitted( 0 )
+    , LastAcquired( 0 )
+  {
+    auto const Device = VulkanContext::the().getDevice();
+
+    auto CmdPoolCrtInfo             = VkCommandPoolCreateInfo();
+    CmdPoolCrtInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    CmdPoolCrtInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    CmdPoolCrtInfo.queueFamilyIndex = FamilyIdx;
+
+    auto Result = vkCreateCommandPool( Device, &CmdPoolCrtInfo, nullptr, &CmdPool );
+    MVK_VERIFY( Result == VK_SUCCESS );
+
+    auto SemaphoreTypeCrtInfo          = VkSemaphoreTypeCreateInfo();
+    SemaphoreTypeCrtInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    SemaphoreTypeCrtInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    SemaphoreTypeCrtInfo.initialValue  = 0;
+
+    auto SemaphoreCrtInfo  = VkSemaphoreCreateInfo();
+    SemaphoreCrtInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    SemaphoreCrtInfo.pNext = &SemaphoreTypeCrtInfo;
+
+    Result = vkCreateSemaphore( Device, &SemaphoreCrtInfo, nullptr, &Timeline );
+    MVK_VERIFY( Result == VK_SUCCESS );
+  }
+
+  UploadQueue::~UploadQueue() noexcept
+  {
+    flush();
+
+    auto const Device = VulkanContext::the().getDevice();
+
+    auto WaitInfo           = VkSemaphoreWaitInfo();
+    WaitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    WaitInfo.semaphoreCount = 1;
+    WaitInfo.pSemaphores    = &Timeline;
+    WaitInfo.pValues        = &LastSubmitted;
+
+    vkWaitSemaphores( Device, &WaitInfo, std::numeric_limits<uint64_t>::max() );
+
+    vkDestroyCommandPool( Device, CmdPool, nullptr );
+    vkDestroySemaphore( Device, Timeline, nullptr );
+  }
+
+  [[nodiscard]] VkCommandBuffer UploadQueue::getCmdBuff() noexcept
+  {
+    if ( Current != VK_NULL_HANDLE )
+    {
+      return Current;
+    }
+
+    reclaim();
+
+    if ( FreeCmdBuffs.empty() )
+    {
+      auto CmdBuffAllocInfo               = VkCommandBufferAllocateInfo();
+      CmdBuffAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      CmdBuffAllocInfo.commandPool        = CmdPool;
+      CmdBuffAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+      CmdBuffAllocInfo.commandBufferCount = 1;
+
+      auto const Result = vkAllocateCommandBuffers( VulkanContext::the().getDevice(), &CmdBuffAllocInfo, &Current );
+      MVK_VERIFY( Result == VK_SUCCESS );
+    }
+    else
+    {
+      Current = FreeCmdBuffs.back();
+      FreeCmdBuffs.pop_back();
+    }
+
+    auto CmdBuffBeginInfo             = VkCommandBufferBeginInfo();
+    CmdBuffBeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    CmdBuffBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    CmdBuffBeginInfo.pInheritanceInfo = nullptr;
+
+    vkBeginCommandBuffer( Current, &CmdBuffBeginInfo );
+
+    return Current;
+  }
+
+  void UploadQueue::release( VkBuffer Buff, VkDeviceSize Off, VkDeviceSize Size ) noexcept
+  {
+    MVK_VERIFY( Current != VK_NULL_HANDLE );
+
+    // On the same family the semaphore is enough to make the copies visible
+    if ( !IsDedicated )
+    {
+      return;
+    }
+
+    auto Barrier                = VkBufferMemoryBarrier();
+    Barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    Barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    Barrier.dstAccessMask       = 0;
+    Barrier.srcQueueFamilyIndex = FamilyIdx;
+    Barrier.dstQueueFamilyIndex = GfxFamilyIdx;
+    Barrier.buffer              = Buff;
+    Barrier.offset              = Off;
+    Barrier.size                = Size;
+
+    BuffReleases.push_back( Barrier );
+  }
+
+  void UploadQueue::release( VkImage Img, VkImageLayout Lay, uint32_t MipLvl ) noexcept
+  {
+    MVK_VERIFY( Current != VK_NULL_HANDLE );
+
+    if ( !IsDedicated )
+    {
+      return;
+    }
+
+    auto Barrier                            = VkImageMemoryBarrier();
+    Barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    Barrier.srcAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    Barrier.dstAccessMask                   = 0;
+    Barrier.oldLayout                       = Lay;
+    Barrier.newLayout                       = Lay;
+    Barrier.srcQueueFamilyIndex             = FamilyIdx;
+    Barrier.dstQueueFamilyIndex             = GfxFamilyIdx;
+    Barrier.image                           = Img;
+    Barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    Barrier.subresourceRange.baseMipLevel   = 0;
+    Barrier.subresourceRange.levelCount     = MipLvl;
+    Barrier.subresourceRange.baseArrayLayer = 0;
+    Barrier.subresourceRange.layerCount     = 1;
+
+    ImgReleases.push_back( Barrier );
+  }
+
+  UploadQueue::Ticket UploadQueue::flush() noexcept
+  {
+    if ( Current == VK_NULL_HANDLE )
+    {
+      return 0;
+    }
+
+    if ( !BuffReleases.empty() || !ImgReleases.empty() )
+    {
+      vkCmdPipelineBarrier( Current,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            0,
+                            0,
+                            nullptr,
+                            static_cast<uint32_t>( std::size( BuffReleases ) ),
+                            std::data( BuffReleases ),
+                            static_cast<uint32_t>( std::size( ImgReleases ) ),
+                            std::data( ImgReleases ) );
+    }
+
+    vkEndCommandBuffer( Current );
+
+    // Makes the staged data visible to the copies
+    AllocatorContext::the().flushMappedRanges();
+
+    auto const Value = LastSubmitted + 1;
+
+    auto TimelineSubmitInfo                      = VkTimelineSemaphoreSubmitInfo();
+    TimelineSubmitInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    TimelineSubmitInfo.signalSemaphoreValueCount = 1;
+    TimelineSubmitInfo.pSignalSemaphoreValues    = &Value;
+
+    auto SubmitInfo                 = VkSubmitInfo();
+    SubmitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.pNext                = &TimelineSubmitInfo;
+    SubmitInfo.commandBufferCount   = 1;
+    SubmitInfo.pCommandBuffers      = &Current;
+    SubmitInfo.signalSemaphoreCount = 1;
+    SubmitInfo.pSignalSemaphores    = &Timeline;
+
+    auto const Result = vkQueueSubmit( Queue, 1, &SubmitInfo, Staging.endBatch() );
+    MVK_VERIFY( Result == VK_SUCCESS );
+
+    // The acquire has to match the release, only the access masks change sides
+    for ( auto Barrier : BuffReleases )
+    {
+      Barrier.srcAccessMask = 0;
+      Barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+      BuffAcquires.push_back( Barrier );
+    }
+
+    for ( auto Barrier : ImgReleases )
+    {
+      Barrier.srcAccessMask = 0;
+      Barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+      ImgAcquires.push_back( Barrier );
+    }
+
+    BuffReleases.clear();
+    ImgReleases.clear();
+
+    InFlight.push_back( { Current, Value } );
+    Current       = VK_NULL_HANDLE;
+    LastSubmitted = Value;
+
+    return Value;
+  }
+
+  [[nodiscard]] UploadQueue::Ticket UploadQueue::acquire( VkCommandBuffer CmdBuff ) noexcept
+  {
+    if ( LastAcquired == LastSubmitted )
+    {
+      return 0;
+    }
+
+    if ( !BuffAcquires.empty() || !ImgAcquires.empty() )
+    {
+      vkCmdPipelineBarrier( CmdBuff,
+                            AcquireStages,
+                            AcquireStages,
+                            0,
+                            0,
+                            nullptr,
+                            static_cast<uint32_t>( std::size( BuffAcquires ) ),
+                            std::data( BuffAcquires ),
+                            static_cast<uint32_t>( std::size( ImgAcquires ) ),
+                            std::data( ImgAcquires ) );
+    }
+
+    BuffAcquires.clear();
+    ImgAcquires.clear();
+
+    LastAcquired = LastSubmitted;
+    return LastAcquired;
+  }
+
+  void UploadQueue::reclaim() noexcept
+  {
+    auto Completed = Ticket( 0 );
+    vkGetSemaphoreCounterValue( VulkanContext::the().getDevice(), Timeline, &Completed );
+
+    while ( !InFlight.empty() && InFlight.front().Value <= Completed )
+    {
+      FreeCmdBuffs.push_back( InFlight.front().CmdBuff );
+      InFlight.pop_front();
+    }
+
+    Staging.reclaim();
+  }
+
+  [[nodiscard]] bool UploadQueue::isDone( Ticket Value ) const noexcept
+  {
+    auto Completed = Ticket( 0 );
+    vkGetSemaphoreCounterValue( VulkanContext::the().getDevice(), Timeline, &Completed );
+
+    return Completed >= Value;
+  }
+
+}  // namespace Mvk::Engine
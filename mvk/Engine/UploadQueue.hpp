@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Engine/StagingRing.hpp"
+#include "Engine/VulkanContext.hpp"
+#include "Utility/Macros.hpp"
+
+#include <deque>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Engine
+{
+  // Records copies on the transfer queue when the device has a transfer only family, the graphics queue otherwise. Each
+  // submission signals the next value of a timeline semaphore, the graphics side only waits on it in the first frame that
+  // acquires the uploaded resources
+  class UploadQueue
+  {
+  public:
+    using Ticket = uint64_t;
+
+    explicit UploadQueue( VkDeviceSize StagingSize ) noexcept;
+    MVK_DEFINE_NON_COPYABLE( UploadQueue );
+    MVK_DEFINE_NON_MOVABLE( UploadQueue );
+    ~UploadQueue() noexcept;
+
+    // Begins a command buffer if nothing was recorded since the last flush, so any number of uploads share a submission
+    [[nodiscard]] VkCommandBuffer getCmdBuff() noexcept;
+
+    // Hands the resources to the graphics queue once the copies are done, images keep their layout
+    void release( VkBuffer Buff, VkDeviceSize Off, VkDeviceSize Size ) noexcept;
+    void release( VkImage Img, VkImageLayout Lay, uint32_t MipLvl ) noexcept;
+
+    // 0 when nothing was recorded
+    Ticket flush() noexcept;
+
+    // Records the graphics side of every upload flushed so far, the submission of CmdBuff has to wait on the returned value
+    // of getSemaphore() at getWaitStages(). 0 when there's nothing to wait on
+    [[nodiscard]] Ticket acquire( VkCommandBuffer CmdBuff ) noexcept;
+
+    // Recycles the command buffers and staging of finished uploads, never blocks
+    void reclaim() noexcept;
+
+    [[nodiscard]] bool isDone( Ticket Value ) const noexcept;
+
+    [[nodiscard]] constexpr StagingRing &        getStaging() noexcept;
+    [[nodiscard]] constexpr VkSemaphore          getSemaphore() const noexcept;
+    [[nodiscard]] constexpr VkPipelineStageFlags getWaitStages() const noexcept;
+    [[nodiscard]] constexpr bool                 getIsDedicated() const noexcept;
+
+  private:
+    struct Submission
+    {
+      VkCommandBuffer CmdBuff;
+      Ticket          Value;
+    };
+
+    // First stages on the graphics queue that touch uploaded resources, copies of the defragmentation and vertex fetch
+    static constexpr VkPipelineStageFlags AcquireStages = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+    VkQueue                            Queue;
+    QueueFamilyIdx                     FamilyIdx;
+    QueueFamilyIdx                     GfxFamilyIdx;
+    bool                               IsDedicated;
+    VkCommandPool                      CmdPool;
+    VkSemaphore                        Timeline;
+    StagingRing                        Staging;
+    VkCommandBuffer                    Current;
+    Ticket                             LastSubmitted;
+    Ticket                             LastAcquired;
+    std::vector<VkBufferMemoryBarrier> BuffReleases;
+    std::vector<VkImageMemoryBarrier>  ImgReleases;
+    std::vector<VkBufferMemoryBarrier> BuffAcquires;
+    std::vector<VkImageMemoryBarrier>  ImgAcquires;
+    std::deque<Submission>             InFlight;
+    std::vector<VkCommandBuffer>       FreeCmdBuffs;
+  };
+
+  [[nodiscard]] constexpr StagingRing & UploadQueue::getStaging() noexcept
+  {
+    return Staging;
+  }
+
+  [[nodiscard]] constexpr VkSemaphore UploadQueue::getSemaphore() const noexcept
+  {
+    return Timeline;
+  }
+
+  [[nodiscard]] constexpr VkPipelineStageFlags UploadQueue::getWaitStages() const noexcept
+  {
+    return AcquireStages;
+  }
+
+  [[nodiscard]] constexpr bool UploadQueue::getIsDedicated() const noexcept
+  {
+    return IsDedicated;
+  }
+
+}  // namespace Mvk::Engine
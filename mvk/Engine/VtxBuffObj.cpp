@@ -1,43 +1,73 @@
 #include "Engine/VtxBuffObj.hpp"
 
 #include "Engine/VulkanContext.hpp"
+#include "Utility/Verify.hpp"
+
+#include <cstring>
 
 namespace Mvk::Engine
 {
-  VtxBuffObj::VtxBuffObj( VkDeviceSize ByteSize, Allocator Alloc ) noexcept : Stage( ByteSize, Alloc ), Buff( VK_NULL_HANDLE )
+  VtxBuffObj::VtxBuffObj( VkDeviceSize ByteSize, Allocator Alloc ) noexcept
+    : Alloc( Alloc ), Size( ByteSize ), Buff( VK_NULL_HANDLE ), Off( 0 ), Data( nullptr )
   {
-    auto CrtInfo        = VkBufferCreateInfo();
-    CrtInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    CrtInfo.size        = ByteSize;
-    CrtInfo.usage       = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-    CrtInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    // Written in place when the device local memory can be mapped, staged otherwise
+    auto Allocation = Alloc.allocate( AllocationType::GpuMapped, BufferClass::Geometry, ByteSize, Alignment, this );
+
+    if ( !Allocation.has_value() )
+    {
+      Allocation = Alloc.allocate( AllocationType::GpuOnly, BufferClass::Geometry, ByteSize, Alignment, this );
+    }
 
-    auto const Device = VulkanContext::the().getDevice();
+    // Over the memory budget, the owner checks getIsAllocated and tries again later
+    if ( !Allocation.has_value() )
+    {
+      return;
+    }
+
+    Buff = Allocation->Buff;
+    Off  = Allocation->Off;
+    Data = Allocation->Data;
+    ID   = Allocation->ID;
+  }
 
-    auto Result = vkCreateBuffer( Device, &CrtInfo, nullptr, &Buff );
-    MVK_VERIFY( Result == VK_SUCCESS );
+  void VtxBuffObj::relocate( VkCommandBuffer CmdBuff, Allocation const & NewAlloc ) noexcept
+  {
+    auto CopyRegion      = VkBufferCopy();
+    CopyRegion.srcOffset = Off;
+    CopyRegion.dstOffset = NewAlloc.Off;
+    CopyRegion.size      = Size;
 
-    auto Req = VkMemoryRequirements();
-    vkGetBufferMemoryRequirements( Device, Buff, &Req );
+    // The old range is freed by the allocator
+    vkCmdCopyBuffer( CmdBuff, Buff, NewAlloc.Buff, 1, &CopyRegion );
 
-    auto Allocation = Stage.getAllocator().allocate( AllocationType::GpuOnly, Req.size, Req.alignment, Req.memoryTypeBits );
+    Buff = NewAlloc.Buff;
+    Off  = NewAlloc.Off;
+    ID   = NewAlloc.ID;
+  }
 
-    vkBindBufferMemory( Device, Buff, Allocation.Mem, Allocation.Off );
+  void VtxBuffObj::map( VkCommandBuffer CmdBuff, StagingRing & Stage, std::span<std::byte const> Src ) noexcept
+  {
+    if ( getIsMapped() )
+    {
+      std::memcpy( Data, std::data( Src ), std::size( Src ) );
+      Alloc.flush( ID, 0, std::size( Src ) );
+      return;
+    }
 
-    ID = Allocation.ID;
+    Stage.copyTo( CmdBuff, Src, Buff, Off );
   }
 
-  void VtxBuffObj::map( VkCommandBuffer CmdBuff, std::span<std::byte const> Data ) noexcept
+  void VtxBuffObj::map( VkCommandBuffer CmdBuff, StagingRing & Stage, StagingRing::AllocResult const & From ) noexcept
   {
-    Stage.map( Data ).copyTo( CmdBuff, Buff );
+    Stage.copyTo( CmdBuff, From, Size, Buff, Off );
   }
 
   VtxBuffObj::~VtxBuffObj() noexcept
   {
-    auto const Device = VulkanContext::the().getDevice();
-    vkDestroyBuffer( Device, Buff, nullptr );
-
-    Stage.getAllocator().free( ID );
+    if ( getIsAllocated() )
+    {
+      Alloc.free( ID );
+    }
   }
 
 }  // namespace Mvk::Engine
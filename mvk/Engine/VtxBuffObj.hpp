@@ -1,11 +1,12 @@
 #pragma once
 
-#include "Engine/StagingBuffObj.hpp"
+#include "Engine/Relocatable.hpp"
+#include "Engine/StagingRing.hpp"
 #include "Utility/Macros.hpp"
 
 namespace Mvk::Engine
 {
-  class VtxBuffObj
+  class VtxBuffObj : public Relocatable
   {
   public:
     struct MapResult
@@ -18,17 +19,44 @@ namespace Mvk::Engine
     MVK_DEFINE_NON_MOVABLE( VtxBuffObj );
     ~VtxBuffObj() noexcept;
 
-    void map( VkCommandBuffer CmdBuff, std::span<std::byte const> Data ) noexcept;
+    // Doesn't record anything when the buffer is mapped
+    void map( VkCommandBuffer CmdBuff, StagingRing & Stage, std::span<std::byte const> Src ) noexcept;
+    // Fills the whole buffer from data that's already staged, always a copy
+    void map( VkCommandBuffer CmdBuff, StagingRing & Stage, StagingRing::AllocResult const & From ) noexcept;
+    void relocate( VkCommandBuffer CmdBuff, Allocation const & NewAlloc ) noexcept override;
 
     [[nodiscard]] constexpr VkBuffer getBuff() const noexcept
     {
       return Buff;
     }
+    [[nodiscard]] constexpr VkDeviceSize getOff() const noexcept
+    {
+      return Off;
+    }
+    [[nodiscard]] constexpr VkDeviceSize getSize() const noexcept
+    {
+      return Size;
+    }
+    [[nodiscard]] constexpr bool getIsMapped() const noexcept
+    {
+      return Data != nullptr;
+    }
+    // False when the memory budget had no room for it, it can only be destroyed then
+    [[nodiscard]] constexpr bool getIsAllocated() const noexcept
+    {
+      return Buff != VK_NULL_HANDLE;
+    }
 
   private:
-    StagingBuffObj Stage;
-    VkBuffer       Buff;
-    AllocationID   ID;
+    // Vertex and index data share the same buffers, 16 keeps every attribute aligned
+    static constexpr VkDeviceSize Alignment = 16;
+
+    Allocator    Alloc;
+    VkDeviceSize Size;
+    VkBuffer     Buff;
+    VkDeviceSize Off;
+    std::byte *  Data;
+    AllocationID ID;
   };
 
 }  // namespace Mvk::Engine
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "ShaderTypes.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Engine
+{
+  struct VtxAttr
+  {
+    uint32_t Location;
+    VkFormat Format;
+    uint32_t Off;
+  };
+
+  // Only the formats the layouts below use, anything else fails the checks of VtxLayout
+  [[nodiscard]] constexpr uint32_t getFormatSize( VkFormat Format ) noexcept
+  {
+    switch ( Format )
+    {
+      case VK_FORMAT_R16G16_UNORM: return 4;
+      case VK_FORMAT_R16G16B16A16_SNORM: return 8;
+      case VK_FORMAT_R32G32_SFLOAT: return 8;
+      case VK_FORMAT_R32G32B32_SFLOAT: return 12;
+      default: return 0;
+    }
+  }
+
+  // One interleaved stream on binding 0. Everything is computed at compile time, the arrays are static so the input state
+  // can point straight at them. A layout can leave attributes of its vertex out, pipelines that don't read them still
+  // use the same buffers
+  template <typename Vtx, VtxAttr... Attrs>
+  class VtxLayout
+  {
+  public:
+    using Vertex = Vtx;
+
+    static constexpr auto Binding = uint32_t( 0 );
+    static constexpr auto Stride  = static_cast<uint32_t>( sizeof( Vtx ) );
+
+    static constexpr auto BindingDesc = VkVertexInputBindingDescription{ Binding, Stride, VK_VERTEX_INPUT_RATE_VERTEX };
+    static constexpr auto AttrDescs = std::array<VkVertexInputAttributeDescription, sizeof...( Attrs )>{
+      VkVertexInputAttributeDescription{ Attrs.Location, Binding, Attrs.Format, Attrs.Off }...
+    };
+
+    static_assert( ( ( getFormatSize( Attrs.Format ) != 0 ) && ... ), "Unknown vertex attribute format" );
+    static_assert( ( ( Attrs.Off + getFormatSize( Attrs.Format ) <= Stride ) && ... ), "Vertex attribute past the end of the vertex" );
+
+    [[nodiscard]] static VkPipelineVertexInputStateCreateInfo getInputState() noexcept
+    {
+      auto InputState                            = VkPipelineVertexInputStateCreateInfo();
+      InputState.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+      InputState.vertexBindingDescriptionCount   = 1;
+      InputState.pVertexBindingDescriptions      = &BindingDesc;
+      InputState.vertexAttributeDescriptionCount = static_cast<uint32_t>( std::size( AttrDescs ) );
+      InputState.pVertexAttributeDescriptions    = std::data( AttrDescs );
+      return InputState;
+    }
+  };
+
+  // Same locations as the packed layout, no shader reads the color
+  using FullVtxLayout = VtxLayout<vertex,
+                                  VtxAttr{ 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof( vertex, pos ) },
+                                  VtxAttr{ 1, VK_FORMAT_R32G32_SFLOAT, offsetof( vertex, texture_coord ) }>;
+
+  // Positions go through the pos_dequant of the mesh, UVs only cover [0, 1]
+  using PackedVtxLayout = VtxLayout<packed_vertex,
+                                    VtxAttr{ 0, VK_FORMAT_R16G16B16A16_SNORM, offsetof( packed_vertex, pos ) },
+                                    VtxAttr{ 1, VK_FORMAT_R16G16_UNORM, offsetof( packed_vertex, texture_coord ) }>;
+
+  // What the loaders build with Detail::buildVtxs and the main pipeline reads. MVK_FULL_VERTICES is for meshes the packed
+  // vertices can't hold, like UVs that wrap outside of [0, 1], at almost three times the size
+#ifdef MVK_FULL_VERTICES
+  using ModelVtxLayout = FullVtxLayout;
+
+  inline constexpr auto ModelVtxShader = "../shaders/vert_full.spv";
+#else
+  using ModelVtxLayout = PackedVtxLayout;
+
+  inline constexpr auto ModelVtxShader = "../shaders/vert.spv";
+#endif
+
+}  // namespace Mvk::Engine
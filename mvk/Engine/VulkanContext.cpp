@@ -5,6 +5,8 @@
 #include "Utility/Verify.hpp"
 #include "vulkan/vulkan_core.h"
 
+#include <algorithm>
+
 namespace Mvk::Engine
 {
   [[nodiscard]] VkExtent2D VulkanContext::getFramebufferSize() const noexcept
@@ -23,8 +25,6 @@ namespace Mvk::Engine
 
   void VulkanContext::initialize( std::string const & Name, Extent Extent )
   {
-    AllocatorContext::the().initialize( {} );
-
     initWindow( Name, Extent );
     initInstace( Name );
     initDbgMsngr();
@@ -32,6 +32,12 @@ namespace Mvk::Engine
     selectPhysicalDevice();
     selectSurfaceFmt();
     initDevice();
+
+    // Reads the memory properties of the device
+    AllocatorContext::the().initialize( {} );
+
+    // Leaks get reported at shutdown
+    AllocatorContext::the().setIsTracking( UseValidation );
   }
 
   void VulkanContext::initWindow( std::string const & Name, Extent Extent ) noexcept
@@ -87,6 +93,8 @@ namespace Mvk::Engine
     AppInfo.applicationVersion = VK_MAKE_VERSION( 1, 0, 0 );
     AppInfo.pEngineName        = "No Engine";
     AppInfo.engineVersion      = VK_MAKE_VERSION( 1, 0, 0 );
+    // vkGetPhysicalDeviceMemoryProperties2 for the memory budget and timeline semaphores for the uploads
+    AppInfo.apiVersion         = VK_API_VERSION_1_2;
 
     auto       ReqInstExtCount = uint32_t( 0 );
     auto const ReqInstExtData  = glfwGetRequiredInstanceExtensions( &ReqInstExtCount );
@@ -163,9 +171,11 @@ namespace Mvk::Engine
 
       if ( Detail::chkExtSup( AvailablePhysicalDevice, DeviceExtensions ) &&
            Detail::chkFmtAndPresentModeAvailablity( AvailablePhysicalDevice, Surface ) &&
-           Detail::queryFamiliyIdxs( AvailablePhysicalDevice, Surface ).has_value() && features.samplerAnisotropy )
+           Detail::queryFamiliyIdxs( AvailablePhysicalDevice, Surface ).has_value() && features.samplerAnisotropy &&
+           Detail::chkTimelineSemaphoreSup( AvailablePhysicalDevice ) )
       {
         PhysicalDevice = AvailablePhysicalDevice;
+        vkGetPhysicalDeviceProperties( PhysicalDevice, &PhysicalDeviceProps );
         return;
       }
     }
@@ -201,33 +211,74 @@ namespace Mvk::Engine
     GfxQueueIdx          = QueueIdxs.first;
     PresentQueueIdx      = QueueIdxs.second;
 
+    // Without a transfer only family the uploads just go through the graphics queue
+    TransferQueueIdx = Detail::queryTransferFamilyIdx( PhysicalDevice ).value_or( GfxQueueIdx );
+
     auto Features = VkPhysicalDeviceFeatures();
     vkGetPhysicalDeviceFeatures( PhysicalDevice, &Features );
 
+    auto Features12              = VkPhysicalDeviceVulkan12Features();
+    Features12.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    Features12.timelineSemaphore = VK_TRUE;
+
     auto const QueuePrio = 1.0F;
 
-    auto GfxQueueCrtInfo             = VkDeviceQueueCreateInfo();
-    GfxQueueCrtInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    GfxQueueCrtInfo.queueFamilyIndex = GfxQueueIdx;
-    GfxQueueCrtInfo.queueCount       = 1;
-    GfxQueueCrtInfo.pQueuePriorities = &QueuePrio;
+    auto Exts = std::vector<char const *>( std::begin( DeviceExtensions ), std::end( DeviceExtensions ) );
+
+    HasMemoryBudget = Detail::chkExtSup( PhysicalDevice, MemoryBudgetExtensions );
+
+    if ( HasMemoryBudget )
+    {
+      Exts.insert( std::end( Exts ), std::begin( MemoryBudgetExtensions ), std::end( MemoryBudgetExtensions ) );
+    }
+
+    HasHostImport       = Detail::chkExtSup( PhysicalDevice, HostImportExtensions );
+    HostImportAlignment = 0;
+
+    if ( HasHostImport )
+    {
+      Exts.insert( std::end( Exts ), std::begin( HostImportExtensions ), std::end( HostImportExtensions ) );
+
+      auto HostProps  = VkPhysicalDeviceExternalMemoryHostPropertiesEXT();
+      HostProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+
+      auto Props  = VkPhysicalDeviceProperties2();
+      Props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+      Props.pNext = &HostProps;
+
+      vkGetPhysicalDeviceProperties2( PhysicalDevice, &Props );
+      HostImportAlignment = HostProps.minImportedHostPointerAlignment;
+    }
+
+    auto QueueCrtInfos = std::vector<VkDeviceQueueCreateInfo>();
+
+    // One queue per family, the families can be the same
+    for ( auto const FamilyIdx : { GfxQueueIdx, PresentQueueIdx, TransferQueueIdx } )
+    {
+      auto const isSameFamily = [FamilyIdx]( auto const & CrtInfo ) { return CrtInfo.queueFamilyIndex == FamilyIdx; };
 
-    auto PresentQueueCrtInfo             = VkDeviceQueueCreateInfo();
-    PresentQueueCrtInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    PresentQueueCrtInfo.queueFamilyIndex = PresentQueueIdx;
-    PresentQueueCrtInfo.queueCount       = 1;
-    PresentQueueCrtInfo.pQueuePriorities = &QueuePrio;
+      if ( std::any_of( std::begin( QueueCrtInfos ), std::end( QueueCrtInfos ), isSameFamily ) )
+      {
+        continue;
+      }
 
-    auto const queue_create_info       = std::array{ GfxQueueCrtInfo, PresentQueueCrtInfo };
-    auto const queue_create_info_count = static_cast<uint32_t>( QueueIdxs.first != QueueIdxs.second ? 2 : 1 );
+      auto QueueCrtInfo             = VkDeviceQueueCreateInfo();
+      QueueCrtInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+      QueueCrtInfo.queueFamilyIndex = FamilyIdx;
+      QueueCrtInfo.queueCount       = 1;
+      QueueCrtInfo.pQueuePriorities = &QueuePrio;
+
+      QueueCrtInfos.push_back( QueueCrtInfo );
+    }
 
     auto DeviceCrtInfo                    = VkDeviceCreateInfo();
     DeviceCrtInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    DeviceCrtInfo.queueCreateInfoCount    = queue_create_info_count;
-    DeviceCrtInfo.pQueueCreateInfos       = std::data( queue_create_info );
+    DeviceCrtInfo.pNext                   = &Features12;
+    DeviceCrtInfo.queueCreateInfoCount    = static_cast<uint32_t>( std::size( QueueCrtInfos ) );
+    DeviceCrtInfo.pQueueCreateInfos       = std::data( QueueCrtInfos );
     DeviceCrtInfo.pEnabledFeatures        = &Features;
-    DeviceCrtInfo.enabledExtensionCount   = static_cast<uint32_t>( std::size( DeviceExtensions ) );
-    DeviceCrtInfo.ppEnabledExtensionNames = std::data( DeviceExtensions );
+    DeviceCrtInfo.enabledExtensionCount   = static_cast<uint32_t>( std::size( Exts ) );
+    DeviceCrtInfo.ppEnabledExtensionNames = std::data( Exts );
 
     if constexpr ( UseValidation )
     {
@@ -245,6 +296,7 @@ namespace Mvk::Engine
 
     vkGetDeviceQueue( Device, GfxQueueIdx, 0, &GfxQueue );
     vkGetDeviceQueue( Device, PresentQueueIdx, 0, &PresentQueue );
+    vkGetDeviceQueue( Device, TransferQueueIdx, 0, &TransferQueue );
   }
 
   void VulkanContext::dstrWindow() noexcept
@@ -280,8 +332,45 @@ namespace Mvk::Engine
     vkDestroyDevice( Device, nullptr );
   }
 
+  void VulkanContext::addGarbage( VkBuffer Buff ) noexcept
+  {
+    Garbages.add( Buff );
+  }
+
+  void VulkanContext::addGarbage( VkImage Img ) noexcept
+  {
+    Garbages.add( Img );
+  }
+
+  void VulkanContext::addGarbage( VkImageView ImgView ) noexcept
+  {
+    Garbages.add( ImgView );
+  }
+
+  void VulkanContext::addGarbage( VkDescriptorPool Pool, VkDescriptorSet DescSet ) noexcept
+  {
+    Garbages.add( Pool, DescSet );
+  }
+
+  void VulkanContext::addGarbage( AllocationID ID ) noexcept
+  {
+    Garbages.add( ID );
+  }
+
+  void VulkanContext::collectGarbage() noexcept
+  {
+    Garbages.collect( Device );
+  }
+
+  void VulkanContext::flushGarbage() noexcept
+  {
+    vkDeviceWaitIdle( Device );
+    Garbages.flush( Device );
+  }
+
   void VulkanContext::shutdown() noexcept
   {
+    flushGarbage();
     AllocatorContext::the().shutdown();
     dstrDevice();
     dstrSurface();
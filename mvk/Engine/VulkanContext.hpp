@@ -1,10 +1,13 @@
 #pragma once
 
 #include "Detail/Helpers.hpp"
+#include "Engine/AllocatorBlock.hpp"
+#include "Engine/GarbageQueue.hpp"
 #include "GLFW/glfw3.h"
 #include "Utility/Macros.hpp"
 #include "Utility/Singleton.hpp"
 
+#include <array>
 #include <vulkan/vulkan.h>
 
 namespace Mvk::Engine
@@ -31,9 +34,15 @@ namespace Mvk::Engine
     static constexpr auto   ValidationLayers              = std::array{ "VK_LAYER_KHRONOS_validation" };
     static constexpr auto   ValidationInstanceExtensionss = std::array{ VK_EXT_DEBUG_UTILS_EXTENSION_NAME };
     static constexpr auto   DeviceExtensions              = std::array{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    // Only enabled if the device supports them
+    static constexpr auto   MemoryBudgetExtensions        = std::array{ VK_EXT_MEMORY_BUDGET_EXTENSION_NAME };
+    static constexpr auto   HostImportExtensions          = std::array{ VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME };
     static constexpr auto   MaxFramesInFlight             = 2;
     static constexpr size_t DynamicBuffCount              = 2;
-    static constexpr size_t GarbageBuffCount              = 2;
+    static constexpr size_t GarbageBuffCount              = GarbageQueue::BuffCount;
+
+    // Garbage is only destroyed once the frame that could still be using it is done
+    static_assert( GarbageBuffCount >= MaxFramesInFlight );
 
     struct Extent
     {
@@ -43,24 +52,43 @@ namespace Mvk::Engine
 
     void initialize( std::string const & Name, Extent Extent );
 
-    [[nodiscard]] constexpr GLFWwindow *       getWindow() const noexcept;
-    [[nodiscard]] constexpr VkDevice           getDevice() const noexcept;
-    [[nodiscard]] constexpr VkPhysicalDevice   getPhysicalDevice() const noexcept;
-    [[nodiscard]] constexpr VkSurfaceFormatKHR getSurfaceFmt() const noexcept;
-    [[nodiscard]] constexpr VkQueue            getGraphicsQueue() const noexcept;
-    [[nodiscard]] constexpr VkQueue            getPresentQueue() const noexcept;
-    [[nodiscard]] constexpr QueueFamilyIdx     getGraphicsQueueFamilyIdx() const noexcept;
-    [[nodiscard]] constexpr QueueFamilyIdx     getPresentQueueFamilyIdx() const noexcept;
-    [[nodiscard]] constexpr bool               getIsFramebufferResized() const noexcept;
-    [[nodiscard]] constexpr VkRenderPass       getRenderPass() const noexcept;
-    [[nodiscard]] constexpr VkCommandPool      getCommandPool() const noexcept;
-    [[nodiscard]] constexpr VkDescriptorPool   getDescriptorPool() const noexcept;
-    [[nodiscard]] constexpr VkSurfaceKHR       getSurface() const noexcept;
-    constexpr void                             setIsFramebufferResized( bool State ) noexcept;
+    [[nodiscard]] constexpr GLFWwindow *                   getWindow() const noexcept;
+    [[nodiscard]] constexpr VkDevice                       getDevice() const noexcept;
+    [[nodiscard]] constexpr VkPhysicalDevice               getPhysicalDevice() const noexcept;
+    [[nodiscard]] constexpr VkPhysicalDeviceLimits const & getPhysicalDeviceLimits() const noexcept;
+    [[nodiscard]] constexpr VkSurfaceFormatKHR             getSurfaceFmt() const noexcept;
+    [[nodiscard]] constexpr VkQueue                        getGraphicsQueue() const noexcept;
+    [[nodiscard]] constexpr VkQueue                        getPresentQueue() const noexcept;
+    [[nodiscard]] constexpr VkQueue                        getTransferQueue() const noexcept;
+    [[nodiscard]] constexpr QueueFamilyIdx                 getGraphicsQueueFamilyIdx() const noexcept;
+    [[nodiscard]] constexpr QueueFamilyIdx                 getPresentQueueFamilyIdx() const noexcept;
+    [[nodiscard]] constexpr QueueFamilyIdx                 getTransferQueueFamilyIdx() const noexcept;
+    [[nodiscard]] constexpr bool                           getIsFramebufferResized() const noexcept;
+    [[nodiscard]] constexpr bool                           getHasMemoryBudget() const noexcept;
+    [[nodiscard]] constexpr bool                           getHasHostImport() const noexcept;
+    [[nodiscard]] constexpr VkDeviceSize                   getHostImportAlignment() const noexcept;
+    [[nodiscard]] constexpr VkRenderPass                   getRenderPass() const noexcept;
+    [[nodiscard]] constexpr VkCommandPool                  getCommandPool() const noexcept;
+    [[nodiscard]] constexpr VkDescriptorPool               getDescriptorPool() const noexcept;
+    [[nodiscard]] constexpr VkSurfaceKHR                   getSurface() const noexcept;
+    constexpr void                                         setIsFramebufferResized( bool State ) noexcept;
 
     [[nodiscard]] VkExtent2D getFramebufferSize() const noexcept;
     [[nodiscard]] float      getCurrentTime() const noexcept;
 
+    // Destroyed GarbageBuffCount collectGarbage calls later, safe to call from any thread
+    void addGarbage( VkBuffer Buff ) noexcept;
+    void addGarbage( VkImage Img ) noexcept;
+    void addGarbage( VkImageView ImgView ) noexcept;
+    void addGarbage( VkDescriptorPool Pool, VkDescriptorSet DescSet ) noexcept;
+    void addGarbage( AllocationID ID ) noexcept;
+
+    // Expected to be called once per frame after waiting for the frame's fence
+    void collectGarbage() noexcept;
+
+    // Waits for the device to be idle and destroys everything
+    void flushGarbage() noexcept;
+
     void shutdown() noexcept;
 
   private:
@@ -78,27 +106,36 @@ namespace Mvk::Engine
     void dstrSurface() noexcept;
     void dstrDevice() noexcept;
 
-    GLFWwindow *             Window;
-    bool                     IsFramebufferResized;
+    GLFWwindow *               Window;
+    bool                       IsFramebufferResized;
     //
     // Instance
-    VkInstance               Instance;
+    VkInstance                 Instance;
     //
     // Surface
-    VkSurfaceKHR             Surface;
-    VkSurfaceFormatKHR       SurfaceFmt;
+    VkSurfaceKHR               Surface;
+    VkSurfaceFormatKHR         SurfaceFmt;
     //
     // Debug
-    VkDebugUtilsMessengerEXT DbgMsngr;
+    VkDebugUtilsMessengerEXT   DbgMsngr;
     //
     // Device
-    VkPhysicalDevice         PhysicalDevice;
-    VkDevice                 Device;
-    uint32_t                 GfxQueueIdx;
-    uint32_t                 PresentQueueIdx;
-    VkQueue                  GfxQueue;
-    VkQueue                  PresentQueue;
-    VkRenderPass             RenderPass;
+    VkPhysicalDevice           PhysicalDevice;
+    VkPhysicalDeviceProperties PhysicalDeviceProps;
+    VkDevice                   Device;
+    uint32_t                   GfxQueueIdx;
+    uint32_t                   PresentQueueIdx;
+    uint32_t                   TransferQueueIdx;
+    VkQueue                    GfxQueue;
+    VkQueue                    PresentQueue;
+    VkQueue                    TransferQueue;
+    VkRenderPass               RenderPass;
+    bool                       HasMemoryBudget;
+    bool                       HasHostImport;
+    VkDeviceSize               HostImportAlignment;
+
+    // Garbage
+    GarbageQueue               Garbages;
 
     std::chrono::time_point<std::chrono::high_resolution_clock> StartTime = std::chrono::high_resolution_clock::now();
   };
@@ -118,6 +155,11 @@ namespace Mvk::Engine
     return PhysicalDevice;
   }
 
+  [[nodiscard]] constexpr VkPhysicalDeviceLimits const & VulkanContext::getPhysicalDeviceLimits() const noexcept
+  {
+    return PhysicalDeviceProps.limits;
+  }
+
   [[nodiscard]] constexpr VkSurfaceFormatKHR VulkanContext::getSurfaceFmt() const noexcept
   {
     return SurfaceFmt;
@@ -133,6 +175,11 @@ namespace Mvk::Engine
     return PresentQueue;
   }
 
+  [[nodiscard]] constexpr VkQueue VulkanContext::getTransferQueue() const noexcept
+  {
+    return TransferQueue;
+  }
+
   [[nodiscard]] constexpr QueueFamilyIdx VulkanContext::getGraphicsQueueFamilyIdx() const noexcept
   {
     return GfxQueueIdx;
@@ -143,11 +190,31 @@ namespace Mvk::Engine
     return PresentQueueIdx;
   }
 
+  [[nodiscard]] constexpr QueueFamilyIdx VulkanContext::getTransferQueueFamilyIdx() const noexcept
+  {
+    return TransferQueueIdx;
+  }
+
   [[nodiscard]] constexpr bool VulkanContext::getIsFramebufferResized() const noexcept
   {
     return IsFramebufferResized;
   }
 
+  [[nodiscard]] constexpr bool VulkanContext::getHasMemoryBudget() const noexcept
+  {
+    return HasMemoryBudget;
+  }
+
+  [[nodiscard]] constexpr bool VulkanContext::getHasHostImport() const noexcept
+  {
+    return HasHostImport;
+  }
+
+  [[nodiscard]] constexpr VkDeviceSize VulkanContext::getHostImportAlignment() const noexcept
+  {
+    return HostImportAlignment;
+  }
+
   [[nodiscard]] constexpr VkRenderPass VulkanContext::getRenderPass() const noexcept
   {
     return RenderPass;
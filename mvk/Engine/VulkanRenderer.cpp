@@ -1,41 +1,100 @@
 #include "VulkanRenderer.hpp"
 
+#include "Detail/MappedFile.hpp"
 #include "Detail/Misc.hpp"
-#include "Detail/Readers.hpp"
+#include "Engine/AllocatorContext.hpp"
 #include "Engine/Misc.hpp"
 #include "Engine/Model.hpp"
 #include "Engine/VulkanContext.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <thread>
+#include <utility>
 
 namespace Mvk::Engine
 {
-  VulkanRenderer::VulkanRenderer() noexcept
+  namespace
   {
-    VulkanContext::the().initialize( "Stan Loona", { 600, 600 } );
+    // Processed OBJs and PNGs, kept across runs
+    [[nodiscard]] std::filesystem::path getAssetCacheDir() noexcept
+    {
+      return "../../assets/.cache";
+    }
 
-    auto const Device = VulkanContext::the().getDevice();
+    // What uploadModel copies, the mips generated on the GPU aside
+    [[nodiscard]] VkDeviceSize getUploadSize( ModelData const & Data ) noexcept
+    {
+      auto Size = VkDeviceSize( std::size( Data.Mesh.VtxBytes ) + std::size( Data.Mesh.Idxs ) * sizeof( uint32_t ) );
 
-    initLayouts();
-    initPools();
+      for ( auto const Level : Data.Tex.Levels )
+      {
+        Size += std::size( Level );
+      }
 
-    auto CmdBuffAllocInfo               = VkCommandBufferAllocateInfo();
-    CmdBuffAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    CmdBuffAllocInfo.commandPool        = CmdPool;
-    CmdBuffAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    CmdBuffAllocInfo.commandBufferCount = 1;
+      return Size;
+    }
 
-    auto Result = vkAllocateCommandBuffers( Device, &CmdBuffAllocInfo, &CurrentCmdBuff );
-    MVK_VERIFY( Result == VK_SUCCESS );
+    // First level of the coarse ones a streamed texture is created with and never gives back
+    [[nodiscard]] uint32_t getTailLvl( size_t Width, size_t Height, uint32_t LvlCnt ) noexcept
+    {
+      auto Lvl = uint32_t( 0 );
 
-    auto CmdBuffBeginInfo             = VkCommandBufferBeginInfo();
-    CmdBuffBeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    CmdBuffBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    CmdBuffBeginInfo.flags            = 0;
-    CmdBuffBeginInfo.pInheritanceInfo = nullptr;
+      while ( Lvl + 1 < LvlCnt && ( std::max( Width, Height ) >> Lvl ) > VulkanRenderer::StreamTailDim )
+      {
+        ++Lvl;
+      }
 
-    vkBeginCommandBuffer( CurrentCmdBuff, &CmdBuffBeginInfo );
+      return Lvl;
+    }
+
+    // About a texel per pixel when the texture is spread once over the bounding sphere of the mesh, which is about as much
+    // as it can show
+    [[nodiscard]] uint32_t calcWantedLvl( PVM const & Pvm, pos_dequant const & Dequant, ImgObj const & Tex, VkExtent2D Extent ) noexcept
+    {
+      // The dequantization maps [-1, 1] onto the bounds, the model matrix can scale them further
+      auto const Center = Pvm.view * Pvm.model * glm::vec4( glm::vec3( Dequant.offset ), 1.0F );
+      auto const Scale  = std::max( { glm::length( glm::vec3( Pvm.model[0] ) ),
+                                      glm::length( glm::vec3( Pvm.model[1] ) ),
+                                      glm::length( glm::vec3( Pvm.model[2] ) ) } );
+      auto const Radius = glm::length( glm::vec3( Dequant.scale ) ) * Scale;
+      auto const Dist   = -Center.z;
+
+      // Behind the camera
+      if ( Dist < -Radius )
+      {
+        return Tex.getChainLvl() - 1;
+      }
+
+      // Around the camera
+      if ( Dist <= Radius )
+      {
+        return 0;
+      }
+
+      auto const Diameter = Radius / Dist * std::abs( Pvm.proj[1][1] ) * static_cast<float>( Extent.height );
+      auto const TexDim   = static_cast<float>( std::max( Tex.getWidth(), Tex.getHeight() ) );
+
+      if ( Diameter >= TexDim )
+      {
+        return 0;
+      }
+
+      return std::min( static_cast<uint32_t>( std::log2( TexDim / std::max( Diameter, 1.0F ) ) ), Tex.getChainLvl() - 1 );
+    }
+
+  }  // namespace
+
+  VulkanRenderer::VulkanRenderer() noexcept
+  {
+    VulkanContext::the().initialize( "Stan Loona", { 600, 600 } );
+
+    initLayouts();
+    initPools();
+    initImmediateContext();
 
     initSwapchain();
     initDepthImg();
@@ -45,26 +104,21 @@ namespace Mvk::Engine
     initPipelines();
     initCmdBuffs();
     initSync();
+    initDynamicBuff();
+    initUploadQueue();
+    initModelLoader();
 
-    vkEndCommandBuffer( CurrentCmdBuff );
-
-    auto SubmitInfo               = VkSubmitInfo();
-    SubmitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    SubmitInfo.commandBufferCount = 1;
-    SubmitInfo.pCommandBuffers    = &CurrentCmdBuff;
-
-    auto const GfxQueue = VulkanContext::the().getGraphicsQueue();
-
-    vkQueueSubmit( GfxQueue, 1, &SubmitInfo, nullptr );
-    vkQueueWaitIdle( GfxQueue );
-
-    vkFreeCommandBuffers( Device, CmdPool, 1, &CurrentCmdBuff );
-
-    CurrentCmdBuff = CmdBuffs[CurrentBuffIdx];
+    // Frames go to the same queue after it, so nothing has to wait on the CPU
+    static_cast<void>( Immediate->flush() );
   }
 
   VulkanRenderer::~VulkanRenderer() noexcept
   {
+    dstrModelLoader();
+    VulkanContext::the().flushGarbage();
+    dstrImmediateContext();
+    dstrUploadQueue();
+    dstrDynamicBuff();
     dstrSync();
     dstrCmdBuffs();
     dstrPipelines();
@@ -85,7 +139,7 @@ namespace Mvk::Engine
 
     auto UniformDescriptorSetLayBind               = VkDescriptorSetLayoutBinding();
     UniformDescriptorSetLayBind.binding            = 0;
-    UniformDescriptorSetLayBind.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    UniformDescriptorSetLayBind.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     UniformDescriptorSetLayBind.descriptorCount    = 1;
     UniformDescriptorSetLayBind.stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
     UniformDescriptorSetLayBind.pImmutableSamplers = nullptr;
@@ -109,12 +163,17 @@ namespace Mvk::Engine
 
     auto DescriptorSetLays = std::array{ UboTexDescSetLayout };
 
+    auto DequantPushConstRange       = VkPushConstantRange();
+    DequantPushConstRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    DequantPushConstRange.offset     = 0;
+    DequantPushConstRange.size       = sizeof( pos_dequant );
+
     auto PipelineLayCrtInfo                   = VkPipelineLayoutCreateInfo();
     PipelineLayCrtInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     PipelineLayCrtInfo.setLayoutCount         = static_cast<uint32_t>( std::size( DescriptorSetLays ) );
     PipelineLayCrtInfo.pSetLayouts            = std::data( DescriptorSetLays );
-    PipelineLayCrtInfo.pushConstantRangeCount = 0;
-    PipelineLayCrtInfo.pPushConstantRanges    = nullptr;
+    PipelineLayCrtInfo.pushConstantRangeCount = 1;
+    PipelineLayCrtInfo.pPushConstantRanges    = &DequantPushConstRange;
 
     Result = vkCreatePipelineLayout( Device, &PipelineLayCrtInfo, nullptr, &MainPipelineLayout );
 
@@ -134,13 +193,21 @@ namespace Mvk::Engine
     auto Result = vkCreateCommandPool( Device, &CmdPoolCrtInfo, nullptr, &CmdPool );
     MVK_VERIFY( Result == VK_SUCCESS );
 
+    DescPools.push_back( crtDescPool() );
+  }
+
+  [[nodiscard]] VkDescriptorPool VulkanRenderer::crtDescPool() noexcept
+  {
+    auto const Device = VulkanContext::the().getDevice();
+
+    // Every set is one UBO and one texture, see initLayouts
     auto UniformDescriptorPoolSize            = VkDescriptorPoolSize();
-    UniformDescriptorPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    UniformDescriptorPoolSize.descriptorCount = 32;
+    UniformDescriptorPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    UniformDescriptorPoolSize.descriptorCount = DescSetsPerPool;
 
     auto SamplerDescriptorPoolSize            = VkDescriptorPoolSize();
     SamplerDescriptorPoolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    SamplerDescriptorPoolSize.descriptorCount = 32;
+    SamplerDescriptorPoolSize.descriptorCount = DescSetsPerPool;
 
     auto const DescriptorPoolSizes = std::array{ UniformDescriptorPoolSize, SamplerDescriptorPoolSize };
 
@@ -148,10 +215,14 @@ namespace Mvk::Engine
     DescriptorPoolCrtInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     DescriptorPoolCrtInfo.poolSizeCount = static_cast<uint32_t>( std::size( DescriptorPoolSizes ) );
     DescriptorPoolCrtInfo.pPoolSizes    = std::data( DescriptorPoolSizes );
-    DescriptorPoolCrtInfo.maxSets       = 128;
+    DescriptorPoolCrtInfo.maxSets       = DescSetsPerPool;
     DescriptorPoolCrtInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
 
-    vkCreateDescriptorPool( Device, &DescriptorPoolCrtInfo, nullptr, &DescPool );
+    auto DescPool = VkDescriptorPool();
+    auto Result   = vkCreateDescriptorPool( Device, &DescriptorPoolCrtInfo, nullptr, &DescPool );
+    MVK_VERIFY( Result == VK_SUCCESS );
+
+    return DescPool;
   }
 
   void VulkanRenderer::initSwapchain() noexcept
@@ -255,27 +326,18 @@ namespace Mvk::Engine
     DepthImgCreateInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
     DepthImgCreateInfo.flags         = 0;
 
-    auto const Device         = VulkanContext::the().getDevice();
-    auto const PhysicalDevice = VulkanContext::the().getPhysicalDevice();
+    auto const Device = VulkanContext::the().getDevice();
 
     auto Result = vkCreateImage( Device, &DepthImgCreateInfo, nullptr, &DepthImg );
     MVK_VERIFY( Result == VK_SUCCESS );
 
-    auto DepthImgReq = VkMemoryRequirements();
-    vkGetImageMemoryRequirements( Device, DepthImg, &DepthImgReq );
+    // Not relocatable, it's recreated with the swapchain anyways
+    auto const DepthImgAlloc = AllocatorContext::the().allocate( AllocationType::GpuOnly, DepthImg );
+    MVK_VERIFY( DepthImgAlloc.has_value() );
 
-    auto const MemTypeIdx = Detail::queryMemType( PhysicalDevice, DepthImgReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
+    DepthImgID = DepthImgAlloc->ID;
 
-    MVK_VERIFY( MemTypeIdx.has_value() );
-
-    auto DepthImgMemAllocInfo            = VkMemoryAllocateInfo();
-    DepthImgMemAllocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    DepthImgMemAllocInfo.allocationSize  = DepthImgReq.size;
-    DepthImgMemAllocInfo.memoryTypeIndex = MemTypeIdx.value();
-    Result                               = vkAllocateMemory( Device, &DepthImgMemAllocInfo, nullptr, &DepthImgMem );
-    MVK_VERIFY( Result == VK_SUCCESS );
-
-    Result = vkBindImageMemory( Device, DepthImg, DepthImgMem, 0 );
+    Result = vkBindImageMemory( Device, DepthImg, DepthImgAlloc->Mem, DepthImgAlloc->Off );
     MVK_VERIFY( Result == VK_SUCCESS );
 
     auto DepthImgViewCrtInfo                            = VkImageViewCreateInfo();
@@ -296,7 +358,8 @@ namespace Mvk::Engine
     Result = vkCreateImageView( Device, &DepthImgViewCrtInfo, nullptr, &DepthImgView );
     MVK_VERIFY( Result == VK_SUCCESS );
 
-    Detail::transitionImgLayout( CurrentCmdBuff, DepthImg, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1 );
+    Detail::transitionImgLayout(
+      Immediate->getCmdBuff(), DepthImg, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1 );
   }
 
   void VulkanRenderer::initFramebuffers() noexcept
@@ -402,7 +465,9 @@ namespace Mvk::Engine
 
   void VulkanRenderer::initShaders() noexcept
   {
-    auto const VtxCode = Detail::readFile( "../../shaders/vert.spv" );
+    // SPIR-V is read straight out of the mapping, the pages are 4 byte aligned
+    auto const VtxFile = Detail::MappedFile( ModelVtxShader );
+    auto const VtxCode = VtxFile.getData();
 
     auto VtxShaderModuleCrtInfo     = VkShaderModuleCreateInfo();
     VtxShaderModuleCrtInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -414,7 +479,8 @@ namespace Mvk::Engine
     auto Result = vkCreateShaderModule( Device, &VtxShaderModuleCrtInfo, nullptr, &VtxShader );
     MVK_VERIFY( Result == VK_SUCCESS );
 
-    auto const FragCode = Detail::readFile( "../../shaders/frag.spv" );
+    auto const FragFile = Detail::MappedFile( "../shaders/frag.spv" );
+    auto const FragCode = FragFile.getData();
 
     auto FragShaderModuleCrtInfo     = VkShaderModuleCreateInfo();
     FragShaderModuleCrtInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -427,37 +493,7 @@ namespace Mvk::Engine
 
   void VulkanRenderer::initPipelines() noexcept
   {
-    auto VtxInputBindDesc      = VkVertexInputBindingDescription();
-    VtxInputBindDesc.binding   = 0;
-    VtxInputBindDesc.stride    = sizeof( vertex );
-    VtxInputBindDesc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-    auto PosVtxInputAttrDesc     = VkVertexInputAttributeDescription();
-    PosVtxInputAttrDesc.binding  = 0;
-    PosVtxInputAttrDesc.location = 0;
-    PosVtxInputAttrDesc.format   = VK_FORMAT_R32G32B32_SFLOAT;
-    PosVtxInputAttrDesc.offset   = offsetof( vertex, pos );
-
-    auto ColorVtxInputAttrDesc     = VkVertexInputAttributeDescription();
-    ColorVtxInputAttrDesc.binding  = 0;
-    ColorVtxInputAttrDesc.location = 1;
-    ColorVtxInputAttrDesc.format   = VK_FORMAT_R32G32B32_SFLOAT;
-    ColorVtxInputAttrDesc.offset   = offsetof( vertex, color );
-
-    auto TexCoordVtxInputAttrDesc     = VkVertexInputAttributeDescription();
-    TexCoordVtxInputAttrDesc.binding  = 0;
-    TexCoordVtxInputAttrDesc.location = 2;
-    TexCoordVtxInputAttrDesc.format   = VK_FORMAT_R32G32_SFLOAT;
-    TexCoordVtxInputAttrDesc.offset   = offsetof( vertex, texture_coord );
-
-    auto const VtxAttrs = std::array{ PosVtxInputAttrDesc, ColorVtxInputAttrDesc, TexCoordVtxInputAttrDesc };
-
-    auto PipelineVtxInputStateCrtInfo                            = VkPipelineVertexInputStateCreateInfo();
-    PipelineVtxInputStateCrtInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    PipelineVtxInputStateCrtInfo.vertexBindingDescriptionCount   = 1;
-    PipelineVtxInputStateCrtInfo.pVertexBindingDescriptions      = &VtxInputBindDesc;
-    PipelineVtxInputStateCrtInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>( std::size( VtxAttrs ) );
-    PipelineVtxInputStateCrtInfo.pVertexAttributeDescriptions    = std::data( VtxAttrs );
+    auto const PipelineVtxInputStateCrtInfo = ModelVtxLayout::getInputState();
 
     auto PipelineVtxInputAssemStateCrtInfo                   = VkPipelineInputAssemblyStateCreateInfo();
     PipelineVtxInputAssemStateCrtInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -602,6 +638,37 @@ namespace Mvk::Engine
     ImgInFlightFences.resize( SwapchainImgCount, std::nullopt );
   }
 
+  void VulkanRenderer::initDynamicBuff() noexcept
+  {
+    auto const Usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    DynamicBuff      = std::make_unique<DynamicBuffObj>( DynamicBuffRegionSize, MaxFramesInFlight, Usage );
+  }
+
+  void VulkanRenderer::initUploadQueue() noexcept
+  {
+    Uploads = std::make_unique<UploadQueue>( StagingRingSize );
+  }
+
+  void VulkanRenderer::initModelLoader() noexcept
+  {
+    // BC needs textureCompressionBC, which VulkanContext enables when it's there
+    auto TexFormats = TexFormatMask();
+
+    for ( auto Idx = size_t( 0 ); Idx < Detail::TexFormatCnt; ++Idx )
+    {
+      TexFormats[Idx] = ImgObj::isSupported( static_cast<Detail::TexFormat>( Idx ) );
+    }
+
+    // readObj already spreads a big file over every core, a few workers are enough to keep the IO going
+    Loader = std::make_unique<ModelLoader>( std::clamp( std::thread::hardware_concurrency() / 2, 1U, 4U ), TexFormats, getAssetCacheDir() );
+  }
+
+  void VulkanRenderer::initImmediateContext() noexcept
+  {
+    auto const & Ctx = VulkanContext::the();
+    Immediate        = std::make_unique<ImmediateContext>( Ctx.getGraphicsQueue(), Ctx.getGraphicsQueueFamilyIdx() );
+  }
+
   void VulkanRenderer::dstrLayouts() noexcept
   {
     auto const Device = VulkanContext::the().getDevice();
@@ -613,12 +680,18 @@ namespace Mvk::Engine
   {
     auto const Device = VulkanContext::the().getDevice();
 
-    for ( auto const DescSet : ModelDescSets )
+    for ( auto const & DescSet : ModelDescSets )
     {
-      vkFreeDescriptorSets( Device, DescPool, 1, &DescSet );
+      if ( DescSet.Pool != VK_NULL_HANDLE )
+      {
+        vkFreeDescriptorSets( Device, DescSet.Pool, 1, &DescSet.Set );
+      }
     }
 
-    vkDestroyDescriptorPool( Device, DescPool, nullptr );
+    for ( auto const DescPool : DescPools )
+    {
+      vkDestroyDescriptorPool( Device, DescPool, nullptr );
+    }
     vkDestroyCommandPool( Device, CmdPool, nullptr );
   }
 
@@ -637,8 +710,8 @@ namespace Mvk::Engine
   {
     auto const Device = VulkanContext::the().getDevice();
     vkDestroyImageView( Device, DepthImgView, nullptr );
-    vkFreeMemory( Device, DepthImgMem, nullptr );
     vkDestroyImage( Device, DepthImg, nullptr );
+    AllocatorContext::the().free( DepthImgID );
   }
 
   void VulkanRenderer::dstrFramebuffers() noexcept
@@ -683,27 +756,28 @@ namespace Mvk::Engine
     }
   }
 
-  void VulkanRenderer::recreateAfterFramebufferChange() noexcept
+  void VulkanRenderer::dstrDynamicBuff() noexcept
   {
-    auto const Device = VulkanContext::the().getDevice();
-
-    auto CmdBuffAllocInfo               = VkCommandBufferAllocateInfo();
-    CmdBuffAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    CmdBuffAllocInfo.commandPool        = CmdPool;
-    CmdBuffAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    CmdBuffAllocInfo.commandBufferCount = 1;
+    DynamicBuff.reset();
+  }
 
-    auto Result = vkAllocateCommandBuffers( Device, &CmdBuffAllocInfo, &CurrentCmdBuff );
-    MVK_VERIFY( Result == VK_SUCCESS );
+  void VulkanRenderer::dstrUploadQueue() noexcept
+  {
+    Uploads.reset();
+  }
 
-    auto CmdBuffBeginInfo             = VkCommandBufferBeginInfo();
-    CmdBuffBeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    CmdBuffBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    CmdBuffBeginInfo.flags            = 0;
-    CmdBuffBeginInfo.pInheritanceInfo = nullptr;
+  void VulkanRenderer::dstrImmediateContext() noexcept
+  {
+    Immediate.reset();
+  }
 
-    vkBeginCommandBuffer( CurrentCmdBuff, &CmdBuffBeginInfo );
+  void VulkanRenderer::dstrModelLoader() noexcept
+  {
+    Loader.reset();
+  }
 
+  void VulkanRenderer::recreateAfterFramebufferChange() noexcept
+  {
     dstrSwapchain();
     SwapchainImgViews.clear();
     initSwapchain();
@@ -725,100 +799,397 @@ namespace Mvk::Engine
     ImgInFlightFences.clear();
     initSync();
 
-    vkEndCommandBuffer( CurrentCmdBuff );
+    // Frames go to the same queue after it, so nothing has to wait on the CPU
+    static_cast<void>( Immediate->flush() );
+  }
 
-    auto SubmitInfo               = VkSubmitInfo();
-    SubmitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    SubmitInfo.commandBufferCount = 1;
-    SubmitInfo.pCommandBuffers    = &CurrentCmdBuff;
+  [[nodiscard]] ModelID VulkanRenderer::loadModel( ModelPaths const & Paths ) noexcept
+  {
+    auto const ID   = reserveModel();
+    auto       Data = readModelData( Paths, Loader->getTexFormats(), Loader->getCache() );
 
-    auto const GfxQueue = VulkanContext::the().getGraphicsQueue();
+    // Shows up like an async load once there's room for it
+    if ( !uploadModel( ID, Data ) )
+    {
+      DeferredModels.push_back( { ID, std::move( Data ) } );
+    }
 
-    vkQueueSubmit( GfxQueue, 1, &SubmitInfo, nullptr );
-    vkQueueWaitIdle( GfxQueue );
+    return ID;
+  }
 
-    vkFreeCommandBuffers( Device, CmdPool, 1, &CurrentCmdBuff );
+  [[nodiscard]] ModelID VulkanRenderer::loadModelAsync( ModelPaths const & Paths ) noexcept
+  {
+    auto const ID = reserveModel();
+    Loader->push( ID, Paths );
+    return ID;
+  }
 
-    CurrentCmdBuff = CmdBuffs[CurrentBuffIdx];
+  [[nodiscard]] bool VulkanRenderer::isResident( ModelID ID ) const noexcept
+  {
+    return Models[ID] != nullptr && std::find( std::begin( PendingModels ), std::end( PendingModels ), ID ) == std::end( PendingModels );
   }
 
-  [[nodiscard]] ModelID VulkanRenderer::loadModel() noexcept
+  [[nodiscard]] ModelID VulkanRenderer::reserveModel() noexcept
   {
-    auto const Device = VulkanContext::the().getDevice();
+    Models.push_back( nullptr );
+    ModelDescSets.emplace_back();
+    TexWantedLvls.push_back( NotDrawnLvl );
+    return std::size( Models ) - 1;
+  }
 
-    // Kind of dumb doing this everytime a commandbuffer is used outside draw
-    auto CmdBuffAllocInfo               = VkCommandBufferAllocateInfo();
-    CmdBuffAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    CmdBuffAllocInfo.commandPool        = CmdPool;
-    CmdBuffAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    CmdBuffAllocInfo.commandBufferCount = 1;
+  [[nodiscard]] bool VulkanRenderer::uploadModel( ModelID ID, ModelData const & Data ) noexcept
+  {
+    auto const & Mesh     = Data.Mesh;
+    auto const   VtxBytes = Mesh.VtxBytes;
+    auto const   IdxBytes = std::as_bytes( Mesh.Idxs );
+    auto const & Tex      = Data.Tex;
 
-    auto Result = vkAllocateCommandBuffers( Device, &CmdBuffAllocInfo, &CurrentCmdBuff );
-    MVK_VERIFY( Result == VK_SUCCESS );
+    // readModelData only gives vertices of the layout
+    MVK_VERIFY( std::size( VtxBytes ) == size_t( Mesh.VtxCnt ) * ModelVtxLayout::Stride );
 
-    auto CmdBuffBeginInfo             = VkCommandBufferBeginInfo();
-    CmdBuffBeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    CmdBuffBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    CmdBuffBeginInfo.flags            = 0;
-    CmdBuffBeginInfo.pInheritanceInfo = nullptr;
+    // A lone RGBA8 level is the PNG, its mips are blitted once the model is acquired
+    auto const TexLvlCnt = Tex.Format == Detail::TexFormat::Rgba8 && std::size( Tex.Levels ) == 1
+                           ? uint32_t( 0 )
+                           : static_cast<uint32_t>( std::size( Tex.Levels ) );
 
-    vkBeginCommandBuffer( CurrentCmdBuff, &CmdBuffBeginInfo );
-    auto [Texture, Width, Height] = Detail::loadTex( "../../assets/viking_room.png" );
-    auto [Vtx, Idx]               = Detail::readObj( "../../assets/viking_room.obj" );
+    // Precomputed levels of a mapped file start with the coarse ones, streamTextures brings in the rest
+    auto const IsStreamed  = Tex.File != nullptr && TexLvlCnt != 0;
+    auto const TexFirstLvl = IsStreamed ? getTailLvl( Tex.Width, Tex.Height, TexLvlCnt ) : uint32_t( 0 );
 
-    auto const VtxBytes = std::as_bytes( std::span( Vtx ) );
-    auto const IdxBytes = std::as_bytes( std::span( Idx ) );
+    auto NewModel = std::make_unique<Model>(
+      std::size( VtxBytes ), std::size( IdxBytes ), Tex.Width, Tex.Height, Tex.Format, TexLvlCnt, TexFirstLvl );
 
-    auto NewModel = std::make_unique<Model>( std::size( VtxBytes ), std::size( IdxBytes ), sizeof( PVM ), Width, Height );
-    NewModel->Vbo.map( CurrentCmdBuff, VtxBytes );
-    NewModel->Ibo.map( CurrentCmdBuff, Idx );
-    NewModel->Tex.transitionLayout( CurrentCmdBuff, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL );
-    NewModel->Tex.map( CurrentCmdBuff, std::as_bytes( std::span( Texture ) ) );
-    NewModel->Tex.generateMips( CurrentCmdBuff );
+    if ( !NewModel->getIsAllocated() )
+    {
+      return false;
+    }
 
-    Models.push_back( std::move( NewModel ) );
+    NewModel->Dequant = Mesh.Dequant;
 
-    auto SubmitInfo               = VkSubmitInfo();
-    SubmitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    SubmitInfo.commandBufferCount = 1;
-    SubmitInfo.pCommandBuffers    = &CurrentCmdBuff;
+    if ( IsStreamed )
+    {
+      NewModel->TexSrc = Tex;
+    }
 
-    auto const GfxQueue = VulkanContext::the().getGraphicsQueue();
+    // Only the copies go through the upload queue, the mips are generated by the frame that acquires the model. Nothing is
+    // submitted until the next beginDraw, so loading any number of models costs one submission
+    auto const CmdBuff = Uploads->getCmdBuff();
+    auto &     Stage   = Uploads->getStaging();
 
-    vkEndCommandBuffer( CurrentCmdBuff );
-    vkQueueSubmit( GfxQueue, 1, &SubmitInfo, nullptr );
-    vkQueueWaitIdle( GfxQueue );
+    // Spans into a mapping are staged from the file, big ones are then read by the GPU straight from the page cache.
+    // Buffers the CPU can write to get the bytes directly
+    if ( Mesh.File != nullptr && !NewModel->Vbo.getIsMapped() )
+    {
+      NewModel->Vbo.map( CmdBuff, Stage, Stage.stage( Mesh.File, Mesh.File->getOff( VtxBytes ), std::size( VtxBytes ) ) );
+    }
+    else
+    {
+      NewModel->Vbo.map( CmdBuff, Stage, VtxBytes );
+    }
 
-    vkFreeCommandBuffers( Device, CmdPool, 1, &CurrentCmdBuff );
+    if ( Mesh.File != nullptr && !NewModel->Ibo.getIsMapped() )
+    {
+      NewModel->Ibo.map( CmdBuff, Stage, Stage.stage( Mesh.File, Mesh.File->getOff( IdxBytes ), std::size( IdxBytes ) ) );
+    }
+    else
+    {
+      NewModel->Ibo.map( CmdBuff, Stage, Mesh.Idxs );
+    }
 
-    CurrentCmdBuff = CmdBuffs[CurrentBuffIdx];
+    NewModel->Tex.transitionLayout( CmdBuff, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL );
+
+    for ( auto Lvl = TexFirstLvl; Lvl < std::size( Tex.Levels ); ++Lvl )
+    {
+      auto const Level = Tex.Levels[Lvl];
+
+      if ( Tex.File != nullptr )
+      {
+        NewModel->Tex.map( CmdBuff, Stage, Stage.stage( Tex.File, Tex.File->getOff( Level ), std::size( Level ) ), Lvl );
+      }
+      else
+      {
+        NewModel->Tex.map( CmdBuff, Stage, Level, Lvl );
+      }
+    }
+
+    // Mapped buffers were written by the CPU, the upload queue never touched them
+    if ( !NewModel->Vbo.getIsMapped() )
+    {
+      Uploads->release( NewModel->Vbo.getBuff(), NewModel->Vbo.getOff(), NewModel->Vbo.getSize() );
+    }
+
+    if ( !NewModel->Ibo.getIsMapped() )
+    {
+      Uploads->release( NewModel->Ibo.getBuff(), NewModel->Ibo.getOff(), NewModel->Ibo.getSize() );
+    }
+    Uploads->release( NewModel->Tex.getImg(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, NewModel->Tex.getMipLvl() );
+
+    Models[ID]        = std::move( NewModel );
+    ModelDescSets[ID] = crtDescSet( *Models[ID] );
+    PendingModels.push_back( ID );
+
+    return true;
+  }
+
+  void VulkanRenderer::uploadLoadedModels() noexcept
+  {
+    auto Uploaded = VkDeviceSize( 0 );
+
+    while ( Uploaded < AsyncUploadByteBudget )
+    {
+      // The ones that didn't fit before go first
+      auto Loaded = std::optional<ModelLoader::Result>();
+
+      if ( !std::empty( DeferredModels ) )
+      {
+        Loaded = std::move( DeferredModels.front() );
+        DeferredModels.pop_front();
+      }
+      else
+      {
+        Loaded = Loader->pop();
+      }
+
+      if ( !Loaded.has_value() )
+      {
+        return;
+      }
+
+      // The staging copies are done once this returns, the mapping or the parsed vertices can go. When it doesn't fit the
+      // rest likely won't either, the evictions of streamTextures take a few frames to give the memory back
+      if ( !uploadModel( Loaded->ID, Loaded->Data ) )
+      {
+        DeferredModels.push_front( std::move( *Loaded ) );
+        return;
+      }
+
+      Uploaded += getUploadSize( Loaded->Data );
+    }
+  }
+
+  void VulkanRenderer::streamTextures() noexcept
+  {
+    struct Streamed
+    {
+      ModelID  ID;
+      uint32_t FirstLvl;
+      uint32_t WantedLvl;
+      uint32_t TailLvl;
+      uint32_t NewFirstLvl;
+    };
+
+    auto const getSize = [this]( ModelID ID, uint32_t FromLvl, uint32_t ToLvl )
+    {
+      auto const & Tex  = Models[ID]->Tex;
+      auto         Size = VkDeviceSize( 0 );
+
+      for ( auto Lvl = FromLvl; Lvl < ToLvl; ++Lvl )
+      {
+        Size += Detail::getLevelSize( Tex.getFormat(), Tex.getWidth(), Tex.getHeight(), Lvl );
+      }
+
+      return Size;
+    };
+
+    // Models that didn't fit get the room of the streamed levels, evicted like any other surplus
+    auto Budget = TexBudget;
+
+    for ( auto const & Deferred : DeferredModels )
+    {
+      Budget -= std::min( Budget, getUploadSize( Deferred.Data ) );
+    }
+
+    auto Textures = std::vector<Streamed>();
+    auto Resident = VkDeviceSize( 0 );
+
+    for ( auto ID = ModelID( 0 ); ID < std::size( Models ); ++ID )
+    {
+      auto const WantedLvl = std::exchange( TexWantedLvls[ID], NotDrawnLvl );
+
+      if ( !isResident( ID ) || std::empty( Models[ID]->TexSrc.Levels ) )
+      {
+        continue;
+      }
+
+      auto &     Tex     = Models[ID]->Tex;
+      auto const TailLvl = getTailLvl( Tex.getWidth(), Tex.getHeight(), Tex.getChainLvl() );
+
+      Textures.push_back( { ID, Tex.getFirstLvl(), std::min( WantedLvl, TailLvl ), TailLvl, Tex.getFirstLvl() } );
+      Resident += Tex.getResidentSize();
+    }
+
+    // One level at a time, so every texture gets its coarse levels before any gets its finest
+    auto Starved = std::vector<Streamed *>();
+    auto Surplus = std::vector<Streamed *>();
+    auto Needed  = VkDeviceSize( 0 );
+
+    for ( auto & Texture : Textures )
+    {
+      if ( Texture.WantedLvl < Texture.FirstLvl )
+      {
+        Starved.push_back( &Texture );
+        Needed += getSize( Texture.ID, Texture.FirstLvl - 1, Texture.FirstLvl );
+      }
+      else if ( Texture.WantedLvl > Texture.FirstLvl )
+      {
+        Surplus.push_back( &Texture );
+      }
+    }
+
+    auto const byGap = []( Streamed const * Lhs, Streamed const * Rhs )
+    {
+      return std::max( Lhs->FirstLvl, Lhs->WantedLvl ) - std::min( Lhs->FirstLvl, Lhs->WantedLvl )
+           > std::max( Rhs->FirstLvl, Rhs->WantedLvl ) - std::min( Rhs->FirstLvl, Rhs->WantedLvl );
+    };
+
+    std::sort( std::begin( Starved ), std::end( Starved ), byGap );
+    std::sort( std::begin( Surplus ), std::end( Surplus ), byGap );
+
+    // Room is made with what the last frame didn't need, the textures it didn't draw at all go first
+    for ( auto * Texture : Surplus )
+    {
+      if ( Resident + Needed <= Budget )
+      {
+        break;
+      }
+
+      Resident             -= getSize( Texture->ID, Texture->FirstLvl, Texture->WantedLvl );
+      Texture->NewFirstLvl  = Texture->WantedLvl;
+    }
+
+    // Only after the budget went down, everything left is needed so the finest levels of the biggest textures go
+    while ( Resident > Budget )
+    {
+      auto * Biggest = static_cast<Streamed *>( nullptr );
+
+      for ( auto & Texture : Textures )
+      {
+        if ( Texture.NewFirstLvl < Texture.TailLvl
+             && ( Biggest == nullptr
+                  || getSize( Texture.ID, Texture.NewFirstLvl, Texture.NewFirstLvl + 1 )
+                       > getSize( Biggest->ID, Biggest->NewFirstLvl, Biggest->NewFirstLvl + 1 ) ) )
+        {
+          Biggest = &Texture;
+        }
+      }
+
+      if ( Biggest == nullptr )
+      {
+        break;
+      }
+
+      Resident -= getSize( Biggest->ID, Biggest->NewFirstLvl, Biggest->NewFirstLvl + 1 );
+      ++Biggest->NewFirstLvl;
+    }
+
+    auto Uploaded = VkDeviceSize( 0 );
+
+    for ( auto * Texture : Starved )
+    {
+      auto const Size = getSize( Texture->ID, Texture->FirstLvl - 1, Texture->FirstLvl );
+
+      if ( Texture->NewFirstLvl != Texture->FirstLvl || Resident + Size > Budget )
+      {
+        continue;
+      }
+
+      if ( Uploaded != 0 && Uploaded + Size > TexStreamByteBudget )
+      {
+        break;
+      }
+
+      Resident             += Size;
+      Uploaded             += Size;
+      Texture->NewFirstLvl  = Texture->FirstLvl - 1;
+    }
+
+    for ( auto const & Texture : Textures )
+    {
+      if ( Texture.NewFirstLvl == Texture.FirstLvl )
+      {
+        continue;
+      }
+
+      auto &     Target = *Models[Texture.ID];
+      auto const IsGrow = Texture.NewFirstLvl < Texture.FirstLvl;
+
+      // Evicting only needs the frame's command buffer, no need to start an upload for it
+      auto const CmdBuff = IsGrow ? Uploads->getCmdBuff() : VK_NULL_HANDLE;
+
+      if ( !Target.Tex.beginResidency( CmdBuff, Uploads->getStaging(), Texture.NewFirstLvl, Target.TexSrc ) )
+      {
+        continue;
+      }
+
+      if ( IsGrow )
+      {
+        Uploads->release( Target.Tex.getPendingImg(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, Texture.FirstLvl - Texture.NewFirstLvl );
+      }
+
+      StreamingModels.push_back( Texture.ID );
+    }
+  }
+
+  void VulkanRenderer::finishStreaming() noexcept
+  {
+    for ( auto const ID : StreamingModels )
+    {
+      Models[ID]->Tex.endResidency( CurrentCmdBuff );
+      StaleDescSets.push_back( ID );
+    }
+
+    StreamingModels.clear();
+  }
+
+  [[nodiscard]] VulkanRenderer::DescSetAlloc VulkanRenderer::crtDescSet( Model & Target ) noexcept
+  {
+    auto const Device = VulkanContext::the().getDevice();
 
     auto DescSetAllocInfo               = VkDescriptorSetAllocateInfo();
     DescSetAllocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    DescSetAllocInfo.descriptorPool     = DescPool;
     DescSetAllocInfo.descriptorSetCount = 1;
     DescSetAllocInfo.pSetLayouts        = &UboTexDescSetLayout;
 
     auto DescSet = VkDescriptorSet();
-    Result       = vkAllocateDescriptorSets( Device, &DescSetAllocInfo, &DescSet );
+    auto Result  = VkResult( VK_ERROR_OUT_OF_POOL_MEMORY );
+
+    // Freed sets go back to the pool they came from, so the older pools are tried first
+    for ( auto const DescPool : DescPools )
+    {
+      DescSetAllocInfo.descriptorPool = DescPool;
+      Result                          = vkAllocateDescriptorSets( Device, &DescSetAllocInfo, &DescSet );
+
+      if ( Result != VK_ERROR_OUT_OF_POOL_MEMORY && Result != VK_ERROR_FRAGMENTED_POOL )
+      {
+        break;
+      }
+    }
+
+    if ( Result == VK_ERROR_OUT_OF_POOL_MEMORY || Result == VK_ERROR_FRAGMENTED_POOL )
+    {
+      DescPools.push_back( crtDescPool() );
+      DescSetAllocInfo.descriptorPool = DescPools.back();
+      Result                          = vkAllocateDescriptorSets( Device, &DescSetAllocInfo, &DescSet );
+    }
+
     MVK_VERIFY( Result == VK_SUCCESS );
 
     auto UboDescriptorInfo   = VkDescriptorBufferInfo();
-    UboDescriptorInfo.buffer = Models.back()->Ubo.getBuffer();
+    UboDescriptorInfo.buffer = DynamicBuff->getBuff();
     UboDescriptorInfo.offset = 0;
     UboDescriptorInfo.range  = sizeof( PVM );
 
     auto ImgDescriptorImgInfo        = VkDescriptorImageInfo();
     ImgDescriptorImgInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    ImgDescriptorImgInfo.imageView   = Models.back()->Tex.getImgView();
-    ImgDescriptorImgInfo.sampler     = Models.back()->Tex.getSampler();
+    ImgDescriptorImgInfo.imageView   = Target.Tex.getImgView();
+    ImgDescriptorImgInfo.sampler     = Target.Tex.getSampler();
 
     auto UboWriteDescriptorSet             = VkWriteDescriptorSet();
     UboWriteDescriptorSet.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     UboWriteDescriptorSet.dstSet           = DescSet;
     UboWriteDescriptorSet.dstBinding       = 0;
     UboWriteDescriptorSet.dstArrayElement  = 0;
-    UboWriteDescriptorSet.descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    UboWriteDescriptorSet.descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     UboWriteDescriptorSet.descriptorCount  = 1;
     UboWriteDescriptorSet.pBufferInfo      = &UboDescriptorInfo;
     UboWriteDescriptorSet.pImageInfo       = nullptr;
@@ -839,13 +1210,52 @@ namespace Mvk::Engine
 
     vkUpdateDescriptorSets( Device, static_cast<uint32_t>( std::size( writes ) ), std::data( writes ), 0, nullptr );
 
-    ModelDescSets.push_back( DescSet );
+    return { DescSetAllocInfo.descriptorPool, DescSet };
+  }
+
+  void VulkanRenderer::updateStaleDescSets() noexcept
+  {
+    std::sort( std::begin( StaleDescSets ), std::end( StaleDescSets ) );
+    StaleDescSets.erase( std::unique( std::begin( StaleDescSets ), std::end( StaleDescSets ) ), std::end( StaleDescSets ) );
 
-    return std::size( Models ) - 1;
+    for ( auto const ID : StaleDescSets )
+    {
+      VulkanContext::the().addGarbage( ModelDescSets[ID].Pool, ModelDescSets[ID].Set );
+      ModelDescSets[ID] = crtDescSet( *Models[ID] );
+    }
+
+    StaleDescSets.clear();
   }
 
   void VulkanRenderer::beginDraw() noexcept
   {
+    auto const Device = VulkanContext::the().getDevice();
+
+    // Once the frame that last used this region is done its dynamic data can be overwritten
+    auto const FrameInFlightFence = FrameInFlightFences[CurrentFrameIdx];
+    vkWaitForFences( Device, 1, &FrameInFlightFence, VK_TRUE, std::numeric_limits<uint64_t>::max() );
+
+    // The last frame skipped the draws that didn't fit, every set points to the old buffer
+    if ( DynamicBuff->getIsOverflowed() )
+    {
+      DynamicBuff->grow();
+
+      for ( auto ID = ModelID( 0 ); ID < std::size( Models ); ++ID )
+      {
+        if ( Models[ID] != nullptr )
+        {
+          StaleDescSets.push_back( ID );
+        }
+      }
+    }
+
+    DynamicBuff->reset( CurrentFrameIdx );
+    VulkanContext::the().collectGarbage();
+    AllocatorContext::the().nextFrame();
+    // Everything the GPU wrote for the host in that frame is done by now
+    AllocatorContext::the().invalidateMappedRanges();
+    Uploads->reclaim();
+
     updateImgIdx();
 
     CurrentCmdBuff = CmdBuffs[CurrentBuffIdx];
@@ -857,6 +1267,42 @@ namespace Mvk::Engine
 
     vkBeginCommandBuffer( CurrentCmdBuff, &CmdBuffBeginInfo );
 
+    // The GPU waits for the uploads, the CPU never does
+    uploadLoadedModels();
+    streamTextures();
+    static_cast<void>( Uploads->flush() );
+    UploadWait = Uploads->acquire( CurrentCmdBuff );
+
+    for ( auto const ID : PendingModels )
+    {
+      Models[ID]->Tex.generateMips( CurrentCmdBuff );
+    }
+
+    PendingModels.clear();
+    finishStreaming();
+
+    // Copies can't be recorded inside a render pass
+    auto const Stats = AllocatorContext::the().defragment( CurrentCmdBuff, DefragByteBudget );
+
+    // A moved texture has a new view, so its old set points to an image that is about to go away. Buffers are bound per
+    // draw, their sets stay as they are
+    for ( auto const * Moved : Stats.Relocated )
+    {
+      auto const IsTex = [Moved]( std::unique_ptr<Model> const & Current )
+      { return Current != nullptr && static_cast<Relocatable const *>( &Current->Tex ) == Moved; };
+
+      auto const It = std::find_if( std::begin( Models ), std::end( Models ), IsTex );
+
+      if ( It == std::end( Models ) )
+      {
+        continue;
+      }
+
+      StaleDescSets.push_back( static_cast<ModelID>( std::distance( std::begin( Models ), It ) ) );
+    }
+
+    updateStaleDescSets();
+
     auto ClrColorVal  = VkClearValue();
     ClrColorVal.color = { { 0.0F, 0.0F, 0.0F, 1.0F } };
 
@@ -902,14 +1348,25 @@ namespace Mvk::Engine
     auto const ImgAvailableSemaphore   = ImgAvailableSemaphores[CurrentFrameIdx];
     auto const RenderFinishedSemaphore = RenderFinishedSemaphores[CurrentFrameIdx];
 
-    auto const WaitSemaphore  = std::array{ ImgAvailableSemaphore };
+    auto const ImgWaitStage   = VkPipelineStageFlags( VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT );
+    auto const WaitSemaphore  = std::array{ ImgAvailableSemaphore, Uploads->getSemaphore() };
     auto const SigSemaphore   = std::array{ RenderFinishedSemaphore };
-    auto const WaitStages     = std::array<VkPipelineStageFlags, 1>{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    auto const WaitStages     = std::array{ ImgWaitStage, Uploads->getWaitStages() };
     auto const SubmitCmdBuffs = std::array{ CurrentCmdBuff };
 
+    // The upload semaphore is only waited on by the frames that acquired something, binary semaphores ignore their value
+    auto const WaitValues = std::array<uint64_t, 2>{ 0, UploadWait };
+    auto const WaitCnt    = static_cast<uint32_t>( UploadWait != 0 ? 2 : 1 );
+
+    auto TimelineSubmitInfo                    = VkTimelineSemaphoreSubmitInfo();
+    TimelineSubmitInfo.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    TimelineSubmitInfo.waitSemaphoreValueCount = WaitCnt;
+    TimelineSubmitInfo.pWaitSemaphoreValues    = std::data( WaitValues );
+
     auto SubmitInfo                 = VkSubmitInfo();
     SubmitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    SubmitInfo.waitSemaphoreCount   = static_cast<uint32_t>( std::size( WaitSemaphore ) );
+    SubmitInfo.pNext                = &TimelineSubmitInfo;
+    SubmitInfo.waitSemaphoreCount   = WaitCnt;
     SubmitInfo.pWaitSemaphores      = std::data( WaitSemaphore );
     SubmitInfo.pWaitDstStageMask    = std::data( WaitStages );
     SubmitInfo.commandBufferCount   = static_cast<uint32_t>( std::size( SubmitCmdBuffs ) );
@@ -920,6 +1377,9 @@ namespace Mvk::Engine
     auto const FrameInFlightFence = FrameInFlightFences[CurrentFrameIdx];
     auto const GfxQueue           = VulkanContext::the().getGraphicsQueue();
 
+    // Whatever the frame wrote to non coherent memory goes out in one call
+    AllocatorContext::the().flushMappedRanges();
+
     vkResetFences( Device, 1, &FrameInFlightFence );
     vkQueueSubmit( GfxQueue, 1, &SubmitInfo, FrameInFlightFence );
 
@@ -971,21 +1431,44 @@ namespace Mvk::Engine
 
   void VulkanRenderer::drawModel( ModelID ID ) noexcept
   {
+    if ( !isResident( ID ) )
+    {
+      return;
+    }
+
     auto & Model   = Models[ID];
-    auto   DescSet = ModelDescSets[ID];
+    auto   DescSet = ModelDescSets[ID].Set;
 
     auto VtxBuff = Model->Vbo.getBuff();
     auto IdxBuff = Model->Ibo.getBuff();
 
-    auto Pvm = createTestPvm();
-    Model->Ubo.map( { reinterpret_cast<std::byte const *>( &Pvm ), sizeof( PVM ) } );
+    auto const Pvm = createTestPvm();
+
+    if ( !std::empty( Model->TexSrc.Levels ) )
+    {
+      TexWantedLvls[ID] = std::min( TexWantedLvls[ID], calcWantedLvl( Pvm, Model->Dequant, Model->Tex, SwapchainExtent ) );
+    }
+
+    // Skipped for this frame only, the next beginDraw grows the buffer
+    auto const MinUboAlignment = VulkanContext::the().getPhysicalDeviceLimits().minUniformBufferOffsetAlignment;
+    auto const PvmAlloc        = DynamicBuff->allocate( sizeof( PVM ), MinUboAlignment );
+
+    if ( !PvmAlloc.has_value() )
+    {
+      return;
+    }
+
+    std::memcpy( PvmAlloc->Data, &Pvm, sizeof( PVM ) );
+
+    auto const DynamicOff = static_cast<uint32_t>( PvmAlloc->Off );
 
-    auto VtxOff = VkDeviceSize( 0 );
+    auto VtxOff = Model->Vbo.getOff();
 
     vkCmdBindPipeline( CurrentCmdBuff, VK_PIPELINE_BIND_POINT_GRAPHICS, MainPipeline );
     vkCmdBindVertexBuffers( CurrentCmdBuff, 0, 1, &VtxBuff, &VtxOff );
-    vkCmdBindIndexBuffer( CurrentCmdBuff, IdxBuff, 0, VK_INDEX_TYPE_UINT32 );
-    vkCmdBindDescriptorSets( CurrentCmdBuff, VK_PIPELINE_BIND_POINT_GRAPHICS, MainPipelineLayout, 0, 1, &DescSet, 0, nullptr );
+    vkCmdBindIndexBuffer( CurrentCmdBuff, IdxBuff, Model->Ibo.getOff(), VK_INDEX_TYPE_UINT32 );
+    vkCmdBindDescriptorSets( CurrentCmdBuff, VK_PIPELINE_BIND_POINT_GRAPHICS, MainPipelineLayout, 0, 1, &DescSet, 1, &DynamicOff );
+    vkCmdPushConstants( CurrentCmdBuff, MainPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof( pos_dequant ), &Model->Dequant );
     vkCmdDrawIndexed( CurrentCmdBuff, Model->Ibo.getCnt(), 1, 0, 0, 0 );
   }
 
@@ -1,25 +1,56 @@
 #pragma once
 
+#include "Engine/DynamicBuffObj.hpp"
+#include "Engine/ImmediateContext.hpp"
 #include "Engine/Model.hpp"
+#include "Engine/ModelLoader.hpp"
+#include "Engine/UploadQueue.hpp"
+#include "Engine/VtxLayout.hpp"
 #include "GLFW/glfw3.h"
 #include "Utility/Macros.hpp"
 
 #include <array>
+#include <deque>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 namespace Mvk::Engine
 {
-  using ModelID = size_t;
-
   class VulkanRenderer
   {
   public:
     static constexpr auto DynamicBuffCount  = 2;
     static constexpr auto MaxFramesInFlight = 2;
 
+    // Per frame data (PVMs for now)
+    static constexpr auto DynamicBuffRegionSize = VkDeviceSize( 1024 * 1024 );
+
+    // Shared by every upload, anything bigger gets a staging range of its own
+    static constexpr auto StagingRingSize = VkDeviceSize( 32 * 1024 * 1024 );
+
+    // Upper bound of bytes copied around by the allocator defragmentation each frame
+    static constexpr auto DefragByteBudget = VkDeviceSize( 4 * 1024 * 1024 );
+
+    // Models loaded in the background are uploaded until a frame crosses this, at least one goes through per frame
+    static constexpr auto AsyncUploadByteBudget = VkDeviceSize( 16 * 1024 * 1024 );
+
+    // Textures streamed from KTX2 files start with their levels up to this size, the finer ones come in as their models
+    // get bigger on screen
+    static constexpr auto StreamTailDim = size_t( 128 );
+
+    // Texture levels streamed in until a frame crosses this, at least one goes through per frame
+    static constexpr auto TexStreamByteBudget = VkDeviceSize( 8 * 1024 * 1024 );
+
+    static constexpr auto DefaultTexBudget = VkDeviceSize( 256 * 1024 * 1024 );
+
+    static constexpr auto NotDrawnLvl = std::numeric_limits<uint32_t>::max();
+
+    // Sets of a descriptor pool, another one is chained once they are all taken
+    static constexpr auto DescSetsPerPool = uint32_t( 64 );
+
     // Expects VulkanContext to be initialized
     VulkanRenderer() noexcept;
     MVK_DEFINE_NON_COPYABLE( VulkanRenderer );
@@ -27,9 +58,14 @@ namespace Mvk::Engine
     ~VulkanRenderer() noexcept;
 
     // TODO(samuel): remove model generation from renderer
-    // For now it just loads the same model everytime
     // The renderer shouldn't take care of this but for now it will
-    [[nodiscard]] ModelID loadModel() noexcept;
+    [[nodiscard]] ModelID loadModel( ModelPaths const & Paths ) noexcept;
+
+    // Returns right away, the files are read on the loader threads and the model is uploaded by a later beginDraw. Until
+    // then drawModel skips it
+    [[nodiscard]] ModelID loadModelAsync( ModelPaths const & Paths ) noexcept;
+
+    [[nodiscard]] bool isResident( ModelID ID ) const noexcept;
 
     void beginDraw() noexcept;
 
@@ -42,6 +78,13 @@ namespace Mvk::Engine
       return glfwWindowShouldClose( VulkanContext::the().getWindow() ) != 0;
     }
 
+    // VRAM the streamed textures can take, past it levels are evicted starting with the ones the last frame didn't need.
+    // The coarse levels every texture starts with are never evicted
+    void setTexBudget( VkDeviceSize Budget ) noexcept
+    {
+      TexBudget = Budget;
+    }
+
   private:
     void updateImgIdx() noexcept;
     void recreateAfterFramebufferChange() noexcept;
@@ -56,6 +99,10 @@ namespace Mvk::Engine
     void initShaders() noexcept;
     void initPipelines() noexcept;
     void initSync() noexcept;
+    void initDynamicBuff() noexcept;
+    void initUploadQueue() noexcept;
+    void initImmediateContext() noexcept;
+    void initModelLoader() noexcept;
 
     void dstrLayouts() noexcept;
     void dstrPools() noexcept;
@@ -67,6 +114,32 @@ namespace Mvk::Engine
     void dstrShaders() noexcept;
     void dstrPipelines() noexcept;
     void dstrSync() noexcept;
+    void dstrDynamicBuff() noexcept;
+    void dstrUploadQueue() noexcept;
+    void dstrImmediateContext() noexcept;
+    void dstrModelLoader() noexcept;
+
+    [[nodiscard]] ModelID reserveModel() noexcept;
+    // False when the model doesn't fit in memory, nothing was recorded then
+    [[nodiscard]] bool    uploadModel( ModelID ID, ModelData const & Data ) noexcept;
+    void                  uploadLoadedModels() noexcept;
+
+    // Picks the texture levels to stream in or evict from what the last frame drew, the new levels go through the upload
+    // queue and finishStreaming switches the images once the frame acquired them
+    void streamTextures() noexcept;
+    void finishStreaming() noexcept;
+
+    // Sets are freed through the garbage queue, which needs the pool they came from
+    struct DescSetAlloc
+    {
+      VkDescriptorPool Pool = VK_NULL_HANDLE;
+      VkDescriptorSet  Set  = VK_NULL_HANDLE;
+    };
+
+    [[nodiscard]] VkDescriptorPool crtDescPool() noexcept;
+    [[nodiscard]] DescSetAlloc     crtDescSet( Model & Target ) noexcept;
+    // Replaces the sets of StaleDescSets, each at most once however many times its view changed
+    void                           updateStaleDescSets() noexcept;
 
     // Layouts
     VkDescriptorSetLayout                         UboTexDescSetLayout;
@@ -74,7 +147,8 @@ namespace Mvk::Engine
     //
     // Pools
     VkCommandPool                                 CmdPool;
-    VkDescriptorPool                              DescPool;
+    // Never shrinks, sets go back to whichever pool they came from
+    std::vector<VkDescriptorPool>                 DescPools;
     //
     // Swapchain
     uint32_t                                      SwapchainImgCount;
@@ -84,7 +158,7 @@ namespace Mvk::Engine
     //
     // Depth Image
     VkImage                                       DepthImg;
-    VkDeviceMemory                                DepthImgMem;
+    AllocationID                                  DepthImgID;
     VkImageView                                   DepthImgView;
     //
     // Framebuffers
@@ -109,6 +183,32 @@ namespace Mvk::Engine
     std::array<VkFence, MaxFramesInFlight>        FrameInFlightFences;
     std::vector<std::optional<VkFence>>           ImgInFlightFences;
     //
+    // Per frame linear allocator
+    std::unique_ptr<DynamicBuffObj>               DynamicBuff;
+    //
+    // One-off work outside of the frames
+    std::unique_ptr<ImmediateContext>             Immediate;
+    //
+    // Uploads
+    std::unique_ptr<UploadQueue>                  Uploads;
+    // Submitted but not acquired by a frame yet, they aren't drawn until then
+    std::vector<ModelID>                          PendingModels;
+    // Didn't fit in memory, retried every frame while streamTextures makes room for them
+    std::deque<ModelLoader::Result>               DeferredModels;
+    UploadQueue::Ticket                           UploadWait = 0;
+    //
+    // Background loading
+    std::unique_ptr<ModelLoader>                  Loader;
+    //
+    // Texture streaming
+    VkDeviceSize                                  TexBudget = DefaultTexBudget;
+    // Finest level the draws of the last frame could use per model, NotDrawnLvl when there were none
+    std::vector<uint32_t>                         TexWantedLvls;
+    // Between beginResidency and endResidency
+    std::vector<ModelID>                          StreamingModels;
+    // Texture views that changed this frame, through streaming or the defragmentation
+    std::vector<ModelID>                          StaleDescSets;
+    //
     // Counters
     size_t                                        CurrentFrameIdx = 0;
     size_t                                        CurrentBuffIdx  = 0;
@@ -116,7 +216,8 @@ namespace Mvk::Engine
     VkCommandBuffer                               CurrentCmdBuff  = VK_NULL_HANDLE;
     //
     // TODO(samsal): For now renderer take care of storing the models
-    std::vector<VkDescriptorSet>                  ModelDescSets;
+    // Null while the model is still loading
+    std::vector<DescSetAlloc>                     ModelDescSets;
     std::vector<std::unique_ptr<Model>>           Models;
   };
 
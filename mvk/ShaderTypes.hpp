@@ -6,6 +6,9 @@
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
+#include <array>
+#include <cstdint>
+
 namespace Mvk
 {
   struct vertex
@@ -15,6 +18,22 @@ namespace Mvk
     glm::vec2 texture_coord;
   };
 
+  // What the GPU actually reads, 12 bytes against the 48 of the aligned vertex. Positions are snorm16 within the bounds
+  // of the mesh, w is padding since 3 component 16 bit formats are rarely supported for vertex input. UVs are unorm16 and
+  // the color is gone, it was always white
+  struct packed_vertex
+  {
+    std::array<int16_t, 4>  pos;
+    std::array<uint16_t, 2> texture_coord;
+  };
+
+  // Pushed per mesh, the vertex shader decodes positions with pos * scale + offset
+  struct pos_dequant
+  {
+    glm::vec4 scale;
+    glm::vec4 offset;
+  };
+
   struct PVM
   {
     glm::mat4 model;
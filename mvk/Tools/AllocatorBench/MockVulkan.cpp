@@ -0,0 +1,362 @@
+#include "Tools/AllocatorBench/MockVulkan.hpp"
+
+#include "Engine/AllocatorContext.hpp"
+#include "Engine/VulkanContext.hpp"
+#include "Utility/Verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+namespace Mvk::Tools
+{
+  namespace Detail
+  {
+    static constexpr uint32_t DeviceLocalHeapIdx = 0;
+    static constexpr uint32_t HostHeapIdx        = 1;
+
+    struct MockMemory
+    {
+      VkDeviceSize Size;
+      uint32_t     HeapIdx;
+      void *       Data;
+    };
+
+    struct MockDevice
+    {
+      std::mutex                                  Mtx;
+      MockDeviceDesc                              Desc;
+      MockMemoryCounters                          Counters;
+      std::array<VkDeviceSize, 2>                 HeapUsed;
+      std::unordered_map<uintptr_t, MockMemory>   Mems;
+      std::unordered_map<uintptr_t, VkDeviceSize> Buffs;
+      uintptr_t                                   NextHandle = 1;
+    };
+
+    static MockDevice & getMockDevice() noexcept
+    {
+      static auto Device = MockDevice();
+      return Device;
+    }
+
+    static VkDeviceSize getHeapSize( MockDeviceDesc const & Desc, uint32_t HeapIdx ) noexcept
+    {
+      return HeapIdx == DeviceLocalHeapIdx ? Desc.DeviceLocalHeapSize : Desc.HostHeapSize;
+    }
+
+  }  // namespace Detail
+
+  void initMockDevice( MockDeviceDesc const & Desc ) noexcept
+  {
+    {
+      auto & Device = Detail::getMockDevice();
+      auto   Lock   = std::scoped_lock( Device.Mtx );
+
+      Device.Desc     = Desc;
+      Device.Counters = MockMemoryCounters();
+      Device.HeapUsed.fill( 0 );
+    }
+
+    Engine::VulkanContext::the().initialize( "allocator-bench", { 0, 0 } );
+  }
+
+  void shutdownMockDevice() noexcept
+  {
+    Engine::VulkanContext::the().shutdown();
+
+    auto & Device = Detail::getMockDevice();
+    auto   Lock   = std::scoped_lock( Device.Mtx );
+
+    // Anything left is a leak in the allocator
+    MVK_VERIFY( Device.Mems.empty() );
+    MVK_VERIFY( Device.Buffs.empty() );
+  }
+
+  [[nodiscard]] MockMemoryCounters getMockCounters() noexcept
+  {
+    auto & Device = Detail::getMockDevice();
+    auto   Lock   = std::scoped_lock( Device.Mtx );
+    return Device.Counters;
+  }
+
+  void resetMockPeak() noexcept
+  {
+    auto & Device = Detail::getMockDevice();
+    auto   Lock   = std::scoped_lock( Device.Mtx );
+
+    Device.Counters.PeakReservedBytes = Device.Counters.ReservedBytes;
+  }
+
+}  // namespace Mvk::Tools
+
+// Headless VulkanContext, the allocator only needs the device handles, the limits and the garbage queue
+namespace Mvk::Engine
+{
+  void VulkanContext::initialize( [[maybe_unused]] std::string const & Name, [[maybe_unused]] Extent Extent )
+  {
+    auto const & Desc = Tools::Detail::getMockDevice().Desc;
+
+    Window               = nullptr;
+    IsFramebufferResized = false;
+    PhysicalDevice       = reinterpret_cast<VkPhysicalDevice>( uintptr_t( 1 ) );
+    Device               = reinterpret_cast<VkDevice>( uintptr_t( 1 ) );
+    PhysicalDeviceProps  = VkPhysicalDeviceProperties();
+    HasMemoryBudget      = false;
+    HasHostImport        = false;
+    HostImportAlignment  = 0;
+
+    PhysicalDeviceProps.limits.bufferImageGranularity   = Desc.BufferImageGranularity;
+    PhysicalDeviceProps.limits.maxMemoryAllocationCount = Desc.MaxAllocationCnt;
+
+    AllocatorContext::the().initialize( {} );
+  }
+
+  void VulkanContext::addGarbage( AllocationID ID ) noexcept
+  {
+    Garbages.add( ID );
+  }
+
+  void VulkanContext::collectGarbage() noexcept
+  {
+    Garbages.collect( Device );
+  }
+
+  void VulkanContext::flushGarbage() noexcept
+  {
+    Garbages.flush( Device );
+  }
+
+  void VulkanContext::shutdown() noexcept
+  {
+    flushGarbage();
+    AllocatorContext::the().shutdown();
+  }
+
+}  // namespace Mvk::Engine
+
+extern "C"
+{
+  VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties( [[maybe_unused]] VkPhysicalDevice   PhysicalDevice,
+                                                                  VkPhysicalDeviceMemoryProperties * Props )
+  {
+    auto const & Desc = Mvk::Tools::Detail::getMockDevice().Desc;
+
+    *Props = VkPhysicalDeviceMemoryProperties();
+
+    Props->memoryTypeCount = 2;
+    Props->memoryTypes[0]  = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Mvk::Tools::Detail::DeviceLocalHeapIdx };
+    Props->memoryTypes[1]  = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                               Mvk::Tools::Detail::HostHeapIdx };
+
+    Props->memoryHeapCount = 2;
+    Props->memoryHeaps[0]  = { Desc.DeviceLocalHeapSize, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+    Props->memoryHeaps[1]  = { Desc.HostHeapSize, 0 };
+  }
+
+  VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties2( VkPhysicalDevice                    PhysicalDevice,
+                                                                   VkPhysicalDeviceMemoryProperties2 * Props )
+  {
+    vkGetPhysicalDeviceMemoryProperties( PhysicalDevice, &Props->memoryProperties );
+  }
+
+  VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory( [[maybe_unused]] VkDevice                     Device,
+                                                   VkMemoryAllocateInfo const *                  Info,
+                                                   [[maybe_unused]] VkAllocationCallbacks const * Callbacks,
+                                                   VkDeviceMemory *                              Mem )
+  {
+    auto & Mock = Mvk::Tools::Detail::getMockDevice();
+    auto   Lock = std::scoped_lock( Mock.Mtx );
+
+    auto const HeapIdx = Info->memoryTypeIndex == 0 ? Mvk::Tools::Detail::DeviceLocalHeapIdx : Mvk::Tools::Detail::HostHeapIdx;
+    auto const Size    = Info->allocationSize;
+
+    if ( std::size( Mock.Mems ) >= Mock.Desc.MaxAllocationCnt
+         || Mock.HeapUsed[HeapIdx] + Size > Mvk::Tools::Detail::getHeapSize( Mock.Desc, HeapIdx ) )
+    {
+      ++Mock.Counters.FailedCalls;
+      return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+
+    auto const Handle = Mock.NextHandle++;
+
+    Mock.Mems[Handle] = { Size, HeapIdx, nullptr };
+    Mock.HeapUsed[HeapIdx] += Size;
+
+    Mock.Counters.ReservedBytes += Size;
+    Mock.Counters.PeakReservedBytes = std::max( Mock.Counters.PeakReservedBytes, Mock.Counters.ReservedBytes );
+    ++Mock.Counters.AllocateCalls;
+
+    *Mem = reinterpret_cast<VkDeviceMemory>( Handle );
+    return VK_SUCCESS;
+  }
+
+  VKAPI_ATTR void VKAPI_CALL vkFreeMemory( [[maybe_unused]] VkDevice                      Device,
+                                           VkDeviceMemory                                 Mem,
+                                           [[maybe_unused]] VkAllocationCallbacks const * Callbacks )
+  {
+    if ( Mem == VK_NULL_HANDLE )
+    {
+      return;
+    }
+
+    auto & Mock = Mvk::Tools::Detail::getMockDevice();
+    auto   Lock = std::scoped_lock( Mock.Mtx );
+
+    auto const Found = Mock.Mems.find( reinterpret_cast<uintptr_t>( Mem ) );
+    MVK_VERIFY( Found != std::end( Mock.Mems ) );
+
+    auto const & Freed = Found->second;
+
+    Mock.HeapUsed[Freed.HeapIdx] -= Freed.Size;
+    Mock.Counters.ReservedBytes -= Freed.Size;
+    ++Mock.Counters.FreeCalls;
+
+    std::free( Freed.Data );
+    Mock.Mems.erase( Found );
+  }
+
+  VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory( [[maybe_unused]] VkDevice         Device,
+                                              VkDeviceMemory                    Mem,
+                                              VkDeviceSize                      Off,
+                                              [[maybe_unused]] VkDeviceSize     Size,
+                                              [[maybe_unused]] VkMemoryMapFlags Flags,
+                                              void **                           Data )
+  {
+    auto & Mock = Mvk::Tools::Detail::getMockDevice();
+    auto   Lock = std::scoped_lock( Mock.Mtx );
+
+    auto & Mapped = Mock.Mems.at( reinterpret_cast<uintptr_t>( Mem ) );
+
+    // Untouched pages are never committed, so big blocks stay cheap
+    if ( Mapped.Data == nullptr )
+    {
+      Mapped.Data = std::malloc( Mapped.Size );
+    }
+
+    if ( Mapped.Data == nullptr )
+    {
+      return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+
+    *Data = static_cast<std::byte *>( Mapped.Data ) + Off;
+    return VK_SUCCESS;
+  }
+
+  // The mock memory is plain host memory, nothing to make visible
+  VKAPI_ATTR VkResult VKAPI_CALL vkFlushMappedMemoryRanges( [[maybe_unused]] VkDevice                    Device,
+                                                            [[maybe_unused]] uint32_t                    RangeCnt,
+                                                            [[maybe_unused]] VkMappedMemoryRange const * Ranges )
+  {
+    return VK_SUCCESS;
+  }
+
+  VKAPI_ATTR VkResult VKAPI_CALL vkInvalidateMappedMemoryRanges( [[maybe_unused]] VkDevice                    Device,
+                                                                 [[maybe_unused]] uint32_t                    RangeCnt,
+                                                                 [[maybe_unused]] VkMappedMemoryRange const * Ranges )
+  {
+    return VK_SUCCESS;
+  }
+
+  // Block buffers are the only resources the allocator creates on its own
+  VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer( [[maybe_unused]] VkDevice                      Device,
+                                                 VkBufferCreateInfo const *                     CrtInfo,
+                                                 [[maybe_unused]] VkAllocationCallbacks const * Allocator,
+                                                 VkBuffer *                                     Buff )
+  {
+    auto & Mock = Mvk::Tools::Detail::getMockDevice();
+    auto   Lock = std::scoped_lock( Mock.Mtx );
+
+    auto const Handle = Mock.NextHandle++;
+    Mock.Buffs.emplace( Handle, CrtInfo->size );
+
+    *Buff = reinterpret_cast<VkBuffer>( Handle );
+    return VK_SUCCESS;
+  }
+
+  VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer( [[maybe_unused]] VkDevice                      Device,
+                                              VkBuffer                                       Buff,
+                                              [[maybe_unused]] VkAllocationCallbacks const * Allocator )
+  {
+    if ( Buff == VK_NULL_HANDLE )
+    {
+      return;
+    }
+
+    auto & Mock = Mvk::Tools::Detail::getMockDevice();
+    auto   Lock = std::scoped_lock( Mock.Mtx );
+
+    MVK_VERIFY( Mock.Buffs.erase( reinterpret_cast<uintptr_t>( Buff ) ) == 1 );
+  }
+
+  // The allocator never hands out images or descriptor sets, but the garbage queue references them
+  VKAPI_ATTR void VKAPI_CALL vkDestroyImage( [[maybe_unused]] VkDevice                      Device,
+                                             [[maybe_unused]] VkImage                       Img,
+                                             [[maybe_unused]] VkAllocationCallbacks const * Allocator )
+  {
+  }
+
+  VKAPI_ATTR void VKAPI_CALL vkDestroyImageView( [[maybe_unused]] VkDevice                      Device,
+                                                 [[maybe_unused]] VkImageView                   ImgView,
+                                                 [[maybe_unused]] VkAllocationCallbacks const * Allocator )
+  {
+  }
+
+  VKAPI_ATTR VkResult VKAPI_CALL vkFreeDescriptorSets( [[maybe_unused]] VkDevice                Device,
+                                                       [[maybe_unused]] VkDescriptorPool        Pool,
+                                                       [[maybe_unused]] uint32_t                DescSetCnt,
+                                                       [[maybe_unused]] VkDescriptorSet const * DescSets )
+  {
+    return VK_SUCCESS;
+  }
+
+  VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements( [[maybe_unused]] VkDevice Device,
+                                                            VkBuffer                  Buff,
+                                                            VkMemoryRequirements *    Req )
+  {
+    auto & Mock = Mvk::Tools::Detail::getMockDevice();
+    auto   Lock = std::scoped_lock( Mock.Mtx );
+
+    Req->alignment      = 256;
+    Req->size           = ( Mock.Buffs.at( reinterpret_cast<uintptr_t>( Buff ) ) + 255 ) & ~VkDeviceSize( 255 );
+    Req->memoryTypeBits = 0x3;
+  }
+
+  VKAPI_ATTR VkResult VKAPI_CALL vkBindBufferMemory( [[maybe_unused]] VkDevice       Device,
+                                                     [[maybe_unused]] VkBuffer       Buff,
+                                                     [[maybe_unused]] VkDeviceMemory Mem,
+                                                     [[maybe_unused]] VkDeviceSize   Off )
+  {
+    return VK_SUCCESS;
+  }
+
+  // The bench only allocates raw ranges, resources and command buffers never show up
+  VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements2( [[maybe_unused]] VkDevice                               Device,
+                                                             [[maybe_unused]] VkBufferMemoryRequirementsInfo2 const * Info,
+                                                             [[maybe_unused]] VkMemoryRequirements2 *                 Req )
+  {
+    MVK_VERIFY_NOT_REACHED();
+  }
+
+  VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements2( [[maybe_unused]] VkDevice                              Device,
+                                                            [[maybe_unused]] VkImageMemoryRequirementsInfo2 const * Info,
+                                                            [[maybe_unused]] VkMemoryRequirements2 *                Req )
+  {
+    MVK_VERIFY_NOT_REACHED();
+  }
+
+  VKAPI_ATTR void VKAPI_CALL vkCmdPipelineBarrier( [[maybe_unused]] VkCommandBuffer               CmdBuff,
+                                                   [[maybe_unused]] VkPipelineStageFlags          SrcStageMask,
+                                                   [[maybe_unused]] VkPipelineStageFlags          DstStageMask,
+                                                   [[maybe_unused]] VkDependencyFlags             DependencyFlags,
+                                                   [[maybe_unused]] uint32_t                      MemBarrierCnt,
+                                                   [[maybe_unused]] VkMemoryBarrier const *       MemBarriers,
+                                                   [[maybe_unused]] uint32_t                      BuffMemBarrierCnt,
+                                                   [[maybe_unused]] VkBufferMemoryBarrier const * BuffMemBarriers,
+                                                   [[maybe_unused]] uint32_t                      ImgMemBarrierCnt,
+                                                   [[maybe_unused]] VkImageMemoryBarrier const *  ImgMemBarriers )
+  {
+    MVK_VERIFY_NOT_REACHED();
+  }
+}
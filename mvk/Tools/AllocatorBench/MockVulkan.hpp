@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+namespace Mvk::Tools
+{
+  // Stands in for the driver, vkAllocateMemory only hands out handles and counts bytes. Host visible memory gets backed by
+  // malloc when mapped, device local memory is never touched
+  struct MockDeviceDesc
+  {
+    VkDeviceSize DeviceLocalHeapSize;
+    VkDeviceSize HostHeapSize;
+    VkDeviceSize BufferImageGranularity;
+    uint32_t     MaxAllocationCnt;
+  };
+
+  struct MockMemoryCounters
+  {
+    VkDeviceSize ReservedBytes;
+    VkDeviceSize PeakReservedBytes;
+    uint64_t     AllocateCalls;
+    uint64_t     FreeCalls;
+    uint64_t     FailedCalls;
+  };
+
+  // Sets up the mocked device and a headless VulkanContext, can be called again after shutdownMockDevice
+  void initMockDevice( MockDeviceDesc const & Desc ) noexcept;
+  void shutdownMockDevice() noexcept;
+
+  [[nodiscard]] MockMemoryCounters getMockCounters() noexcept;
+  void                             resetMockPeak() noexcept;
+
+}  // namespace Mvk::Tools
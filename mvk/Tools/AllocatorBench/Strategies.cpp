@@ -0,0 +1,233 @@
+#include "Tools/AllocatorBench/Strategies.hpp"
+
+#include "Engine/AllocatorContext.hpp"
+#include "Utility/Verify.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace Mvk::Tools
+{
+  namespace Detail
+  {
+    // Matches the two memory types of the mocked device
+    static constexpr uint32_t HeapCnt = 2;
+
+    [[nodiscard]] static uint32_t getMemTypeIdx( Engine::AllocationType Type ) noexcept
+    {
+      return Type == Engine::AllocationType::GpuOnly || Type == Engine::AllocationType::GpuMapped ? 0 : 1;
+    }
+
+    // Same as the sum of each heap's fragmentation weighted by its free bytes
+    [[nodiscard]] static float getFragmentation( std::array<VkDeviceSize, HeapCnt> const & Free,
+                                                 std::array<VkDeviceSize, HeapCnt> const & Largest ) noexcept
+    {
+      auto TotalFree    = VkDeviceSize( 0 );
+      auto TotalLargest = VkDeviceSize( 0 );
+
+      for ( auto Idx = uint32_t( 0 ); Idx < HeapCnt; ++Idx )
+      {
+        TotalFree += Free[Idx];
+        TotalLargest += Largest[Idx];
+      }
+
+      return TotalFree != 0 ? 1.0F - static_cast<float>( TotalLargest ) / static_cast<float>( TotalFree ) : 0.0F;
+    }
+
+    class ContextStrategy : public Strategy
+    {
+    public:
+      explicit ContextStrategy( uint32_t AllocCnt ) noexcept : IDs( AllocCnt ) {}
+
+      [[nodiscard]] bool allocate( TraceOp const & Op ) noexcept override
+      {
+        auto const Allocation = Engine::AllocatorContext::the().allocate( Op.Type, Op.Size, Op.Alignment, Op.MemType );
+
+        if ( !Allocation.has_value() )
+        {
+          return false;
+        }
+
+        IDs[Op.AllocIdx] = Allocation->ID;
+        return true;
+      }
+
+      void free( uint32_t AllocIdx ) noexcept override
+      {
+        if ( IDs[AllocIdx].has_value() )
+        {
+          Engine::AllocatorContext::the().free( *IDs[AllocIdx] );
+          IDs[AllocIdx].reset();
+        }
+      }
+
+      [[nodiscard]] float getFragmentation() noexcept override
+      {
+        auto const Stats = Engine::AllocatorContext::the().getStats();
+
+        auto Free    = std::array<VkDeviceSize, HeapCnt>();
+        auto Largest = std::array<VkDeviceSize, HeapCnt>();
+
+        for ( auto Idx = uint32_t( 0 ); Idx < std::min( HeapCnt, Stats.HeapCnt ); ++Idx )
+        {
+          auto const & Mem = Stats.Heaps[Idx].Mem;
+
+          Free[Idx]    = Mem.ReservedBytes - Mem.UsedBytes;
+          Largest[Idx] = static_cast<VkDeviceSize>( ( 1.0F - Mem.Fragmentation ) * static_cast<float>( Free[Idx] ) );
+        }
+
+        return Detail::getFragmentation( Free, Largest );
+      }
+
+      void nextFrame() noexcept override
+      {
+        Engine::AllocatorContext::the().nextFrame();
+      }
+
+    private:
+      std::vector<std::optional<Engine::AllocationID>> IDs;
+    };
+
+    class BlockStrategy : public Strategy
+    {
+    public:
+      explicit BlockStrategy( uint32_t AllocCnt ) noexcept : Ranges( AllocCnt ) {}
+
+      [[nodiscard]] bool allocate( TraceOp const & Op ) noexcept override
+      {
+        auto & TypeBlocks = Blocks[static_cast<size_t>( Op.Type )];
+
+        for ( auto & Block : TypeBlocks )
+        {
+          if ( auto const Range = Block->allocate( Op.Size, Op.Alignment ); Range.has_value() )
+          {
+            Ranges[Op.AllocIdx] = { Block.get(), Range->ID };
+            return true;
+          }
+        }
+
+        auto const Size    = std::max( Engine::AllocatorBlock::MinSize, Engine::Tlsf::getMinSize( Op.Size, Op.Alignment ) );
+        auto const TypeIdx = getMemTypeIdx( Op.Type );
+        auto       Block   = std::make_unique<Engine::AllocatorBlock>(
+          Size, Op.Type, Op.MemType, TypeIdx, Engine::ResourceTiling::Linear, Engine::BufferClass::None );
+
+        if ( Block->getMem() == VK_NULL_HANDLE )
+        {
+          return false;
+        }
+
+        auto const Range = Block->allocate( Op.Size, Op.Alignment );
+        MVK_VERIFY( Range.has_value() );
+
+        Ranges[Op.AllocIdx] = { Block.get(), Range->ID };
+        TypeBlocks.push_back( std::move( Block ) );
+        return true;
+      }
+
+      void free( uint32_t AllocIdx ) noexcept override
+      {
+        auto & [Block, RangeID] = Ranges[AllocIdx];
+
+        if ( Block == nullptr )
+        {
+          return;
+        }
+
+        Block->free( RangeID );
+
+        // Empty blocks go back to the driver right away
+        if ( Block->getOwnerCnt() == 0 )
+        {
+          auto & TypeBlocks = Blocks[static_cast<size_t>( Block->getAllocType() )];
+          std::erase_if( TypeBlocks, [Freed = Block]( auto const & Other ) { return Other.get() == Freed; } );
+        }
+
+        Block = nullptr;
+      }
+
+      [[nodiscard]] float getFragmentation() noexcept override
+      {
+        auto Free    = std::array<VkDeviceSize, HeapCnt>();
+        auto Largest = std::array<VkDeviceSize, HeapCnt>();
+
+        for ( auto const & TypeBlocks : Blocks )
+        {
+          for ( auto const & Block : TypeBlocks )
+          {
+            auto const HeapIdx = Block->getMemTypeIdx();
+
+            Free[HeapIdx] += Block->getSize() - Block->getUsed();
+            Largest[HeapIdx] = std::max( Largest[HeapIdx], Block->getLargestFree() );
+          }
+        }
+
+        return Detail::getFragmentation( Free, Largest );
+      }
+
+    private:
+      struct BlockRange
+      {
+        Engine::AllocatorBlock * Block;
+        Engine::Tlsf::RangeID    ID;
+      };
+
+      // Indexed by AllocationType
+      std::array<std::vector<std::unique_ptr<Engine::AllocatorBlock>>, Engine::AllocationTypeCnt> Blocks;
+      std::vector<BlockRange>                                                                     Ranges;
+    };
+
+    class DedicatedStrategy : public Strategy
+    {
+    public:
+      explicit DedicatedStrategy( uint32_t AllocCnt ) noexcept : Mems( AllocCnt, VK_NULL_HANDLE ) {}
+
+      [[nodiscard]] bool allocate( TraceOp const & Op ) noexcept override
+      {
+        auto MemAllocInfo            = VkMemoryAllocateInfo();
+        MemAllocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        MemAllocInfo.allocationSize  = Op.Size;
+        MemAllocInfo.memoryTypeIndex = getMemTypeIdx( Op.Type );
+
+        auto const Device = Engine::VulkanContext::the().getDevice();
+        return vkAllocateMemory( Device, &MemAllocInfo, nullptr, &Mems[Op.AllocIdx] ) == VK_SUCCESS;
+      }
+
+      void free( uint32_t AllocIdx ) noexcept override
+      {
+        vkFreeMemory( Engine::VulkanContext::the().getDevice(), Mems[AllocIdx], nullptr );
+        Mems[AllocIdx] = VK_NULL_HANDLE;
+      }
+
+      [[nodiscard]] float getFragmentation() noexcept override
+      {
+        return 0.0F;
+      }
+
+    private:
+      std::vector<VkDeviceMemory> Mems;
+    };
+
+  }  // namespace Detail
+
+  [[nodiscard]] std::unique_ptr<Strategy> crtStrategy( std::string_view Name, uint32_t AllocCnt ) noexcept
+  {
+    if ( Name == "context" )
+    {
+      return std::make_unique<Detail::ContextStrategy>( AllocCnt );
+    }
+
+    if ( Name == "blocks" )
+    {
+      return std::make_unique<Detail::BlockStrategy>( AllocCnt );
+    }
+
+    if ( Name == "dedicated" )
+    {
+      return std::make_unique<Detail::DedicatedStrategy>( AllocCnt );
+    }
+
+    return nullptr;
+  }
+
+}  // namespace Mvk::Tools
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Tools/AllocatorBench/Trace.hpp"
+#include "Utility/Macros.hpp"
+
+#include <array>
+#include <memory>
+#include <string_view>
+
+namespace Mvk::Tools
+{
+  // Replays a trace against one way of handing out memory, the allocation indices of the trace are used as handles
+  class Strategy
+  {
+  public:
+    Strategy() noexcept = default;
+    MVK_DEFINE_NON_COPYABLE( Strategy );
+    MVK_DEFINE_NON_MOVABLE( Strategy );
+    virtual ~Strategy() noexcept = default;
+
+    // False when the memory ran out
+    [[nodiscard]] virtual bool allocate( TraceOp const & Op ) noexcept = 0;
+    virtual void               free( uint32_t AllocIdx ) noexcept      = 0;
+
+    // Free bytes weighted average of every heap, 1 - largest free range / free bytes
+    [[nodiscard]] virtual float getFragmentation() noexcept = 0;
+
+    // Called every few ops, the way the renderer ends its frames
+    virtual void nextFrame() noexcept {}
+  };
+
+  // context: AllocatorContext as the engine uses it
+  // blocks: AllocatorBlocks with first fit across blocks, no thread caches or buckets
+  // dedicated: a vkAllocateMemory per allocation
+  static constexpr auto StrategyNames = std::array<std::string_view, 3>{ "context", "blocks", "dedicated" };
+
+  [[nodiscard]] std::unique_ptr<Strategy> crtStrategy( std::string_view Name, uint32_t AllocCnt ) noexcept;
+
+}  // namespace Mvk::Tools
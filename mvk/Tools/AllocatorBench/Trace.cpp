@@ -0,0 +1,228 @@
+#include "Tools/AllocatorBench/Trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <utility>
+
+namespace Mvk::Tools
+{
+  namespace Detail
+  {
+    // Indexed by AllocationType
+    static constexpr auto TypeNames =
+      std::array<std::string_view, Engine::AllocationTypeCnt>{ "GpuOnly", "CpuOnly", "CpuToGpu", "GpuMapped", "GpuToCpu" };
+
+    static constexpr Engine::MemoryTypeBits AnyMemType = 0x3;
+
+    struct AllocClass
+    {
+      uint32_t               Weight;
+      Engine::AllocationType Type;
+      VkDeviceSize           MinSize;
+      VkDeviceSize           MaxSize;
+      VkDeviceSize           Alignment;
+      // In allocations, whatever is still alive at the end of the trace is freed there
+      uint32_t               MinLifetime;
+      uint32_t               MaxLifetime;
+    };
+
+    static constexpr auto AllocClasses = std::array{
+      // Uniform and staging ranges rewritten every frame
+      AllocClass{ 76, Engine::AllocationType::CpuToGpu, 64, 64 * 1024, 256, 1, 256 },
+      // Meshes
+      AllocClass{ 20, Engine::AllocationType::GpuOnly, 16 * 1024, 8 * 1024 * 1024, 16, 256, 16384 },
+      // Textures
+      AllocClass{ 2, Engine::AllocationType::GpuOnly, 256 * 1024, 32 * 1024 * 1024, 4096, 4096, 65536 },
+      // Readbacks
+      AllocClass{ 2, Engine::AllocationType::CpuOnly, 4 * 1024, 1024 * 1024, 64, 1, 64 },
+    };
+
+    // Small sizes are a lot more common than big ones
+    template <typename T> [[nodiscard]] static T pickLogUniform( std::mt19937_64 & Rng, T Min, T Max ) noexcept
+    {
+      auto const MinLog = std::log2( static_cast<double>( Min ) );
+      auto const MaxLog = std::log2( static_cast<double>( Max ) );
+      auto       Dist   = std::uniform_real_distribution<double>( MinLog, MaxLog );
+      auto const Value  = static_cast<T>( std::exp2( Dist( Rng ) ) );
+      return std::clamp( Value, Min, Max );
+    }
+
+    [[nodiscard]] static AllocClass const & pickClass( std::mt19937_64 & Rng ) noexcept
+    {
+      auto TotalWeight = uint32_t( 0 );
+
+      for ( auto const & Class : AllocClasses )
+      {
+        TotalWeight += Class.Weight;
+      }
+
+      auto Dist = std::uniform_int_distribution<uint32_t>( 0, TotalWeight - 1 );
+      auto Pick = Dist( Rng );
+
+      for ( auto const & Class : AllocClasses )
+      {
+        if ( Pick < Class.Weight )
+        {
+          return Class;
+        }
+
+        Pick -= Class.Weight;
+      }
+
+      return AllocClasses.back();
+    }
+
+    [[nodiscard]] static std::optional<Engine::AllocationType> parseType( std::string_view Name ) noexcept
+    {
+      for ( auto Idx = size_t( 0 ); Idx < std::size( TypeNames ); ++Idx )
+      {
+        if ( TypeNames[Idx] == Name )
+        {
+          return static_cast<Engine::AllocationType>( Idx );
+        }
+      }
+
+      return std::nullopt;
+    }
+
+  }  // namespace Detail
+
+  [[nodiscard]] Trace genSyntheticTrace( uint32_t AllocCnt, uint64_t Seed ) noexcept
+  {
+    using Death = std::pair<uint64_t, uint32_t>;
+
+    auto Rng    = std::mt19937_64( Seed );
+    auto Deaths = std::priority_queue<Death, std::vector<Death>, std::greater<>>();
+    auto Ops    = Trace();
+
+    Ops.reserve( static_cast<size_t>( AllocCnt ) * 2 );
+
+    for ( auto AllocIdx = uint32_t( 0 ); AllocIdx < AllocCnt; ++AllocIdx )
+    {
+      while ( !Deaths.empty() && Deaths.top().first <= AllocIdx )
+      {
+        Ops.push_back( { TraceOp::Kind::Free, Deaths.top().second, {}, 0, 0, 0 } );
+        Deaths.pop();
+      }
+
+      auto const & Class = Detail::pickClass( Rng );
+      auto const   Size  = Detail::pickLogUniform( Rng, Class.MinSize, Class.MaxSize );
+
+      Ops.push_back( { TraceOp::Kind::Allocate, AllocIdx, Class.Type, Size, Class.Alignment, Detail::AnyMemType } );
+
+      Deaths.emplace( AllocIdx + Detail::pickLogUniform( Rng, Class.MinLifetime, Class.MaxLifetime ), AllocIdx );
+    }
+
+    while ( !Deaths.empty() )
+    {
+      Ops.push_back( { TraceOp::Kind::Free, Deaths.top().second, {}, 0, 0, 0 } );
+      Deaths.pop();
+    }
+
+    return Ops;
+  }
+
+  [[nodiscard]] std::optional<Trace> readTrace( std::filesystem::path const & Path ) noexcept
+  {
+    auto File = std::ifstream( Path );
+
+    if ( !File.is_open() )
+    {
+      return std::nullopt;
+    }
+
+    auto Ops      = Trace();
+    auto AllocCnt = uint32_t( 0 );
+    auto Line     = std::string();
+
+    while ( std::getline( File, Line ) )
+    {
+      if ( Line.empty() || Line.front() == '#' )
+      {
+        continue;
+      }
+
+      auto Stream = std::istringstream( Line );
+      auto Op     = std::string();
+      Stream >> Op;
+
+      if ( Op == "a" )
+      {
+        auto TypeName  = std::string();
+        auto Size      = VkDeviceSize( 0 );
+        auto Alignment = VkDeviceSize( 0 );
+        auto MemType   = Engine::MemoryTypeBits( 0 );
+        Stream >> TypeName >> Size >> Alignment >> MemType;
+
+        auto const Type = Detail::parseType( TypeName );
+
+        if ( !Stream || !Type.has_value() || Size == 0 || !std::has_single_bit( Alignment ) )
+        {
+          return std::nullopt;
+        }
+
+        Ops.push_back( { TraceOp::Kind::Allocate, AllocCnt++, *Type, Size, Alignment, MemType } );
+      }
+      else if ( Op == "f" )
+      {
+        auto AllocIdx = uint32_t( 0 );
+        Stream >> AllocIdx;
+
+        if ( !Stream || AllocIdx >= AllocCnt )
+        {
+          return std::nullopt;
+        }
+
+        Ops.push_back( { TraceOp::Kind::Free, AllocIdx, {}, 0, 0, 0 } );
+      }
+      else
+      {
+        return std::nullopt;
+      }
+    }
+
+    return Ops;
+  }
+
+  [[nodiscard]] bool writeTrace( std::filesystem::path const & Path, Trace const & Ops ) noexcept
+  {
+    auto File = std::ofstream( Path );
+
+    if ( !File.is_open() )
+    {
+      return false;
+    }
+
+    File << "# mvk allocator trace\n";
+
+    for ( auto const & Op : Ops )
+    {
+      if ( Op.Op == TraceOp::Kind::Allocate )
+      {
+        File << "a " << Detail::TypeNames[static_cast<size_t>( Op.Type )] << ' ' << Op.Size << ' ' << Op.Alignment << ' '
+             << Op.MemType << '\n';
+      }
+      else
+      {
+        File << "f " << Op.AllocIdx << '\n';
+      }
+    }
+
+    return static_cast<bool>( File );
+  }
+
+  [[nodiscard]] uint32_t getAllocCnt( Trace const & Ops ) noexcept
+  {
+    return static_cast<uint32_t>(
+      std::count_if( std::begin( Ops ), std::end( Ops ), []( auto const & Op ) { return Op.Op == TraceOp::Kind::Allocate; } ) );
+  }
+
+}  // namespace Mvk::Tools
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Engine/AllocatorBlock.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace Mvk::Tools
+{
+  // Allocations are referred to by the order they show up in, a free always points to an earlier allocate
+  struct TraceOp
+  {
+    enum class Kind
+    {
+      Allocate,
+      Free
+    };
+
+    Kind                   Op;
+    uint32_t               AllocIdx;
+    Engine::AllocationType Type;
+    VkDeviceSize           Size;
+    VkDeviceSize           Alignment;
+    Engine::MemoryTypeBits MemType;
+  };
+
+  using Trace = std::vector<TraceOp>;
+
+  // Mix of what a frame looks like, lots of short lived CpuToGpu uniform and staging ranges, meshes that stay around for a
+  // while and a few big textures that live a lot longer
+  [[nodiscard]] Trace genSyntheticTrace( uint32_t AllocCnt, uint64_t Seed ) noexcept;
+
+  // One op per line, "a <type> <size> <alignment> <memory type bits>" or "f <allocation index>". Empty lines and lines
+  // starting with # are skipped
+  [[nodiscard]] std::optional<Trace> readTrace( std::filesystem::path const & Path ) noexcept;
+  [[nodiscard]] bool                 writeTrace( std::filesystem::path const & Path, Trace const & Ops ) noexcept;
+
+  [[nodiscard]] uint32_t getAllocCnt( Trace const & Ops ) noexcept;
+
+}  // namespace Mvk::Tools
@@ -0,0 +1,488 @@
+#include "Engine/AllocatorContext.hpp"
+#include "Tools/AllocatorBench/MockVulkan.hpp"
+#include "Tools/AllocatorBench/Strategies.hpp"
+#include "Tools/AllocatorBench/Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Mvk::Tools
+{
+  struct BenchOptions
+  {
+    std::vector<std::string_view> Strategies;
+    std::filesystem::path         TracePath;
+    std::filesystem::path         RecordPath;
+    uint32_t                      AllocCnt       = 200000;
+    uint64_t                      Seed           = 1;
+    uint32_t                      SampleInterval = 4096;
+    uint32_t                      FrameOps       = 1024;
+    uint32_t                      ThreadCnt      = 0;
+    MockDeviceDesc                Device         = { 8ULL << 30U, 16ULL << 30U, 1024, 4096 };
+  };
+
+  struct BenchResult
+  {
+    std::string_view      Name;
+    std::vector<uint64_t> AllocNs;
+    std::vector<uint64_t> FreeNs;
+    uint64_t              FailedAllocs;
+    float                 MeanFragmentation;
+    float                 MaxFragmentation;
+    MockMemoryCounters    Counters;
+  };
+
+  struct StressResult
+  {
+    uint64_t           OpCnt;
+    double             Seconds;
+    uint64_t           FailedAllocs;
+    uint64_t           HandedOff;
+    // Mapped ranges that changed while allocated, anything but 0 means a range was handed out twice
+    uint64_t           Corrupted;
+    // Still used once every thread exited and gave its cache back
+    VkDeviceSize       LeakedBytes;
+    MockMemoryCounters Counters;
+  };
+
+  namespace Detail
+  {
+    template <typename T> [[nodiscard]] static bool parseNum( std::string_view Str, T & Value ) noexcept
+    {
+      auto const [End, Error] = std::from_chars( std::data( Str ), std::data( Str ) + std::size( Str ), Value );
+      return Error == std::errc() && End == std::data( Str ) + std::size( Str );
+    }
+
+    [[nodiscard]] static uint64_t getPercentile( std::vector<uint64_t> & Samples, uint32_t Percentile ) noexcept
+    {
+      if ( Samples.empty() )
+      {
+        return 0;
+      }
+
+      auto const Idx = std::min( std::size( Samples ) - 1, std::size( Samples ) * Percentile / 100 );
+      std::nth_element( std::begin( Samples ), std::begin( Samples ) + static_cast<ptrdiff_t>( Idx ), std::end( Samples ) );
+      return Samples[Idx];
+    }
+
+    [[nodiscard]] static double getSeconds( std::vector<uint64_t> const & Samples ) noexcept
+    {
+      auto Total = uint64_t( 0 );
+
+      for ( auto const Sample : Samples )
+      {
+        Total += Sample;
+      }
+
+      return static_cast<double>( Total ) * 1e-9;
+    }
+
+    static void printUsage() noexcept
+    {
+      std::printf( "usage: allocator-bench [options]\n"
+                   "  --strategy <context|blocks|dedicated|all>  strategy to replay against, repeatable (default all)\n"
+                   "  --trace <path>                             replay a recorded trace instead of a synthetic one\n"
+                   "  --record <path>                            write the replayed trace to path\n"
+                   "  --allocs <n>                               allocations in the synthetic trace\n"
+                   "  --seed <n>                                 seed of the synthetic trace\n"
+                   "  --sample <n>                               ops between fragmentation samples\n"
+                   "  --frame <n>                                ops between the nextFrame calls of the context\n"
+                   "  --threads <n>                              then replay the trace on n threads at once against the context\n"
+                   "  --heap-mib <n>                             size of the mocked device local heap\n"
+                   "  --granularity <n>                          mocked bufferImageGranularity\n" );
+    }
+
+    [[nodiscard]] static std::optional<BenchOptions> parseOptions( int Argc, char ** Argv ) noexcept
+    {
+      auto Options = BenchOptions();
+
+      for ( auto Idx = 1; Idx < Argc; ++Idx )
+      {
+        auto const Arg = std::string_view( Argv[Idx] );
+
+        if ( Idx + 1 == Argc )
+        {
+          return std::nullopt;
+        }
+
+        auto const Value = std::string_view( Argv[++Idx] );
+
+        auto HeapMiB = VkDeviceSize( 0 );
+        auto IsValid = true;
+
+        if ( Arg == "--strategy" )
+        {
+          if ( Value == "all" )
+          {
+            Options.Strategies.insert( std::end( Options.Strategies ), std::begin( StrategyNames ), std::end( StrategyNames ) );
+          }
+          else
+          {
+            IsValid = std::find( std::begin( StrategyNames ), std::end( StrategyNames ), Value ) != std::end( StrategyNames );
+            Options.Strategies.push_back( Value );
+          }
+        }
+        else if ( Arg == "--trace" )
+        {
+          Options.TracePath = Value;
+        }
+        else if ( Arg == "--record" )
+        {
+          Options.RecordPath = Value;
+        }
+        else if ( Arg == "--allocs" )
+        {
+          IsValid = parseNum( Value, Options.AllocCnt );
+        }
+        else if ( Arg == "--seed" )
+        {
+          IsValid = parseNum( Value, Options.Seed );
+        }
+        else if ( Arg == "--sample" )
+        {
+          IsValid = parseNum( Value, Options.SampleInterval ) && Options.SampleInterval != 0;
+        }
+        else if ( Arg == "--frame" )
+        {
+          IsValid = parseNum( Value, Options.FrameOps ) && Options.FrameOps != 0;
+        }
+        else if ( Arg == "--threads" )
+        {
+          IsValid = parseNum( Value, Options.ThreadCnt );
+        }
+        else if ( Arg == "--heap-mib" )
+        {
+          IsValid                            = parseNum( Value, HeapMiB );
+          Options.Device.DeviceLocalHeapSize = HeapMiB << 20U;
+        }
+        else if ( Arg == "--granularity" )
+        {
+          IsValid = parseNum( Value, Options.Device.BufferImageGranularity );
+        }
+        else
+        {
+          IsValid = false;
+        }
+
+        if ( !IsValid )
+        {
+          return std::nullopt;
+        }
+      }
+
+      if ( Options.Strategies.empty() )
+      {
+        Options.Strategies.assign( std::begin( StrategyNames ), std::end( StrategyNames ) );
+      }
+
+      return Options;
+    }
+
+    [[nodiscard]] static BenchResult replay( std::string_view Name, Trace const & Ops, BenchOptions const & Options ) noexcept
+    {
+      using Clock = std::chrono::steady_clock;
+
+      auto const getNs = []( Clock::time_point Start )
+      { return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - Start ).count() ); };
+
+      auto Result = BenchResult();
+      Result.Name = Name;
+      Result.AllocNs.reserve( std::size( Ops ) );
+      Result.FreeNs.reserve( std::size( Ops ) );
+
+      initMockDevice( Options.Device );
+
+      {
+        auto Strat = crtStrategy( Name, getAllocCnt( Ops ) );
+
+        auto FragmentationSum = 0.0;
+        auto SampleCnt        = uint32_t( 0 );
+
+        for ( auto Idx = size_t( 0 ); Idx < std::size( Ops ); ++Idx )
+        {
+          auto const & Op = Ops[Idx];
+
+          auto const Start = Clock::now();
+
+          if ( Op.Op == TraceOp::Kind::Allocate )
+          {
+            auto const Succeeded = Strat->allocate( Op );
+            Result.AllocNs.push_back( getNs( Start ) );
+            Result.FailedAllocs += Succeeded ? 0 : 1;
+          }
+          else
+          {
+            Strat->free( Op.AllocIdx );
+            Result.FreeNs.push_back( getNs( Start ) );
+          }
+
+          if ( Idx % Options.SampleInterval == 0 )
+          {
+            auto const Fragmentation = Strat->getFragmentation();
+
+            FragmentationSum += Fragmentation;
+            ++SampleCnt;
+            Result.MaxFragmentation = std::max( Result.MaxFragmentation, Fragmentation );
+          }
+
+          if ( ( Idx + 1 ) % Options.FrameOps == 0 )
+          {
+            Strat->nextFrame();
+          }
+        }
+
+        Result.MeanFragmentation = SampleCnt != 0 ? static_cast<float>( FragmentationSum / SampleCnt ) : 0.0F;
+      }
+
+      Result.Counters = getMockCounters();
+      shutdownMockDevice();
+
+      return Result;
+    }
+
+    // Every thread replays the whole trace at once. A quarter of the ranges are freed by whichever thread gets to them first,
+    // so they end up in other thread caches. Mapped ranges are stamped when allocated and checked when freed
+    [[nodiscard]] static StressResult stress( Trace const & Ops, BenchOptions const & Options ) noexcept
+    {
+      using Clock = std::chrono::steady_clock;
+
+      struct Live
+      {
+        Engine::AllocationID ID;
+        std::byte *          Data;
+        uint64_t             Stamp;
+      };
+
+      auto Failed    = std::atomic<uint64_t>( 0 );
+      auto HandedOff = std::atomic<uint64_t>( 0 );
+      auto Corrupted = std::atomic<uint64_t>( 0 );
+      auto Mtx       = std::mutex();
+      auto Handoff   = std::vector<Live>();
+
+      auto const release = [&Corrupted]( Live const & Freed )
+      {
+        if ( Freed.Data != nullptr && std::memcmp( Freed.Data, &Freed.Stamp, sizeof( Freed.Stamp ) ) != 0 )
+        {
+          ++Corrupted;
+        }
+
+        Engine::AllocatorContext::the().free( Freed.ID );
+      };
+
+      auto const releaseHandoff = [&Mtx, &Handoff, &release]
+      {
+        auto Taken = std::vector<Live>();
+
+        {
+          auto Lock = std::scoped_lock( Mtx );
+          Taken.swap( Handoff );
+        }
+
+        for ( auto const & Freed : Taken )
+        {
+          release( Freed );
+        }
+      };
+
+      auto const run = [&]( uint32_t ThreadIdx )
+      {
+        auto Lives = std::vector<std::optional<Live>>( getAllocCnt( Ops ) );
+
+        for ( auto Idx = size_t( 0 ); Idx < std::size( Ops ); ++Idx )
+        {
+          auto const & Op = Ops[Idx];
+
+          if ( Op.Op == TraceOp::Kind::Allocate )
+          {
+            auto const Allocation = Engine::AllocatorContext::the().allocate( Op.Type, Op.Size, Op.Alignment, Op.MemType );
+
+            if ( !Allocation.has_value() )
+            {
+              ++Failed;
+              continue;
+            }
+
+            auto const   Stamp = ( static_cast<uint64_t>( ThreadIdx ) << 32U ) | Op.AllocIdx;
+            auto * const Data  = Op.Size >= sizeof( Stamp ) ? Allocation->Data : nullptr;
+
+            if ( Data != nullptr )
+            {
+              std::memcpy( Data, &Stamp, sizeof( Stamp ) );
+            }
+
+            Lives[Op.AllocIdx] = Live{ Allocation->ID, Data, Stamp };
+          }
+          else if ( Lives[Op.AllocIdx].has_value() )
+          {
+            if ( Op.AllocIdx % 4 == 0 )
+            {
+              auto Lock = std::scoped_lock( Mtx );
+              Handoff.push_back( *Lives[Op.AllocIdx] );
+              ++HandedOff;
+            }
+            else
+            {
+              release( *Lives[Op.AllocIdx] );
+            }
+
+            Lives[Op.AllocIdx].reset();
+          }
+
+          if ( ( Idx + 1 ) % Options.FrameOps == 0 )
+          {
+            releaseHandoff();
+          }
+        }
+
+        // Recorded traces don't have to free everything
+        for ( auto const & Alive : Lives )
+        {
+          if ( Alive.has_value() )
+          {
+            release( *Alive );
+          }
+        }
+
+        releaseHandoff();
+      };
+
+      initMockDevice( Options.Device );
+
+      auto const Start   = Clock::now();
+      auto       Threads = std::vector<std::thread>();
+
+      for ( auto ThreadIdx = uint32_t( 0 ); ThreadIdx < Options.ThreadCnt; ++ThreadIdx )
+      {
+        Threads.emplace_back( run, ThreadIdx );
+      }
+
+      for ( auto & Thread : Threads )
+      {
+        Thread.join();
+      }
+
+      auto Result    = StressResult();
+      Result.OpCnt   = static_cast<uint64_t>( std::size( Ops ) ) * Options.ThreadCnt;
+      Result.Seconds = std::chrono::duration<double>( Clock::now() - Start ).count();
+
+      // On a thread of its own so its cache is given back too
+      std::thread( releaseHandoff ).join();
+
+      auto const Stats = Engine::AllocatorContext::the().getStats();
+
+      for ( auto Idx = uint32_t( 0 ); Idx < Stats.HeapCnt; ++Idx )
+      {
+        Result.LeakedBytes += Stats.Heaps[Idx].Mem.UsedBytes;
+      }
+
+      Result.FailedAllocs = Failed;
+      Result.HandedOff    = HandedOff;
+      Result.Corrupted    = Corrupted;
+      Result.Counters     = getMockCounters();
+      shutdownMockDevice();
+
+      return Result;
+    }
+
+    static void printResult( BenchResult & Result ) noexcept
+    {
+      auto const OpCnt   = std::size( Result.AllocNs ) + std::size( Result.FreeNs );
+      auto const Seconds = getSeconds( Result.AllocNs ) + getSeconds( Result.FreeNs );
+
+      std::printf( "%-10.*s %12.0f %9llu %9llu %9llu %9llu %10.1f %8llu %7llu %6.3f %6.3f\n",
+                   static_cast<int>( std::size( Result.Name ) ),
+                   std::data( Result.Name ),
+                   Seconds > 0.0 ? static_cast<double>( OpCnt ) / Seconds : 0.0,
+                   static_cast<unsigned long long>( getPercentile( Result.AllocNs, 50 ) ),
+                   static_cast<unsigned long long>( getPercentile( Result.AllocNs, 99 ) ),
+                   static_cast<unsigned long long>( getPercentile( Result.FreeNs, 50 ) ),
+                   static_cast<unsigned long long>( getPercentile( Result.FreeNs, 99 ) ),
+                   static_cast<double>( Result.Counters.PeakReservedBytes ) / ( 1024.0 * 1024.0 ),
+                   static_cast<unsigned long long>( Result.Counters.AllocateCalls ),
+                   static_cast<unsigned long long>( Result.FailedAllocs ),
+                   static_cast<double>( Result.MeanFragmentation ),
+                   static_cast<double>( Result.MaxFragmentation ) );
+    }
+
+  }  // namespace Detail
+
+}  // namespace Mvk::Tools
+
+int main( int Argc, char ** Argv )
+{
+  auto const Options = Mvk::Tools::Detail::parseOptions( Argc, Argv );
+
+  if ( !Options.has_value() )
+  {
+    Mvk::Tools::Detail::printUsage();
+    return 1;
+  }
+
+  auto const Ops = [&Options]
+  {
+    if ( !Options->TracePath.empty() )
+    {
+      return Mvk::Tools::readTrace( Options->TracePath );
+    }
+
+    return std::optional( Mvk::Tools::genSyntheticTrace( Options->AllocCnt, Options->Seed ) );
+  }();
+
+  if ( !Ops.has_value() )
+  {
+    std::fprintf( stderr, "couldn't read trace %s\n", Options->TracePath.c_str() );
+    return 1;
+  }
+
+  if ( !Options->RecordPath.empty() && !Mvk::Tools::writeTrace( Options->RecordPath, *Ops ) )
+  {
+    std::fprintf( stderr, "couldn't write trace %s\n", Options->RecordPath.c_str() );
+    return 1;
+  }
+
+  std::printf( "%zu ops, %u allocations, latencies in ns\n", std::size( *Ops ), Mvk::Tools::getAllocCnt( *Ops ) );
+  std::printf( "%-10s %12s %9s %9s %9s %9s %10s %8s %7s %6s %6s\n",
+               "strategy",
+               "ops/s",
+               "alloc p50",
+               "alloc p99",
+               "free p50",
+               "free p99",
+               "peak MiB",
+               "vkAlloc",
+               "failed",
+               "frag",
+               "frag max" );
+
+  for ( auto const Name : Options->Strategies )
+  {
+    auto Result = Mvk::Tools::Detail::replay( Name, *Ops, *Options );
+    Mvk::Tools::Detail::printResult( Result );
+  }
+
+  if ( Options->ThreadCnt == 0 )
+  {
+    return 0;
+  }
+
+  auto const Stress = Mvk::Tools::Detail::stress( *Ops, *Options );
+
+  std::printf( "\n%u threads: %.0f ops/s, peak %.1f MiB, %llu failed, %llu freed by another thread, %llu corrupted, %.1f MiB leaked\n",
+               Options->ThreadCnt,
+               Stress.Seconds > 0.0 ? static_cast<double>( Stress.OpCnt ) / Stress.Seconds : 0.0,
+               static_cast<double>( Stress.Counters.PeakReservedBytes ) / ( 1024.0 * 1024.0 ),
+               static_cast<unsigned long long>( Stress.FailedAllocs ),
+               static_cast<unsigned long long>( Stress.HandedOff ),
+               static_cast<unsigned long long>( Stress.Corrupted ),
+               static_cast<double>( Stress.LeakedBytes ) / ( 1024.0 * 1024.0 ) );
+
+  return Stress.Corrupted == 0 && Stress.LeakedBytes == 0 ? 0 : 1;
+}
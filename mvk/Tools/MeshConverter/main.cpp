@@ -0,0 +1,63 @@
+#include "Detail/AssetCache.hpp"
+#include "Detail/MeshFile.hpp"
+#include "Detail/Readers.hpp"
+#include "Detail/VtxPack.hpp"
+#include "Engine/VtxLayout.hpp"
+
+#include <cstdio>
+#include <filesystem>
+
+// Same steps as the OBJ fallback of the renderer, only done once. The vertices are the ones of the renderer's layout, so
+// the tool has to be built with the same MVK_FULL_VERTICES
+int main( int Argc, char ** Argv )
+{
+  if ( Argc != 2 && Argc != 3 )
+  {
+    std::printf( "usage: mesh-converter <input.obj> [output.mvkm]\n"
+                 "  the output defaults to the input with the extension replaced\n" );
+    return 1;
+  }
+
+  auto const InPath  = std::filesystem::path( Argv[1] );
+  auto const OutPath = Argc == 3 ? std::filesystem::path( Argv[2] ) : std::filesystem::path( InPath ).replace_extension( ".mvkm" );
+
+  if ( !std::filesystem::exists( InPath ) )
+  {
+    std::fprintf( stderr, "couldn't find %s\n", InPath.c_str() );
+    return 1;
+  }
+
+  auto       Report       = Mvk::Detail::ObjReport();
+  auto const [Vtxs, Idxs] = Mvk::Detail::readObj( InPath, &Report );
+  auto const Mesh         = Mvk::Detail::buildVtxs<Mvk::Engine::ModelVtxLayout::Vertex>( Vtxs );
+
+  if ( Report.IsFallback )
+  {
+    std::printf( "%s: not handled by the chunked parser, used tinyobj\n", InPath.c_str() );
+  }
+
+  std::printf( "%s: %zu -> %zu vertices, ACMR %.3f -> %.3f\n",
+               InPath.c_str(),
+               Report.Opt.VtxCntBefore,
+               Report.Opt.VtxCntAfter,
+               static_cast<double>( Report.Opt.AcmrBefore ),
+               static_cast<double>( Report.Opt.AcmrAfter ) );
+
+  // The renderer compares them against the OBJ next to the output and parses the OBJ again when they differ
+  auto const SrcHash  = Mvk::Detail::hashSrc( InPath, Mvk::Detail::AssetKind::Mesh, Mvk::Engine::ModelVtxLayout::Stride );
+  auto const SrcStamp = Mvk::Detail::getFileStamp( InPath );
+
+  if ( !Mvk::Detail::writeMesh( OutPath, Mesh, Idxs, SrcHash.value_or( 0 ), SrcStamp.value_or( Mvk::Detail::FileStamp() ) ) )
+  {
+    std::fprintf( stderr, "couldn't write %s\n", OutPath.c_str() );
+    return 1;
+  }
+
+  std::printf( "%s: %zu vertices, %zu indices, %ju bytes\n",
+               OutPath.c_str(),
+               std::size( Mesh.Vtxs ),
+               std::size( Idxs ),
+               static_cast<uintmax_t>( std::filesystem::file_size( OutPath ) ) );
+
+  return 0;
+}
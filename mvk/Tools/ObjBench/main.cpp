@@ -0,0 +1,305 @@
+#include "Detail/MappedFile.hpp"
+#include "Detail/ObjParser.hpp"
+#include "Detail/Readers.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Mvk::Tools
+{
+  struct BenchOptions
+  {
+    std::vector<std::filesystem::path> Paths;
+    std::filesystem::path              Dir     = std::filesystem::temp_directory_path();
+    uint64_t                           MaxTris = 1000000;
+    uint32_t                           Threads = 0;
+    uint32_t                           RunCnt  = 3;
+  };
+
+  namespace Detail
+  {
+    using Clock = std::chrono::steady_clock;
+
+    template <typename T> [[nodiscard]] static bool parseNum( std::string_view Str, T & Value ) noexcept
+    {
+      auto const [End, Error] = std::from_chars( std::data( Str ), std::data( Str ) + std::size( Str ), Value );
+      return Error == std::errc() && End == std::data( Str ) + std::size( Str );
+    }
+
+    static void printUsage() noexcept
+    {
+      std::printf( "usage: obj-bench [options] [file.obj...]\n"
+                   "  without files, grids of 10k tris and up are generated, 10x bigger each time\n"
+                   "  --max-tris <n>  biggest generated grid (default 1000000)\n"
+                   "  --dir <path>    where the generated files go (default the temp directory)\n"
+                   "  --threads <n>   threads of the chunked parser, 0 is one per core (default 0)\n"
+                   "  --runs <n>      the best of n runs is kept (default 3)\n" );
+    }
+
+    [[nodiscard]] static std::optional<BenchOptions> parseOptions( int Argc, char ** Argv ) noexcept
+    {
+      auto Options = BenchOptions();
+
+      for ( auto Idx = 1; Idx < Argc; ++Idx )
+      {
+        auto const Arg = std::string_view( Argv[Idx] );
+
+        if ( !Arg.starts_with( "--" ) )
+        {
+          Options.Paths.emplace_back( Arg );
+          continue;
+        }
+
+        if ( Idx + 1 == Argc )
+        {
+          return std::nullopt;
+        }
+
+        auto const Value = std::string_view( Argv[++Idx] );
+
+        auto IsValid = true;
+
+        if ( Arg == "--max-tris" )
+        {
+          IsValid = parseNum( Value, Options.MaxTris );
+        }
+        else if ( Arg == "--dir" )
+        {
+          Options.Dir = Value;
+        }
+        else if ( Arg == "--threads" )
+        {
+          IsValid = parseNum( Value, Options.Threads );
+        }
+        else if ( Arg == "--runs" )
+        {
+          IsValid = parseNum( Value, Options.RunCnt ) && Options.RunCnt != 0;
+        }
+        else
+        {
+          IsValid = false;
+        }
+
+        if ( !IsValid )
+        {
+          return std::nullopt;
+        }
+      }
+
+      return Options;
+    }
+
+    // Wavy grid with UVs, half the cells are quads and half are two triangles. Every other row of faces uses relative
+    // indices so chunks have to resolve them against the ones before
+    [[nodiscard]] static bool writeGrid( std::filesystem::path const & Path, uint64_t TriCnt ) noexcept
+    {
+      auto const Cells = std::max( uint64_t( 1 ), static_cast<uint64_t>( std::sqrt( static_cast<double>( TriCnt / 2 ) ) ) );
+      auto const Side  = Cells + 1;
+
+      auto * File = std::fopen( Path.c_str(), "w" );
+
+      if ( File == nullptr )
+      {
+        return false;
+      }
+
+      std::fprintf( File, "# obj-bench grid, %llu cells\no grid\n", static_cast<unsigned long long>( Cells * Cells ) );
+
+      for ( auto Y = uint64_t( 0 ); Y < Side; ++Y )
+      {
+        for ( auto X = uint64_t( 0 ); X < Side; ++X )
+        {
+          auto const U = static_cast<double>( X ) / static_cast<double>( Cells );
+          auto const V = static_cast<double>( Y ) / static_cast<double>( Cells );
+
+          auto const Height = std::sin( U * 40.0 ) * std::cos( V * 30.0 );
+
+          std::fprintf( File, "v %.6f %.6f %.6f\nvt %.6f %.6f\n", U * 10.0 - 5.0, Height, V * 10.0 - 5.0, U, V );
+        }
+      }
+
+      auto const VtxCnt = static_cast<long long>( Side * Side );
+
+      for ( auto Y = uint64_t( 0 ); Y < Cells; ++Y )
+      {
+        for ( auto X = uint64_t( 0 ); X < Cells; ++X )
+        {
+          auto const Corners = std::array{ static_cast<long long>( Y * Side + X + 1 ),
+                                           static_cast<long long>( Y * Side + X + 2 ),
+                                           static_cast<long long>( ( Y + 1 ) * Side + X + 2 ),
+                                           static_cast<long long>( ( Y + 1 ) * Side + X + 1 ) };
+
+          auto const getIdx = [Y, VtxCnt]( long long Idx ) { return Y % 2 == 0 ? Idx : Idx - VtxCnt - 1; };
+
+          if ( ( X + Y ) % 2 == 0 )
+          {
+            std::fprintf( File, "f" );
+
+            for ( auto const Corner : Corners )
+            {
+              std::fprintf( File, " %lld/%lld", getIdx( Corner ), getIdx( Corner ) );
+            }
+
+            std::fprintf( File, "\n" );
+          }
+          else
+          {
+            std::fprintf( File,
+                          "f %lld/%lld %lld/%lld %lld/%lld\nf %lld/%lld %lld/%lld %lld/%lld\n",
+                          getIdx( Corners[0] ),
+                          getIdx( Corners[0] ),
+                          getIdx( Corners[1] ),
+                          getIdx( Corners[1] ),
+                          getIdx( Corners[2] ),
+                          getIdx( Corners[2] ),
+                          getIdx( Corners[0] ),
+                          getIdx( Corners[0] ),
+                          getIdx( Corners[2] ),
+                          getIdx( Corners[2] ),
+                          getIdx( Corners[3] ),
+                          getIdx( Corners[3] ) );
+          }
+        }
+      }
+
+      return std::fclose( File ) == 0;
+    }
+
+    template <typename Fn> [[nodiscard]] static double getBestMs( uint32_t RunCnt, Fn const & Func ) noexcept
+    {
+      auto Best = std::numeric_limits<double>::max();
+
+      for ( auto Run = uint32_t( 0 ); Run < RunCnt; ++Run )
+      {
+        auto const Start = Clock::now();
+        Func();
+        Best = std::min( Best, std::chrono::duration<double, std::milli>( Clock::now() - Start ).count() );
+      }
+
+      return Best;
+    }
+
+    [[nodiscard]] static bool getIsSame( std::pair<std::vector<vertex>, std::vector<uint32_t>> const & Lhs,
+                                         std::pair<std::vector<vertex>, std::vector<uint32_t>> const & Rhs ) noexcept
+    {
+      auto const isSameVtx = []( vertex const & L, vertex const & R )
+      { return L.pos == R.pos && L.color == R.color && L.texture_coord == R.texture_coord; };
+
+      return std::equal( std::begin( Lhs.first ), std::end( Lhs.first ), std::begin( Rhs.first ), std::end( Rhs.first ), isSameVtx )
+          && Lhs.second == Rhs.second;
+    }
+
+    // Both sides start from the path, tinyobj reads the file itself
+    static void bench( std::filesystem::path const & Path, BenchOptions const & Options, uint32_t ThreadCnt ) noexcept
+    {
+      auto Reference = std::pair<std::vector<vertex>, std::vector<uint32_t>>();
+      auto Parsed    = std::optional<std::pair<std::vector<vertex>, std::vector<uint32_t>>>();
+
+      auto const TinyobjMs = getBestMs( Options.RunCnt, [&] { Reference = Mvk::Detail::parseObjTinyobj( Path ); } );
+
+      auto const getChunkedMs = [&]( uint32_t Threads )
+      {
+        return getBestMs( Options.RunCnt,
+                          [&]
+                          {
+                            auto const File = Mvk::Detail::MappedFile( Path );
+                            Parsed          = Mvk::Detail::parseObj( File.getData(), Threads );
+                          } );
+      };
+
+      auto const SingleMs = getChunkedMs( 1 );
+      auto const IsSame   = Parsed.has_value() && getIsSame( Reference, *Parsed );
+      auto const MultiMs  = getChunkedMs( ThreadCnt );
+      auto const IsSameMt = Parsed.has_value() && getIsSame( Reference, *Parsed );
+
+      auto const MiB = static_cast<double>( std::filesystem::file_size( Path ) ) / ( 1024.0 * 1024.0 );
+
+      std::printf( "%-24s %9.1f %10zu %11.2f %11.2f %11.2f %8.2f %9.1f %6s\n",
+                   Path.filename().c_str(),
+                   MiB,
+                   std::size( Reference.second ) / 3,
+                   TinyobjMs,
+                   SingleMs,
+                   MultiMs,
+                   TinyobjMs / MultiMs,
+                   MiB / ( MultiMs * 1e-3 ),
+                   IsSame && IsSameMt ? "yes" : "NO" );
+    }
+
+  }  // namespace Detail
+
+}  // namespace Mvk::Tools
+
+int main( int Argc, char ** Argv )
+{
+  auto Options = Mvk::Tools::Detail::parseOptions( Argc, Argv );
+
+  if ( !Options.has_value() )
+  {
+    Mvk::Tools::Detail::printUsage();
+    return 1;
+  }
+
+  auto const ThreadCnt = Options->Threads != 0 ? Options->Threads : std::max( std::thread::hardware_concurrency(), 1U );
+  auto       Generated = std::vector<std::filesystem::path>();
+
+  if ( Options->Paths.empty() )
+  {
+    for ( auto TriCnt = uint64_t( 10000 ); TriCnt <= Options->MaxTris; TriCnt *= 10 )
+    {
+      auto Path = Options->Dir / ( "obj-bench-" + std::to_string( TriCnt ) + ".obj" );
+
+      if ( !Mvk::Tools::Detail::writeGrid( Path, TriCnt ) )
+      {
+        std::fprintf( stderr, "couldn't write %s\n", Path.c_str() );
+        return 1;
+      }
+
+      Generated.push_back( Path );
+    }
+
+    Options->Paths = Generated;
+  }
+
+  std::printf( "best of %u runs, %u threads, times in ms\n", Options->RunCnt, ThreadCnt );
+  std::printf( "%-24s %9s %10s %11s %11s %11s %8s %9s %6s\n",
+               "file",
+               "MiB",
+               "tris",
+               "tinyobj",
+               "chunked 1T",
+               "chunked NT",
+               "speedup",
+               "MiB/s",
+               "same" );
+
+  for ( auto const & Path : Options->Paths )
+  {
+    if ( !std::filesystem::exists( Path ) )
+    {
+      std::fprintf( stderr, "couldn't find %s\n", Path.c_str() );
+      return 1;
+    }
+
+    Mvk::Tools::Detail::bench( Path, *Options, ThreadCnt );
+  }
+
+  for ( auto const & Path : Generated )
+  {
+    auto Error = std::error_code();
+    std::filesystem::remove( Path, Error );
+  }
+
+  return 0;
+}
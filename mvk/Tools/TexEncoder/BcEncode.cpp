@@ -0,0 +1,721 @@
+#include "Tools/TexEncoder/BcEncode.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <utility>
+
+#if defined( __SSE2__ )
+#  include <emmintrin.h>
+#endif
+
+namespace Mvk::Tools
+{
+  namespace
+  {
+    using Color = std::array<float, 4>;
+
+    // Split by channel so the palette search can take four texels at a time
+    struct Texels
+    {
+      std::array<float, 16> R;
+      std::array<float, 16> G;
+      std::array<float, 16> B;
+      std::array<float, 16> A;
+    };
+
+    using Idxs = std::array<uint8_t, 16>;
+
+    // Weights of the 4 bit BC7 indices, out of 64
+    constexpr auto Bc7Weights = std::array<uint32_t, 16>{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    [[nodiscard]] Texels toTexels( Block const & In, bool HasAlpha ) noexcept
+    {
+      auto Out = Texels();
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        Out.R[Idx] = In[Idx][0];
+        Out.G[Idx] = In[Idx][1];
+        Out.B[Idx] = In[Idx][2];
+        Out.A[Idx] = HasAlpha ? In[Idx][3] : 0.0F;
+      }
+
+      return Out;
+    }
+
+    [[nodiscard]] Color getTexel( Texels const & In, size_t Idx ) noexcept
+    {
+      return { In.R[Idx], In.G[Idx], In.B[Idx], In.A[Idx] };
+    }
+
+    // Closest palette entry of every texel, returns the summed squared error. Every value is an integer well below 2^24 so
+    // both paths give the same indices and the same error
+    [[nodiscard]] float fitPalette( Texels const & In, std::span<Color const> Palette, Idxs & Out ) noexcept
+    {
+      auto Err = 0.0F;
+
+#if defined( __SSE2__ )
+      for ( auto Base = size_t( 0 ); Base < 16; Base += 4 )
+      {
+        auto const R = _mm_loadu_ps( &In.R[Base] );
+        auto const G = _mm_loadu_ps( &In.G[Base] );
+        auto const B = _mm_loadu_ps( &In.B[Base] );
+        auto const A = _mm_loadu_ps( &In.A[Base] );
+
+        auto Best    = _mm_set1_ps( std::numeric_limits<float>::max() );
+        auto BestIdx = _mm_setzero_ps();
+
+        for ( auto Idx = size_t( 0 ); Idx < std::size( Palette ); ++Idx )
+        {
+          auto const Dr = _mm_sub_ps( R, _mm_set1_ps( Palette[Idx][0] ) );
+          auto const Dg = _mm_sub_ps( G, _mm_set1_ps( Palette[Idx][1] ) );
+          auto const Db = _mm_sub_ps( B, _mm_set1_ps( Palette[Idx][2] ) );
+          auto const Da = _mm_sub_ps( A, _mm_set1_ps( Palette[Idx][3] ) );
+
+          auto Dist = _mm_mul_ps( Dr, Dr );
+          Dist      = _mm_add_ps( Dist, _mm_mul_ps( Dg, Dg ) );
+          Dist      = _mm_add_ps( Dist, _mm_mul_ps( Db, Db ) );
+          Dist      = _mm_add_ps( Dist, _mm_mul_ps( Da, Da ) );
+
+          auto const IsCloser = _mm_cmplt_ps( Dist, Best );
+          Best                = _mm_min_ps( Dist, Best );
+          BestIdx = _mm_or_ps( _mm_and_ps( IsCloser, _mm_set1_ps( static_cast<float>( Idx ) ) ), _mm_andnot_ps( IsCloser, BestIdx ) );
+        }
+
+        auto Lanes    = std::array<float, 4>();
+        auto LaneErrs = std::array<float, 4>();
+        _mm_storeu_ps( std::data( Lanes ), BestIdx );
+        _mm_storeu_ps( std::data( LaneErrs ), Best );
+
+        for ( auto Lane = size_t( 0 ); Lane < 4; ++Lane )
+        {
+          Out[Base + Lane]  = static_cast<uint8_t>( Lanes[Lane] );
+          Err              += LaneErrs[Lane];
+        }
+      }
+#else
+      for ( auto Texel = size_t( 0 ); Texel < 16; ++Texel )
+      {
+        auto Best    = std::numeric_limits<float>::max();
+        auto BestIdx = size_t( 0 );
+
+        for ( auto Idx = size_t( 0 ); Idx < std::size( Palette ); ++Idx )
+        {
+          auto const Dr = In.R[Texel] - Palette[Idx][0];
+          auto const Dg = In.G[Texel] - Palette[Idx][1];
+          auto const Db = In.B[Texel] - Palette[Idx][2];
+          auto const Da = In.A[Texel] - Palette[Idx][3];
+
+          auto const Dist = Dr * Dr + Dg * Dg + Db * Db + Da * Da;
+
+          if ( Dist < Best )
+          {
+            Best    = Dist;
+            BestIdx = Idx;
+          }
+        }
+
+        Out[Texel]  = static_cast<uint8_t>( BestIdx );
+        Err        += Best;
+      }
+#endif
+
+      return Err;
+    }
+
+    // Ends of the principal axis through the texels, found by power iteration on their covariance
+    [[nodiscard]] std::pair<Color, Color> calcEndpoints( Texels const & In ) noexcept
+    {
+      auto Mean = Color();
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        auto const Texel = getTexel( In, Idx );
+
+        for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+        {
+          Mean[Ch] += Texel[Ch] / 16.0F;
+        }
+      }
+
+      auto Cov = std::array<Color, 4>();
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        auto const Texel = getTexel( In, Idx );
+
+        for ( auto Row = size_t( 0 ); Row < 4; ++Row )
+        {
+          for ( auto Col = size_t( 0 ); Col < 4; ++Col )
+          {
+            Cov[Row][Col] += ( Texel[Row] - Mean[Row] ) * ( Texel[Col] - Mean[Col] );
+          }
+        }
+      }
+
+      auto Axis = Color{ 1.0F, 1.0F, 1.0F, 1.0F };
+
+      for ( auto Iter = 0; Iter < 8; ++Iter )
+      {
+        auto Next = Color();
+
+        for ( auto Row = size_t( 0 ); Row < 4; ++Row )
+        {
+          for ( auto Col = size_t( 0 ); Col < 4; ++Col )
+          {
+            Next[Row] += Cov[Row][Col] * Axis[Col];
+          }
+        }
+
+        auto const Length = std::sqrt( Next[0] * Next[0] + Next[1] * Next[1] + Next[2] * Next[2] + Next[3] * Next[3] );
+
+        if ( Length < 1e-6F )
+        {
+          return { Mean, Mean };
+        }
+
+        for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+        {
+          Axis[Ch] = Next[Ch] / Length;
+        }
+      }
+
+      auto Min = std::numeric_limits<float>::max();
+      auto Max = std::numeric_limits<float>::lowest();
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        auto const Texel = getTexel( In, Idx );
+        auto       Proj  = 0.0F;
+
+        for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+        {
+          Proj += ( Texel[Ch] - Mean[Ch] ) * Axis[Ch];
+        }
+
+        Min = std::min( Min, Proj );
+        Max = std::max( Max, Proj );
+      }
+
+      auto Lo = Color();
+      auto Hi = Color();
+
+      for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+      {
+        Lo[Ch] = std::clamp( Mean[Ch] + Axis[Ch] * Min, 0.0F, 255.0F );
+        Hi[Ch] = std::clamp( Mean[Ch] + Axis[Ch] * Max, 0.0F, 255.0F );
+      }
+
+      return { Lo, Hi };
+    }
+
+    // Least squares endpoints for the weights the indices ended up with, texel = (1 - W) * Lo + W * Hi. Leaves them alone
+    // when every texel got the same weight
+    void refineEndpoints( Texels const & In, std::array<float, 16> const & Weights, Color & Lo, Color & Hi ) noexcept
+    {
+      auto A  = 0.0F;
+      auto B  = 0.0F;
+      auto C  = 0.0F;
+      auto Xs = Color();
+      auto Ys = Color();
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        auto const W     = Weights[Idx];
+        auto const Texel = getTexel( In, Idx );
+
+        A += ( 1.0F - W ) * ( 1.0F - W );
+        B += ( 1.0F - W ) * W;
+        C += W * W;
+
+        for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+        {
+          Xs[Ch] += ( 1.0F - W ) * Texel[Ch];
+          Ys[Ch] += W * Texel[Ch];
+        }
+      }
+
+      auto const Det = A * C - B * B;
+
+      if ( std::abs( Det ) < 1e-3F )
+      {
+        return;
+      }
+
+      for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+      {
+        Lo[Ch] = std::clamp( ( C * Xs[Ch] - B * Ys[Ch] ) / Det, 0.0F, 255.0F );
+        Hi[Ch] = std::clamp( ( A * Ys[Ch] - B * Xs[Ch] ) / Det, 0.0F, 255.0F );
+      }
+    }
+
+    // Bits go in from the least significant bit of the first byte
+    class BitWriter
+    {
+    public:
+      explicit BitWriter( std::span<std::byte> Out ) noexcept : Out( Out ), Pos( 0 ) {}
+
+      void write( uint32_t Value, uint32_t Cnt ) noexcept
+      {
+        for ( auto Bit = uint32_t( 0 ); Bit < Cnt; ++Bit, ++Pos )
+        {
+          Out[Pos / 8] |= static_cast<std::byte>( ( ( Value >> Bit ) & 1U ) << ( Pos % 8 ) );
+        }
+      }
+
+    private:
+      std::span<std::byte> Out;
+      uint32_t             Pos;
+    };
+
+    class BitReader
+    {
+    public:
+      explicit BitReader( std::span<std::byte const> In ) noexcept : In( In ), Pos( 0 ) {}
+
+      [[nodiscard]] uint32_t read( uint32_t Cnt ) noexcept
+      {
+        auto Value = uint32_t( 0 );
+
+        for ( auto Bit = uint32_t( 0 ); Bit < Cnt; ++Bit, ++Pos )
+        {
+          Value |= ( ( std::to_integer<uint32_t>( In[Pos / 8] ) >> ( Pos % 8 ) ) & 1U ) << Bit;
+        }
+
+        return Value;
+      }
+
+    private:
+      std::span<std::byte const> In;
+      uint32_t                   Pos;
+    };
+
+    [[nodiscard]] uint16_t to565( Color const & In ) noexcept
+    {
+      auto const quantize = []( float Value, float Max )
+      { return static_cast<uint16_t>( std::clamp( std::lround( Value * Max / 255.0F ), 0L, static_cast<long>( Max ) ) ); };
+
+      return static_cast<uint16_t>( quantize( In[0], 31.0F ) << 11U | quantize( In[1], 63.0F ) << 5U | quantize( In[2], 31.0F ) );
+    }
+
+    [[nodiscard]] std::array<uint32_t, 3> from565( uint16_t In ) noexcept
+    {
+      auto const R = ( In >> 11U ) & 31U;
+      auto const G = ( In >> 5U ) & 63U;
+      auto const B = In & 31U;
+
+      return { R << 3U | R >> 2U, G << 2U | G >> 4U, B << 3U | B >> 2U };
+    }
+
+    // The 4 color palette, also what BC3 always uses
+    [[nodiscard]] std::array<Color, 4> getBc1Palette( uint16_t C0, uint16_t C1 ) noexcept
+    {
+      auto const E0 = from565( C0 );
+      auto const E1 = from565( C1 );
+
+      auto Palette = std::array<Color, 4>();
+
+      for ( auto Ch = size_t( 0 ); Ch < 3; ++Ch )
+      {
+        Palette[0][Ch] = static_cast<float>( E0[Ch] );
+        Palette[1][Ch] = static_cast<float>( E1[Ch] );
+        Palette[2][Ch] = static_cast<float>( ( 2 * E0[Ch] + E1[Ch] ) / 3 );
+        Palette[3][Ch] = static_cast<float>( ( E0[Ch] + 2 * E1[Ch] ) / 3 );
+      }
+
+      return Palette;
+    }
+
+    [[nodiscard]] std::array<std::byte, 8> packBc1( uint16_t C0, uint16_t C1, Idxs const & Indices ) noexcept
+    {
+      auto Bits = uint32_t( 0 );
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        Bits |= static_cast<uint32_t>( Indices[Idx] ) << ( 2 * Idx );
+      }
+
+      auto Out = std::array<std::byte, 8>();
+      std::memcpy( std::data( Out ) + 0, &C0, 2 );
+      std::memcpy( std::data( Out ) + 2, &C1, 2 );
+      std::memcpy( std::data( Out ) + 4, &Bits, 4 );
+      return Out;
+    }
+
+    [[nodiscard]] std::array<std::byte, 8> encodeColor( Block const & In ) noexcept
+    {
+      constexpr auto Weights = std::array{ 0.0F, 1.0F, 1.0F / 3.0F, 2.0F / 3.0F };
+
+      auto const Colors  = toTexels( In, false );
+      auto [Lo, Hi]      = calcEndpoints( Colors );
+      auto       BestErr = std::numeric_limits<float>::max();
+      auto       BestOut = std::array<std::byte, 8>();
+
+      for ( auto Pass = 0; Pass < 2; ++Pass )
+      {
+        auto C0 = to565( Hi );
+        auto C1 = to565( Lo );
+
+        if ( C0 < C1 )
+        {
+          std::swap( C0, C1 );
+        }
+
+        // Equal ends would switch to the 3 color mode, where index 3 is black
+        if ( C0 == C1 )
+        {
+          return packBc1( C0, C1, Idxs() );
+        }
+
+        auto       Indices = Idxs();
+        auto const Palette = getBc1Palette( C0, C1 );
+        auto const Err     = fitPalette( Colors, Palette, Indices );
+
+        if ( Err < BestErr )
+        {
+          BestErr = Err;
+          BestOut = packBc1( C0, C1, Indices );
+        }
+
+        auto TexelWeights = std::array<float, 16>();
+
+        for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+        {
+          TexelWeights[Idx] = Weights[Indices[Idx]];
+        }
+
+        // Which end becomes C0 doesn't matter, the next pass orders them again
+        refineEndpoints( Colors, TexelWeights, Lo, Hi );
+      }
+
+      return BestOut;
+    }
+
+    [[nodiscard]] std::array<uint32_t, 8> getAlphaPalette( uint32_t A0, uint32_t A1 ) noexcept
+    {
+      auto Palette = std::array<uint32_t, 8>{ A0, A1 };
+
+      if ( A0 > A1 )
+      {
+        for ( auto Idx = uint32_t( 1 ); Idx < 7; ++Idx )
+        {
+          Palette[Idx + 1] = ( ( 7 - Idx ) * A0 + Idx * A1 ) / 7;
+        }
+
+        return Palette;
+      }
+
+      // The 6 level mode, only written for flat blocks where every index is 0
+      for ( auto Idx = uint32_t( 1 ); Idx < 5; ++Idx )
+      {
+        Palette[Idx + 1] = ( ( 5 - Idx ) * A0 + Idx * A1 ) / 5;
+      }
+
+      Palette[6] = 0;
+      Palette[7] = 255;
+      return Palette;
+    }
+
+    [[nodiscard]] std::array<std::byte, 8> encodeAlpha( Block const & In ) noexcept
+    {
+      auto Alphas = Texels();
+      auto Min    = uint32_t( 255 );
+      auto Max    = uint32_t( 0 );
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        Alphas.A[Idx] = In[Idx][3];
+        Min           = std::min<uint32_t>( Min, In[Idx][3] );
+        Max           = std::max<uint32_t>( Max, In[Idx][3] );
+      }
+
+      auto Indices = Idxs();
+
+      if ( Min != Max )
+      {
+        auto const Levels  = getAlphaPalette( Max, Min );
+        auto       Palette = std::array<Color, 8>();
+
+        for ( auto Idx = size_t( 0 ); Idx < 8; ++Idx )
+        {
+          Palette[Idx][3] = static_cast<float>( Levels[Idx] );
+        }
+
+        static_cast<void>( fitPalette( Alphas, Palette, Indices ) );
+      }
+
+      auto Bits = uint64_t( 0 );
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        Bits |= static_cast<uint64_t>( Indices[Idx] ) << ( 3 * Idx );
+      }
+
+      auto Out = std::array<std::byte, 8>{ static_cast<std::byte>( Max ), static_cast<std::byte>( Min ) };
+      std::memcpy( std::data( Out ) + 2, &Bits, 6 );
+      return Out;
+    }
+
+    // Each channel becomes 7 bits and a p-bit shared by the endpoint, picks the p-bit closer to the endpoint
+    [[nodiscard]] std::pair<std::array<uint32_t, 4>, uint32_t> quantizeBc7( Color const & In ) noexcept
+    {
+      auto Best    = std::array<uint32_t, 4>();
+      auto BestP   = uint32_t( 0 );
+      auto BestErr = std::numeric_limits<float>::max();
+
+      for ( auto P = uint32_t( 0 ); P < 2; ++P )
+      {
+        auto Quantized = std::array<uint32_t, 4>();
+        auto Err       = 0.0F;
+
+        for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+        {
+          auto const Value = std::clamp( std::lround( ( In[Ch] - static_cast<float>( P ) ) / 2.0F ), 0L, 127L );
+          auto const Diff  = static_cast<float>( Value * 2 + P ) - In[Ch];
+
+          Quantized[Ch]  = static_cast<uint32_t>( Value );
+          Err           += Diff * Diff;
+        }
+
+        if ( Err < BestErr )
+        {
+          Best    = Quantized;
+          BestP   = P;
+          BestErr = Err;
+        }
+      }
+
+      return { Best, BestP };
+    }
+
+    [[nodiscard]] std::array<Color, 16> getBc7Palette( std::array<uint32_t, 4> const & E0, std::array<uint32_t, 4> const & E1 ) noexcept
+    {
+      auto Palette = std::array<Color, 16>();
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+        {
+          Palette[Idx][Ch] = static_cast<float>( ( ( 64 - Bc7Weights[Idx] ) * E0[Ch] + Bc7Weights[Idx] * E1[Ch] + 32 ) >> 6U );
+        }
+      }
+
+      return Palette;
+    }
+
+    // Mode, endpoints and p-bits of a mode 6 block
+    [[nodiscard]] std::array<uint32_t, 4> expandBc7( std::array<uint32_t, 4> const & Quantized, uint32_t P ) noexcept
+    {
+      return { Quantized[0] << 1U | P, Quantized[1] << 1U | P, Quantized[2] << 1U | P, Quantized[3] << 1U | P };
+    }
+
+  }  // namespace
+
+  [[nodiscard]] std::array<std::byte, 8> encodeBc1( Block const & Texels ) noexcept
+  {
+    return encodeColor( Texels );
+  }
+
+  [[nodiscard]] std::array<std::byte, 16> encodeBc3( Block const & Texels ) noexcept
+  {
+    auto const Alpha = encodeAlpha( Texels );
+    auto const Color = encodeColor( Texels );
+
+    auto Out = std::array<std::byte, 16>();
+    std::copy( std::begin( Alpha ), std::end( Alpha ), std::begin( Out ) );
+    std::copy( std::begin( Color ), std::end( Color ), std::begin( Out ) + 8 );
+    return Out;
+  }
+
+  [[nodiscard]] std::array<std::byte, 16> encodeBc7( Block const & Texels ) noexcept
+  {
+    auto const Colors  = toTexels( Texels, true );
+    auto [Lo, Hi]      = calcEndpoints( Colors );
+    auto       BestErr = std::numeric_limits<float>::max();
+    auto       Best    = std::tuple<std::array<uint32_t, 4>, uint32_t, std::array<uint32_t, 4>, uint32_t, Idxs>();
+
+    for ( auto Pass = 0; Pass < 2; ++Pass )
+    {
+      auto const [Q0, P0] = quantizeBc7( Lo );
+      auto const [Q1, P1] = quantizeBc7( Hi );
+
+      auto       Indices = Idxs();
+      auto const Palette = getBc7Palette( expandBc7( Q0, P0 ), expandBc7( Q1, P1 ) );
+      auto const Err     = fitPalette( Colors, Palette, Indices );
+
+      if ( Err < BestErr )
+      {
+        BestErr = Err;
+        Best    = { Q0, P0, Q1, P1, Indices };
+      }
+
+      auto Weights = std::array<float, 16>();
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        Weights[Idx] = static_cast<float>( Bc7Weights[Indices[Idx]] ) / 64.0F;
+      }
+
+      refineEndpoints( Colors, Weights, Lo, Hi );
+    }
+
+    auto & [Q0, P0, Q1, P1, Indices] = Best;
+
+    // The top bit of the first index isn't stored, the palette is symmetric so swapping the ends clears it
+    if ( Indices[0] >= 8 )
+    {
+      std::swap( Q0, Q1 );
+      std::swap( P0, P1 );
+
+      for ( auto & Idx : Indices )
+      {
+        Idx = static_cast<uint8_t>( 15 - Idx );
+      }
+    }
+
+    auto Out    = std::array<std::byte, 16>();
+    auto Writer = BitWriter( Out );
+
+    Writer.write( 1U << 6U, 7 );
+
+    for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+    {
+      Writer.write( Q0[Ch], 7 );
+      Writer.write( Q1[Ch], 7 );
+    }
+
+    Writer.write( P0, 1 );
+    Writer.write( P1, 1 );
+
+    for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+    {
+      Writer.write( Indices[Idx], Idx == 0 ? 3 : 4 );
+    }
+
+    return Out;
+  }
+
+  [[nodiscard]] Block decodeBc1( std::array<std::byte, 8> const & Bytes ) noexcept
+  {
+    auto C0   = uint16_t( 0 );
+    auto C1   = uint16_t( 0 );
+    auto Bits = uint32_t( 0 );
+    std::memcpy( &C0, std::data( Bytes ) + 0, 2 );
+    std::memcpy( &C1, std::data( Bytes ) + 2, 2 );
+    std::memcpy( &Bits, std::data( Bytes ) + 4, 4 );
+
+    auto Palette = getBc1Palette( C0, C1 );
+    auto Alphas  = std::array<uint8_t, 4>{ 255, 255, 255, 255 };
+
+    if ( C0 <= C1 )
+    {
+      auto const E0 = from565( C0 );
+      auto const E1 = from565( C1 );
+
+      for ( auto Ch = size_t( 0 ); Ch < 3; ++Ch )
+      {
+        Palette[2][Ch] = static_cast<float>( ( E0[Ch] + E1[Ch] ) / 2 );
+        Palette[3][Ch] = 0.0F;
+      }
+
+      Alphas[3] = 0;
+    }
+
+    auto Out = Block();
+
+    for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+    {
+      auto const Entry = ( Bits >> ( 2 * Idx ) ) & 3U;
+
+      for ( auto Ch = size_t( 0 ); Ch < 3; ++Ch )
+      {
+        Out[Idx][Ch] = static_cast<uint8_t>( Palette[Entry][Ch] );
+      }
+
+      Out[Idx][3] = Alphas[Entry];
+    }
+
+    return Out;
+  }
+
+  [[nodiscard]] Block decodeBc3( std::array<std::byte, 16> const & Bytes ) noexcept
+  {
+    auto Color = std::array<std::byte, 8>();
+    std::copy( std::begin( Bytes ) + 8, std::end( Bytes ), std::begin( Color ) );
+
+    auto Out = decodeBc1( Color );
+
+    // The color half of BC3 never uses the 3 color mode
+    auto C0 = uint16_t( 0 );
+    auto C1 = uint16_t( 0 );
+    std::memcpy( &C0, std::data( Color ) + 0, 2 );
+    std::memcpy( &C1, std::data( Color ) + 2, 2 );
+
+    if ( C0 <= C1 )
+    {
+      auto const Palette = getBc1Palette( C0, C1 );
+      auto       Bits    = uint32_t( 0 );
+      std::memcpy( &Bits, std::data( Color ) + 4, 4 );
+
+      for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+      {
+        for ( auto Ch = size_t( 0 ); Ch < 3; ++Ch )
+        {
+          Out[Idx][Ch] = static_cast<uint8_t>( Palette[( Bits >> ( 2 * Idx ) ) & 3U][Ch] );
+        }
+      }
+    }
+
+    auto const Levels = getAlphaPalette( std::to_integer<uint32_t>( Bytes[0] ), std::to_integer<uint32_t>( Bytes[1] ) );
+    auto       Bits   = uint64_t( 0 );
+    std::memcpy( &Bits, std::data( Bytes ) + 2, 6 );
+
+    for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+    {
+      Out[Idx][3] = static_cast<uint8_t>( Levels[( Bits >> ( 3 * Idx ) ) & 7U] );
+    }
+
+    return Out;
+  }
+
+  [[nodiscard]] Block decodeBc7( std::array<std::byte, 16> const & Bytes ) noexcept
+  {
+    auto Reader = BitReader( Bytes );
+    auto Out    = Block();
+
+    if ( Reader.read( 7 ) != 1U << 6U )
+    {
+      return Out;
+    }
+
+    auto Q0 = std::array<uint32_t, 4>();
+    auto Q1 = std::array<uint32_t, 4>();
+
+    for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+    {
+      Q0[Ch] = Reader.read( 7 );
+      Q1[Ch] = Reader.read( 7 );
+    }
+
+    auto const P0      = Reader.read( 1 );
+    auto const P1      = Reader.read( 1 );
+    auto const Palette = getBc7Palette( expandBc7( Q0, P0 ), expandBc7( Q1, P1 ) );
+
+    for ( auto Idx = size_t( 0 ); Idx < 16; ++Idx )
+    {
+      auto const Entry = Reader.read( Idx == 0 ? 3 : 4 );
+
+      for ( auto Ch = size_t( 0 ); Ch < 4; ++Ch )
+      {
+        Out[Idx][Ch] = static_cast<uint8_t>( Palette[Entry][Ch] );
+      }
+    }
+
+    return Out;
+  }
+
+}  // namespace Mvk::Tools
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Mvk::Tools
+{
+  // 4x4 texels row by row, RGBA in sRGB. Edges of images that aren't a multiple of 4 repeat the last row or column
+  using Block = std::array<std::array<uint8_t, 4>, 16>;
+
+  // Opaque 4 color blocks, alpha is ignored
+  [[nodiscard]] std::array<std::byte, 8> encodeBc1( Block const & Texels ) noexcept;
+
+  // BC1 color with an 8 level alpha block
+  [[nodiscard]] std::array<std::byte, 16> encodeBc3( Block const & Texels ) noexcept;
+
+  // Mode 6 only, one RGBA line with 16 levels. Not the best mode for every block but it never falls too far behind and it
+  // keeps the encoder simple
+  [[nodiscard]] std::array<std::byte, 16> encodeBc7( Block const & Texels ) noexcept;
+
+  // Just enough to measure the error of the encoders above, decodeBc7 only knows mode 6
+  [[nodiscard]] Block decodeBc1( std::array<std::byte, 8> const & Bytes ) noexcept;
+  [[nodiscard]] Block decodeBc3( std::array<std::byte, 16> const & Bytes ) noexcept;
+  [[nodiscard]] Block decodeBc7( std::array<std::byte, 16> const & Bytes ) noexcept;
+
+}  // namespace Mvk::Tools
@@ -0,0 +1,352 @@
+#include "Detail/Ktx2.hpp"
+#include "Detail/MipChain.hpp"
+#include "Detail/TexFormat.hpp"
+#include "Tools/TexEncoder/BcEncode.hpp"
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Weverything"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#pragma clang diagnostic pop
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Mvk::Tools
+{
+  struct EncoderOptions
+  {
+    std::filesystem::path  InPath;
+    std::filesystem::path  OutPath;
+    Mvk::Detail::TexFormat Format  = Mvk::Detail::TexFormat::Bc7;
+    uint32_t               Threads = 0;
+  };
+
+  // RGBA in sRGB
+  struct Image
+  {
+    uint32_t             Width;
+    uint32_t             Height;
+    std::vector<uint8_t> Texels;
+  };
+
+  namespace Detail
+  {
+    static void printUsage() noexcept
+    {
+      std::printf( "usage: tex-encoder [options] <input.png> [output.ktx2]\n"
+                   "  the output defaults to the input with the extension replaced\n"
+                   "  --format <bc1|bc3|bc7|rgba8>  bc1 drops alpha, bc3 and bc7 keep it (default bc7)\n"
+                   "  --threads <n>                 0 is one per core (default 0)\n" );
+    }
+
+    [[nodiscard]] static std::optional<EncoderOptions> parseOptions( int Argc, char ** Argv ) noexcept
+    {
+      auto Options = EncoderOptions();
+      auto Paths   = std::vector<std::string_view>();
+
+      for ( auto Idx = 1; Idx < Argc; ++Idx )
+      {
+        auto const Arg = std::string_view( Argv[Idx] );
+
+        if ( !Arg.starts_with( "--" ) )
+        {
+          Paths.push_back( Arg );
+          continue;
+        }
+
+        if ( Idx + 1 == Argc )
+        {
+          return std::nullopt;
+        }
+
+        auto const Value = std::string_view( Argv[++Idx] );
+
+        if ( Arg == "--format" )
+        {
+          constexpr auto Names = std::array{ std::pair{ "rgba8", Mvk::Detail::TexFormat::Rgba8 },
+                                             std::pair{ "bc1", Mvk::Detail::TexFormat::Bc1 },
+                                             std::pair{ "bc3", Mvk::Detail::TexFormat::Bc3 },
+                                             std::pair{ "bc7", Mvk::Detail::TexFormat::Bc7 } };
+
+          auto const Found
+            = std::find_if( std::begin( Names ), std::end( Names ), [Value]( auto const & Name ) { return Name.first == Value; } );
+
+          if ( Found == std::end( Names ) )
+          {
+            return std::nullopt;
+          }
+
+          Options.Format = Found->second;
+        }
+        else if ( Arg == "--threads" )
+        {
+          auto const [End, Error] = std::from_chars( std::data( Value ), std::data( Value ) + std::size( Value ), Options.Threads );
+
+          if ( Error != std::errc() || End != std::data( Value ) + std::size( Value ) )
+          {
+            return std::nullopt;
+          }
+        }
+        else
+        {
+          return std::nullopt;
+        }
+      }
+
+      if ( std::empty( Paths ) || std::size( Paths ) > 2 )
+      {
+        return std::nullopt;
+      }
+
+      Options.InPath  = Paths[0];
+      Options.OutPath = std::size( Paths ) == 2 ? std::filesystem::path( Paths[1] )
+                                                : std::filesystem::path( Paths[0] ).replace_extension( ".ktx2" );
+
+      return Options;
+    }
+
+    [[nodiscard]] static Image downsample( Image const & Src ) noexcept
+    {
+      return { std::max( Src.Width / 2, 1U ),
+               std::max( Src.Height / 2, 1U ),
+               Mvk::Detail::downsampleRgba8( Src.Texels, Src.Width, Src.Height ) };
+    }
+
+    [[nodiscard]] static Block getBlock( Image const & Src, uint32_t BlockX, uint32_t BlockY ) noexcept
+    {
+      auto Texels = Block();
+
+      for ( auto Y = uint32_t( 0 ); Y < 4; ++Y )
+      {
+        for ( auto X = uint32_t( 0 ); X < 4; ++X )
+        {
+          auto const SrcX = std::min( BlockX * 4 + X, Src.Width - 1 );
+          auto const SrcY = std::min( BlockY * 4 + Y, Src.Height - 1 );
+
+          std::memcpy( std::data( Texels[Y * 4 + X] ), &Src.Texels[( size_t( SrcY ) * Src.Width + SrcX ) * 4], 4 );
+        }
+      }
+
+      return Texels;
+    }
+
+    static void encodeBlock( Mvk::Detail::TexFormat Format, Block const & Texels, std::byte * Out ) noexcept
+    {
+      auto const copy = [Out]( auto const & Bytes ) { std::memcpy( Out, std::data( Bytes ), std::size( Bytes ) ); };
+
+      switch ( Format )
+      {
+        case Mvk::Detail::TexFormat::Bc1: copy( encodeBc1( Texels ) ); break;
+        case Mvk::Detail::TexFormat::Bc3: copy( encodeBc3( Texels ) ); break;
+        case Mvk::Detail::TexFormat::Bc7: copy( encodeBc7( Texels ) ); break;
+        case Mvk::Detail::TexFormat::Rgba8: break;
+      }
+    }
+
+    [[nodiscard]] static Block decodeBlock( Mvk::Detail::TexFormat Format, std::byte const * In ) noexcept
+    {
+      auto Bytes8  = std::array<std::byte, 8>();
+      auto Bytes16 = std::array<std::byte, 16>();
+
+      switch ( Format )
+      {
+        case Mvk::Detail::TexFormat::Bc1: std::memcpy( std::data( Bytes8 ), In, 8 ); return decodeBc1( Bytes8 );
+        case Mvk::Detail::TexFormat::Bc3: std::memcpy( std::data( Bytes16 ), In, 16 ); return decodeBc3( Bytes16 );
+        case Mvk::Detail::TexFormat::Bc7: std::memcpy( std::data( Bytes16 ), In, 16 ); return decodeBc7( Bytes16 );
+        case Mvk::Detail::TexFormat::Rgba8: break;
+      }
+
+      return Block();
+    }
+
+    // Rows of blocks are handed out to the threads one at a time
+    [[nodiscard]] static std::vector<std::byte> encodeLevel( Image const & Src, Mvk::Detail::TexFormat Format, uint32_t ThreadCnt ) noexcept
+    {
+      auto Out = std::vector<std::byte>( Mvk::Detail::getLevelSize( Format, Src.Width, Src.Height, 0 ) );
+
+      if ( Format == Mvk::Detail::TexFormat::Rgba8 )
+      {
+        std::memcpy( std::data( Out ), std::data( Src.Texels ), std::size( Out ) );
+        return Out;
+      }
+
+      auto const BlocksX   = ( Src.Width + 3 ) / 4;
+      auto const BlocksY   = ( Src.Height + 3 ) / 4;
+      auto const BlockSize = Mvk::Detail::getBlockSize( Format );
+
+      auto NextRow = std::atomic<uint32_t>( 0 );
+
+      auto const work = [&]
+      {
+        for ( auto Row = NextRow++; Row < BlocksY; Row = NextRow++ )
+        {
+          for ( auto Col = uint32_t( 0 ); Col < BlocksX; ++Col )
+          {
+            encodeBlock( Format, getBlock( Src, Col, Row ), std::data( Out ) + ( size_t( Row ) * BlocksX + Col ) * BlockSize );
+          }
+        }
+      };
+
+      auto Threads = std::vector<std::thread>();
+
+      for ( auto Idx = uint32_t( 1 ); Idx < std::min( ThreadCnt, BlocksY ); ++Idx )
+      {
+        Threads.emplace_back( work );
+      }
+
+      work();
+
+      for ( auto & Thread : Threads )
+      {
+        Thread.join();
+      }
+
+      return Out;
+    }
+
+    // Over the channels the format keeps
+    [[nodiscard]] static double
+      calcPsnr( Image const & Src, std::vector<std::byte> const & Encoded, Mvk::Detail::TexFormat Format ) noexcept
+    {
+      if ( Format == Mvk::Detail::TexFormat::Rgba8 )
+      {
+        return std::numeric_limits<double>::infinity();
+      }
+
+      auto const BlocksX   = ( Src.Width + 3 ) / 4;
+      auto const BlockSize = Mvk::Detail::getBlockSize( Format );
+      auto const ChCnt     = Format == Mvk::Detail::TexFormat::Bc1 ? size_t( 3 ) : size_t( 4 );
+
+      auto SqrErr = 0.0;
+
+      for ( auto Y = uint32_t( 0 ); Y < Src.Height; Y += 4 )
+      {
+        for ( auto X = uint32_t( 0 ); X < Src.Width; X += 4 )
+        {
+          auto const Decoded = decodeBlock( Format, std::data( Encoded ) + ( size_t( Y / 4 ) * BlocksX + X / 4 ) * BlockSize );
+
+          for ( auto Texel = uint32_t( 0 ); Texel < 16; ++Texel )
+          {
+            auto const SrcX = X + Texel % 4;
+            auto const SrcY = Y + Texel / 4;
+
+            if ( SrcX >= Src.Width || SrcY >= Src.Height )
+            {
+              continue;
+            }
+
+            for ( auto Ch = size_t( 0 ); Ch < ChCnt; ++Ch )
+            {
+              auto const Diff  = static_cast<double>( Src.Texels[( size_t( SrcY ) * Src.Width + SrcX ) * 4 + Ch] ) - Decoded[Texel][Ch];
+              SqrErr          += Diff * Diff;
+            }
+          }
+        }
+      }
+
+      auto const Mse = SqrErr / ( static_cast<double>( Src.Width ) * Src.Height * static_cast<double>( ChCnt ) );
+      return Mse == 0.0 ? std::numeric_limits<double>::infinity() : 10.0 * std::log10( 255.0 * 255.0 / Mse );
+    }
+
+  }  // namespace Detail
+
+}  // namespace Mvk::Tools
+
+// Offline counterpart of the PNG path of readModelData: the whole mip chain is computed here and stored block compressed,
+// the renderer only copies it
+int main( int Argc, char ** Argv )
+{
+  auto const Options = Mvk::Tools::Detail::parseOptions( Argc, Argv );
+
+  if ( !Options.has_value() )
+  {
+    Mvk::Tools::Detail::printUsage();
+    return 1;
+  }
+
+  auto Width    = 0;
+  auto Height   = 0;
+  auto Channels = 0;
+  auto Pixels   = stbi_load( Options->InPath.c_str(), &Width, &Height, &Channels, STBI_rgb_alpha );
+
+  if ( Pixels == nullptr )
+  {
+    std::fprintf( stderr, "couldn't read %s\n", Options->InPath.c_str() );
+    return 1;
+  }
+
+  auto Src   = Mvk::Tools::Image();
+  Src.Width  = static_cast<uint32_t>( Width );
+  Src.Height = static_cast<uint32_t>( Height );
+  Src.Texels.assign( Pixels, Pixels + size_t( Width ) * size_t( Height ) * 4 );
+  stbi_image_free( Pixels );
+
+  auto const ThreadCnt = Options->Threads != 0 ? Options->Threads : std::max( std::thread::hardware_concurrency(), 1U );
+  auto const Start     = std::chrono::steady_clock::now();
+
+  // Same count as calcMipLvl
+  auto const LevelCnt = static_cast<uint32_t>( std::floor( std::log2( std::max( Src.Width, Src.Height ) ) ) + 1 );
+  auto       Levels   = std::vector<std::vector<std::byte>>();
+  auto       Level    = Src;
+  auto       Psnr     = 0.0;
+  auto       RawSize  = size_t( 0 );
+
+  for ( auto Lvl = uint32_t( 0 ); Lvl < LevelCnt; ++Lvl )
+  {
+    if ( Lvl != 0 )
+    {
+      Level = Mvk::Tools::Detail::downsample( Level );
+    }
+
+    Levels.push_back( Mvk::Tools::Detail::encodeLevel( Level, Options->Format, ThreadCnt ) );
+    RawSize += Mvk::Detail::getLevelSize( Mvk::Detail::TexFormat::Rgba8, Src.Width, Src.Height, Lvl );
+
+    if ( Lvl == 0 )
+    {
+      Psnr = Mvk::Tools::Detail::calcPsnr( Level, Levels.back(), Options->Format );
+    }
+  }
+
+  auto const Ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - Start ).count();
+
+  if ( !Mvk::Detail::writeKtx2( Options->OutPath, Options->Format, Src.Width, Src.Height, Levels ) )
+  {
+    std::fprintf( stderr, "couldn't write %s\n", Options->OutPath.c_str() );
+    return 1;
+  }
+
+  auto EncodedSize = size_t( 0 );
+
+  for ( auto const & Encoded : Levels )
+  {
+    EncodedSize += std::size( Encoded );
+  }
+
+  std::printf( "%s: %ux%u, %u levels, %zu KiB of texels vs %zu KiB as RGBA8 (%.1fx), PSNR %.2f dB, %.1f ms on %u threads\n",
+               Options->OutPath.c_str(),
+               Src.Width,
+               Src.Height,
+               LevelCnt,
+               EncodedSize / 1024,
+               RawSize / 1024,
+               static_cast<double>( RawSize ) / static_cast<double>( EncodedSize ),
+               Psnr,
+               Ms,
+               ThreadCnt );
+
+  return 0;
+}
@@ -10,7 +10,10 @@ int main()
 {
   auto Rdr = Mvk::Engine::VulkanRenderer();
 
-  auto ID = Rdr.loadModel();
+  auto ID = Rdr.loadModelAsync( { "../../assets/viking_room.mvkm",
+                                  "../../assets/viking_room.obj",
+                                  "../../assets/viking_room.ktx2",
+                                  "../../assets/viking_room.png" } );
 
   while ( !Rdr.isDone() )
   {
@@ -1,2 +1,3 @@
 glslc shader.vert -o vert.spv
+glslc -DMVK_FULL_VERTICES shader.vert -o vert_full.spv
 glslc shader.frag -o frag.spv
@@ -7,15 +7,27 @@ layout(binding = 0) uniform UniformBufferObject {
   mat4 proj; 
 } ubo;
 
+// Bounds of the mesh, positions come in normalized to them unless the full vertices are read
+layout(push_constant) uniform PosDequant {
+  vec4 scale;
+  vec4 offset;
+} dequant;
+
+#ifdef MVK_FULL_VERTICES
 layout(location = 0) in vec3 inPosition; 
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec2 inTextCoord;
+#else
+layout(location = 0) in vec4 inPosition; 
+#endif
+layout(location = 1) in vec2 inTextCoord;
 
-layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTextCoord;
 
 void main() {
-  gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0); 
-  fragColor = inColor;
+#ifdef MVK_FULL_VERTICES
+  vec3 position = inPosition;
+#else
+  vec3 position = inPosition.xyz * dequant.scale.xyz + dequant.offset.xyz;
+#endif
+  gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0); 
   fragTextCoord = inTextCoord;
 }